@@ -26,6 +26,7 @@ struct oxycontroller_state {
     uint8_t coordinator_found;
     uint32_t missed_conection;     /* Number of NAKs since last confirmed reception */
     uint8_t using_external_memory; /* True if we are using an external memory */
+    uint8_t downlink_pending;      /* The coordinator has commands queued for us */
 };
 
 /**
@@ -3,6 +3,18 @@
 #include "bsp-config.h"
 #include <stdint.h>
 
+#define SOLENOID_CAPTURE_MAX_SAMPLES  16 /* Samples of the solenoid supply during a pulse */
+#define SOLENOID_CAPTURE_OVERSAMPLING 2  /* Every sample averages 4 conversions */
+#define ADC_OVERSAMPLING              4  /* The single readings average 16 conversions */
+
+/**
+ * Supplies of the node, in mV
+ */
+struct adc_readings {
+    int battery_mv;
+    int sensor_supply_mv;
+};
+
 /**
  * Initialize the analog to digital converter
  */
@@ -27,3 +39,17 @@ int adc_read_sensor_supply(void);
  * We have to multiply by 11 to have mV.
  */
 int adc_read_solenoid_supply(void);
+
+/**
+ * Capture the supply voltage of the solenoid in mV, several samples at a fixed
+ * interval in one ADC sequence. Every sample is the average of
+ * 1 << SOLENOID_CAPTURE_OVERSAMPLING conversions.
+ * @return The number of samples captured, -1 on error
+ */
+int adc_capture_solenoid_supply(int16_t *mv, int n_samples, uint32_t interval_us);
+
+/**
+ * Read the supplies of the node in one burst.
+ * @return 0 if all were read, -1 if some failed
+ */
+int adc_read_all(struct adc_readings *readings);
@@ -0,0 +1,38 @@
+/**
+ *  \file adr.h
+ *  \brief Adaptive data rate and transmission power for the uplink
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+
+#ifndef ADR_H
+#define ADR_H
+
+#include <stdint.h>
+#include "defaults.h"
+
+/**
+ * Link statistics gathered from the acknowledgments of the coordinator and the
+ * uplink modem parameters derived from them.
+ */
+struct adr_state {
+    int8_t snr[ADR_WINDOW_SIZE];   /* SNR of the last acknowledgments, dB */
+    int16_t rssi[ADR_WINDOW_SIZE]; /* RSSI of the last acknowledgments, dBm */
+    uint8_t n_samples;             /* Valid samples in the window */
+    uint8_t next;                  /* Next position to write in the window */
+    uint8_t missed_acks;           /* Consecutive frames without acknowledgment */
+    uint8_t datarate;              /* Spreading factor used for the uplink */
+    int8_t tx_power;               /* Transmission power used for the uplink, dBm */
+};
+
+extern struct adr_state adr;
+
+void adr_reset(void);
+void adr_ack_received(int16_t rssi, int8_t snr);
+void adr_ack_missed(void);
+uint8_t adr_get_datarate(void);
+int8_t adr_get_tx_power(void);
+int adr_get_link_margin(void);
+int16_t adr_get_average_rssi(void);
+
+#endif /* ADR_H */
@@ -3,6 +3,17 @@
 #define SLEEPING       0
 #define RECEPTION_TIME 1000
 
+/*
+ * Receive windows after an uplink, ms from the end of the transmission. The
+ * coordinator answers in the first one, the second one is a retry.
+ */
+#define RX_WINDOW_1_DELAY 0
+#define RX_WINDOW_2_DELAY 500
+/* Frames queued by the coordinator, received back to back after a window gets one */
+#define RX_MAX_COMMANDS 3
+/* Token in the acknowledgment when the coordinator has queued commands */
+#define ACK_DOWNLINK_PENDING "P"
+
 void send_data_from_storage(int time_of_last_measurement);
 void send_data_from_datalogger(int time_of_last_measurement);
 int receiving_commands(char *data);
@@ -20,6 +20,43 @@
 #include "defaults.h"
 #include "bsp-config.h"
 #include "smart_sensor.h"
+#include "energy.h"
+
+/**
+ * What the node sends to the coordinator after every sample
+ */
+enum uplink_mode {
+    UPLINK_ALL_SAMPLES, /* Every sample */
+    UPLINK_SUMMARY,     /* The statistics of the log interval, and the samples in alarm */
+    UPLINK_EXCEPTION,   /* Only the measurements that moved out of their deadband */
+};
+
+/**
+ * How the GPS is kept between samples
+ */
+enum gps_mode {
+    GPS_MODE_COLD,    /* Output off, the default */
+    GPS_MODE_STANDBY, /* PMTK161 standby, only with V_BACKUP or a GPS supply that is not cut with the sensors */
+};
+
+/**
+ * Classes of variables sharing a deadband for the report by exception
+ */
+enum deadband_class {
+    DEADBAND_OXYGEN,       /* mg/l */
+    DEADBAND_SATURATION,   /* % */
+    DEADBAND_TEMPERATURE,  /* Celsius */
+    DEADBAND_SALINITY,     /* PSU */
+    DEADBAND_PH,           /* pH units */
+    DEADBAND_CONDUCTIVITY, /* mS/cm */
+    DEADBAND_PRESSURE,     /* Sensor units */
+    DEADBAND_LEVEL,        /* Depth, distance and level. Sensor units */
+    DEADBAND_FLOW,         /* Flow and speed. Sensor units */
+    DEADBAND_VOLTAGE,      /* Volts */
+    DEADBAND_STATE,        /* Valve state and mode, any change is reported */
+    DEADBAND_OTHER,        /* Everything else */
+    DEADBAND_CLASS_END,
+};
 
 /**
  * Concentrator runtime configuration parameters. This variables are saved into
@@ -30,7 +67,7 @@ struct configuration {
     uint32_t uplink_channel;            /* The Uplink channel of the network */
     uint32_t downlink_channel;          /* The Downlink channel of the network */
     uint16_t sampling_interval;         /* Sampling interval in seconds */
-    uint16_t wake_interval;             /* Wake up interval in seconds */
+    uint16_t wake_interval;             /* Seconds the console waits for a command */
     uint16_t log_interval;              /* Seconds. Write a measurement log entry at this interval */
     uint16_t ping_interval;             /* Interval for pinging the pancoordinator. Seconds */
     char name[10];                      /* Identifier for this device */
@@ -53,16 +90,29 @@ struct configuration {
     uint8_t distance;              /* Transmission rate distance */
     uint8_t bandwidth;             /* Lora bandwidth configuration */
     uint8_t datarate;              /* Lora datarate configuration */
-    uint16_t time_on_air;          /* Time it takes to transmit */
+    uint16_t time_on_air;          /* Not used, see radio_frame_time_on_air() */
     float temp_offset;             /* Offset for sensors without temp calibration */
     uint8_t current_sensor_status; /* Current valve sensor |on - off| */
     uint32_t totalized_flow;       /*variable that stores sensor config*/
     uint16_t total_volume;         /* Total volume to calculate percentage */
+    uint8_t adr_enabled;           /* Adapt the uplink datarate and power to the link */
+    uint8_t profiling_frame;       /* Send the cycle profile with the node statistics */
+    uint32_t load_current_ua[ENERGY_LOAD_END]; /* Current of every load, uA */
+    uint32_t detected_manufacturers;           /* Bitmask of the manufacturers found in the last detection */
+    uint8_t uplink_mode;                       /* enum uplink_mode */
+    float deadband[DEADBAND_CLASS_END];        /* Report by exception, change needed to send a variable */
+    uint16_t heartbeat_interval;               /* Seconds. Send everything at least at this interval */
+    uint16_t control_interval;                 /* Seconds. Fast oxygen control loop, 0 disabled */
+    uint8_t gps_mode;                          /* enum gps_mode */
 };
 
+/**
+ * Enabled sensor drivers, saved into persistent storage. The drivers are
+ * resolved from the manufacturer IDs at boot with configure_sensor_drivers().
+ */
 struct sensor_config {
     int16_t n_changes;
-    const struct smart_sensor_driver *sensor_driver[SENSOR_MANUFACTURER_END];
+    uint32_t enabled_manufacturers; /* Bit (1 << manufacturer) set if its driver is enabled */
 };
 
 /*
@@ -73,6 +123,7 @@ extern struct sensor_config sen_drv;
 
 void set_default_configuration(void);
 int write_configuration(void);
+int write_configuration_field(const void *field);
 int write_sensor_configuration(void);
 int read_nvs_data(void);
 void set_current_time(uint32_t *time);
@@ -0,0 +1,30 @@
+/**
+ *  \file console_wake.h
+ *  \brief Interrupt driven reception of the console UART.
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+
+#ifndef CONSOLE_WAKE_H
+#define CONSOLE_WAKE_H
+
+#include <stdint.h>
+
+/**
+ * Enable the reception interrupt of the console UART.
+ *
+ * @return 0 if successful, negative error code if failure.
+ */
+int console_wake_init(void);
+
+/**
+ * Sleep until a character arrives at the console or the timeout expires.
+ * The received characters are passed to the shell.
+ *
+ * @param timeout_ms Maximum time to sleep.
+ *
+ * @return 1 if some character was received, 0 on timeout.
+ */
+int console_wake_wait(uint32_t timeout_ms);
+
+#endif /* CONSOLE_WAKE_H */
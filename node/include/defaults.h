@@ -25,6 +25,7 @@
 #define DEFAULT_SAMPLING_INTERVAL 30 /* Seconds */
 #define DEFAULT_TX_SLOT           0
 #define DEFAULT_LOG_INTERVAL      300 /* 5 minutes */
+#define DEFAULT_WAKE_INTERVAL     1   /* Seconds the console waits for a command every cycle */
 
 /** Time to have the calibration button pressed to start a calibration */
 #define TIME_TO_START_CALIBRATION 5
@@ -39,6 +40,11 @@
 #define DEFAULT_OXYGEN_SATURATION_OPEN_LEVEL       90.0  /* Below this level, open the oxygen flow */
 #define DEFAULT_OXYGEN_SATURATION_CLOSE_LEVEL      95.0  /* Above this level, close the oxygen flow */
 
+/** Fast control loop, used while a valve is open or the oxygen is near its open level */
+#define DEFAULT_CONTROL_INTERVAL       5    /* Seconds, 0 to control only after every sample */
+#define OXYGEN_CONTROL_NEAR_LEVEL      0.5f /* mg/l over the open level */
+#define OXYGEN_CONTROL_NEAR_SATURATION 5.0f /* % over the open level */
+
 /** Default salinity */
 #define DEFAULT_SALINITY          0.0
 /** Default temperature to use if temperature measurement is invalid */
@@ -74,6 +80,68 @@
 #define CHEMINS_POWERUP_TIME                    4000
 #define ST_VL53L1X_POWER_TIME                   1000
 
+/**
+ * Adaptive data rate. The uplink spreading factor and power are lowered while the
+ * acknowledgments of the coordinator show enough SNR over the demodulation floor.
+ */
+#define ADR_WINDOW_SIZE         8  /* Acknowledgments used to estimate the link */
+#define ADR_INSTALLATION_MARGIN 10 /* dB of SNR kept over the demodulation floor */
+#define ADR_TX_POWER_STEP       3  /* dB */
+#define ADR_MAX_TX_POWER        20 /* dBm, PA_BOOST limit of the SX1276 */
+#define ADR_MIN_TX_POWER        2  /* dBm */
+#define ADR_MAX_MISSED_ACKS     3  /* Go back to the configured datarate after this */
+
+/** Current of the radio, SX1276 datasheet */
+#define RADIO_TX_CURRENT_MA 120 /* PA_BOOST at 20 dBm */
+#define RADIO_RX_CURRENT_MA 12
+
+/** Default current of the other loads of the node, uA. Calibrate with the energy command */
+#define CPU_ACTIVE_CURRENT_UA  4000  /* SAMD21 at 48 MHz with the display */
+#define CPU_IDLE_CURRENT_UA    300   /* Tickless idle waiting for the next job */
+#define SENSORS_CURRENT_UA     30000 /* Typical smart sensor on the 5 V rail */
+#define SENSORS_12V_CURRENT_UA 60000 /* Sensors on the external 12 V path */
+
+/** Retry budget of the smart sensors */
+#define SENSOR_RELIABLE_STREAK    5  /* Successes in a row to give only one try */
+#define SENSOR_DEAD_FAILURES      3  /* Failures in a row to start skipping cycles */
+#define SENSOR_MAX_BACKOFF_CYCLES 64 /* Try a dead sensor at least this often */
+#define SENSOR_LATENCY_EWMA_SHIFT 3  /* Weight 1/8 for the last latency */
+
+/** Time budgets of the sensor detection, ms */
+#define DETECTION_DRIVER_BUDGET_MS 30000
+#define DETECTION_TOTAL_BUDGET_MS  120000
+
+/** Learned response timeout of the smart sensors */
+#define RESPONSE_TIMEOUT_K           4  /* Deviations over the average latency */
+#define RESPONSE_TIMEOUT_MIN_MS      50 /* Never wait less than this */
+#define RESPONSE_TIMEOUT_MIN_SAMPLES 4  /* Use the maximum until this many responses */
+
+/** Periodic jobs, seconds */
+#define STORAGE_RETRY_INTERVAL   600 /* Retry the frames that could not be sent */
+#define DISPLAY_REFRESH_INTERVAL 30
+
+/** Interval to send the statistics of the node, seconds */
+#define NODE_STATISTICS_INTERVAL 3600
+
+/** Statistics of the measurements over the log interval */
+#define AGGREGATION_MAX_FIELDS 4 /* Variables aggregated per measurement */
+
+/** Report by exception, default deadbands */
+#define DEFAULT_DEADBAND_OXYGEN       0.1f
+#define DEFAULT_DEADBAND_SATURATION   1.0f
+#define DEFAULT_DEADBAND_TEMPERATURE  0.05f
+#define DEFAULT_DEADBAND_SALINITY     0.1f
+#define DEFAULT_DEADBAND_PH           0.02f
+#define DEFAULT_DEADBAND_CONDUCTIVITY 0.1f
+#define DEFAULT_DEADBAND_PRESSURE     0.01f
+#define DEFAULT_DEADBAND_LEVEL        1.0f
+#define DEFAULT_DEADBAND_FLOW         0.1f
+#define DEFAULT_DEADBAND_VOLTAGE      0.05f
+#define DEFAULT_DEADBAND_STATE        0.5f /* The states are integers, any change */
+#define DEFAULT_DEADBAND_OTHER        0.1f
+#define DEFAULT_HEARTBEAT_INTERVAL    3600 /* Seconds */
+#define UPLINK_DEADBAND_STEPS         4    /* Resolution of the reported values, steps per deadband */
+
 #define FRESHWATER 0
 #define SEAWATER   1
 
@@ -0,0 +1,43 @@
+/**
+ *  \file energy.h
+ *  \brief Charge used by the node, estimated from the time in every power state
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <stdint.h>
+
+/**
+ * Loads of the node. The current of every load is in cfg.load_current_ua.
+ */
+enum energy_load {
+    ENERGY_CPU_ACTIVE = 0, /* Derived, the time not spent in ENERGY_CPU_IDLE */
+    ENERGY_CPU_IDLE,       /* Derived, the time of the kernel idle thread */
+    ENERGY_SENSORS,        /* Sensor power rail */
+    ENERGY_SENSORS_12V,    /* External 12 V path of the sensors */
+    ENERGY_RADIO_TX,
+    ENERGY_RADIO_RX,
+    ENERGY_LOAD_END
+};
+
+/**
+ * Time spent in every power state.
+ */
+struct energy_residency {
+    uint64_t elapsed_ms;               /* Duration of the period */
+    uint64_t load_ms[ENERGY_LOAD_END]; /* Time with every load on */
+};
+
+void energy_load_on(enum energy_load load);
+void energy_load_off(enum energy_load load);
+void energy_account(enum energy_load load, uint32_t time_ms);
+void energy_new_cycle(void);
+void energy_get_residency(struct energy_residency *last_cycle, struct energy_residency *total);
+uint32_t energy_charge_uah(const struct energy_residency *r);
+uint32_t energy_mah_per_day(const struct energy_residency *r);
+const char *energy_load_name(enum energy_load load);
+
+#endif /* ENERGY_H */
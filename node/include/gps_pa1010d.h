@@ -0,0 +1,36 @@
+/**
+ *  \file gps_pa1010d.h
+ *  \brief GPS PA1010D, fix acquisition and statistics
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+
+#ifndef GPS_PA1010D_H
+#define GPS_PA1010D_H
+
+#include <stdint.h>
+
+#define GPS_MAX_HDOP           2.5f  /* A fix is accepted with this horizontal dilution or better */
+#define GPS_BOOT_TIMEOUT_MS    20000 /* Until the module starts sending sentences */
+#define GPS_MIN_FIX_BUDGET_MS  5000
+#define GPS_MAX_FIX_BUDGET_MS  60000 /* Cold start, the datasheet gives 35 s */
+#define GPS_FIX_BUDGET_FACTOR  3     /* Budget, times the average time to fix */
+#define GPS_DETECTION_WAIT_MS  2000
+
+/**
+ * Time to fix and quality of the fixes, the acquisition budget adapts to them
+ */
+struct gps_fix_stats {
+    uint32_t n_fixes;
+    uint32_t n_timeouts;
+    uint32_t last_time_to_fix_ms;
+    uint32_t average_time_to_fix_ms;
+    float last_hdop;
+    uint32_t budget_ms; /* Time allowed for the next fix */
+};
+
+void gps_pa1010d_get_stats(struct gps_fix_stats *stats);
+int gps_pa1010d_in_standby(void);
+void gps_pa1010d_power_cut(void);
+
+#endif /* GPS_PA1010D_H */
@@ -0,0 +1,53 @@
+/**
+ *  \file measurement_aggregation.h
+ *  \brief Statistics of the measurements over the log interval
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+
+#ifndef MEASUREMENT_AGGREGATION_H
+#define MEASUREMENT_AGGREGATION_H
+
+#include <stdint.h>
+#include "measurement.h"
+#include "bsp-config.h"
+#include "defaults.h"
+
+#define AGGREGATION_NODE_SLOT (MAX_EXTERNAL_SENSORS)     /* Slot of the internal sensors of the node */
+#define AGGREGATION_SLOTS     (MAX_EXTERNAL_SENSORS + 1) /* One slot per smart sensor plus the node */
+
+/**
+ * Running statistics of a variable, updated with every sample (Welford).
+ */
+struct field_summary {
+    uint16_t count; /* Valid samples in the interval */
+    float min;
+    float max;
+    float mean;
+    float m2; /* Sum of the squared differences to the mean */
+};
+
+int measurement_get_fields(const struct measurement *m,
+                           float *value,
+                           enum measurement_status *status,
+                           uint8_t *deadband_class);
+void aggregation_reset(void);
+void aggregation_add(int slot, const struct measurement *m);
+int aggregation_get(int slot, struct field_summary *fields);
+int aggregation_interval_elapsed(void);
+float field_summary_stddev(const struct field_summary *f);
+
+/**
+ * Replace the variables of a measurement with their mean over the interval.
+ * The actual values are kept in saved to put them back with aggregation_restore().
+ * @return The number of variables saved
+ */
+int aggregation_apply_means(int slot, struct measurement *m, float *saved, enum measurement_status *saved_status);
+void aggregation_restore(struct measurement *m, const float *saved, const enum measurement_status *saved_status);
+
+/**
+ * Check if a measurement is outside the alarm levels of the configuration.
+ */
+int measurement_in_alarm(const struct measurement *m);
+
+#endif /* MEASUREMENT_AGGREGATION_H */
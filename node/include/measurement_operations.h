@@ -11,7 +11,33 @@
 #ifndef MEASUREMENT_OPERATIONS_H
 #define MEASUREMENT_OPERATIONS_H
 
+#include <stdint.h>
 #include "measurement.h"
+#include "bsp-config.h"
+
+/**
+ * Partners of the measurements derived from other sensors, found once after
+ * the detection. The values are indexes of the detected sensors.
+ */
+struct join_plan {
+    uint8_t valid;             /* The plan matches the detected sensors */
+    uint8_t n_of_measurements; /* Sensors when the plan was built */
+    uint8_t n_salinity;
+    uint8_t n_concentration;
+    uint8_t n_levels;
+    uint8_t n_flow;
+    struct {
+        int8_t oxygen;
+        int8_t conductivity; /* At about the same depth of the oxygen sensor */
+    } salinity[MAX_EXTERNAL_SENSORS];
+    int8_t concentration[MAX_EXTERNAL_SENSORS]; /* Oxygen sensors with the concentration calculated here */
+    struct {
+        int8_t first;
+        int8_t second; /* Gives the second level of the first */
+    } level[MAX_EXTERNAL_SENSORS];
+    int8_t current_ac[3];              /* Sensor of every phase, -1 if missing */
+    int8_t flow[MAX_EXTERNAL_SENSORS]; /* Flowmeters sharing the totalizer */
+};
 
 /**
  * Get a pointer to the measurements list
@@ -23,15 +49,6 @@ struct measurement *actual_measurement(void);
  */
 int almost_same_depth(float depth1, float depth2);
 
-/**
- * Join the salinity measurement from a conductivity sensor at about the same depth
- * of an oxygen sensor.
- * @param n_of_measurements The number of measurements in the array to check
- * @param measurement An array with all the measurements to check.
- * @return the number of oxygen sensors with joined salinity measurements
- */
-int measurements_join_oxygen_with_salinity(int n_of_measurements, struct measurement *measurement);
-
 /**
  * Calculate the oxygen concentration for a measurement using the saturation
  * obtained from the optical measurement, the salinity and the temperature
@@ -41,32 +58,10 @@ int measurements_join_oxygen_with_salinity(int n_of_measurements, struct measure
  */
 void measurement_calculate_oxygen_concentration(struct measurement *measurement);
 
-/**
- * Calculate the oxygen concentration for a list of measurement using the saturation
- * obtained from the optical measurement, the salinity and the temperature
- * The concentration can be calculated only if we have valid oxygen and temperature measurements.
- * @param n_of_measurements The number of measurements in the array to process
- * @param measurement An array with all the measurements to process.
- */
-void measurements_list_calculate_oxygen_concentration(int n_of_measurements, struct measurement *measurement);
-
-/*
- * Join two level measurements.
- * @param n_of_measurements The number of measurements in the array to check
- * @param measurement An array with all the measurements to check.
- * @return 1 if two sensors can be joined.
- */
-int measurements_join_two_levels(int n_of_measurements, struct measurement *measurement);
-
-/*
- * Join three current AC measurements.
- * @param n_of_measurements The number of measurements in the array to check
- * @param measurement An array with all the measurements to check.
- * @return 1 if two sensors can be joined.
- */
-int measurements_join_current_ac(int n_of_measurements, struct measurement *measurement);
-
-int gets_totalized_flow_measurement(int n_of_measurements, struct measurement *measurement);
+void join_plan_invalidate(void);
+const struct join_plan *join_plan_get(void);
+void measurements_derive(int n_of_measurements, struct measurement *measurement);
+void measurements_derive_sensor(int index, struct measurement *measurement);
 
 /*
  * Average oil level
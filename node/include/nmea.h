@@ -0,0 +1,83 @@
+/**
+ *  \file nmea.h
+ *  \brief Streaming parser of the NMEA sentences of the GPS
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+
+#ifndef NMEA_H
+#define NMEA_H
+
+#include <stdint.h>
+
+#define NMEA_ADDRESS_SIZE    5 /* Talker and sentence, like GNRMC */
+#define NMEA_FRACTION_DIGITS 5 /* Decimals kept of every field */
+
+/**
+ * Sentences completed by the parser
+ */
+enum nmea_sentence {
+    NMEA_NONE,  /* Sentence not finished yet, or discarded */
+    NMEA_GGA,   /* Fix data */
+    NMEA_RMC,   /* Recommended minimum */
+    NMEA_OTHER, /* Valid sentence of another type, like PMTK answers */
+};
+
+/**
+ * Data of a sentence. Only the fields of the sentence type are updated.
+ */
+struct nmea_fix {
+    int32_t latitude;   /* 1e-7 degrees, negative to the south */
+    int32_t longitude;  /* 1e-7 degrees, negative to the west */
+    uint32_t utc_time;  /* hhmmss */
+    uint16_t hdop;      /* 1/100 */
+    uint8_t quality;    /* GGA fix quality, 0 without fix */
+    uint8_t satellites; /* GGA satellites in use */
+    uint8_t valid;      /* RMC status A */
+    uint8_t has_position;
+};
+
+/**
+ * Number being received in the current field, no characters are stored
+ */
+struct nmea_number {
+    uint32_t integer;
+    uint32_t fraction; /* In 10^-NMEA_FRACTION_DIGITS */
+    uint8_t fraction_digits;
+    uint8_t in_fraction;
+    uint8_t length; /* Characters of the field */
+    char first;     /* First character, for the single letter fields */
+};
+
+/**
+ * State of the parser, one per serial port
+ */
+struct nmea_parser {
+    uint8_t state;
+    uint8_t checksum; /* XOR of the characters between '$' and '*' */
+    uint8_t received_checksum;
+    uint8_t checksum_digits;
+    uint8_t field; /* 0 is the address */
+    enum nmea_sentence sentence;
+    char address[NMEA_ADDRESS_SIZE];
+    struct nmea_number number;
+    struct nmea_fix fix; /* Being received */
+    uint32_t n_sentences;
+    uint32_t n_checksum_errors;
+};
+
+/**
+ * Result of the parser self test
+ */
+struct nmea_check {
+    uint32_t n_sentences;
+    uint32_t n_checksum_errors;
+    uint32_t n_failures; /* Sentences with unexpected results */
+    uint32_t ns_per_byte;
+};
+
+void nmea_parser_init(struct nmea_parser *parser);
+enum nmea_sentence nmea_parser_feed(struct nmea_parser *parser, char c, struct nmea_fix *fix);
+int nmea_parser_check(struct nmea_check *check);
+
+#endif /* NMEA_H */
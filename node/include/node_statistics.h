@@ -0,0 +1,17 @@
+/**
+ *  \file node_statistics.h
+ *  \brief Statistics of the node sent to the coordinator
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+
+#ifndef NODE_STATISTICS_H
+#define NODE_STATISTICS_H
+
+#include <stdint.h>
+
+void node_statistics_new_cycle(void);
+void node_statistics_append(uint32_t timestamp);
+void node_statistics_append_aggregation(uint32_t timestamp);
+
+#endif /* NODE_STATISTICS_H */
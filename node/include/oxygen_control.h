@@ -49,11 +49,15 @@ void oxygen_control_init(struct valve_configuration *configuration);
 
 /**
  * Open the flow of oxygen
+ * The pulses of a bistable valve are given in the background by the valves work queue, so for those valves the
+ * status returned is the one of the previous pulse request (see valve_actuator_status()), not of this one.
  */
 enum solenoid_status open_oxygen_flow(int valve_nr);
 
 /**
  * Close the flow of oxygen
+ * The pulses of a bistable valve are given in the background by the valves work queue, so for those valves the
+ * status returned is the one of the previous pulse request (see valve_actuator_status()), not of this one.
  */
 enum solenoid_status close_oxygen_flow(int valve_nr);
 
@@ -64,6 +68,17 @@ enum solenoid_status close_oxygen_flow(int valve_nr);
  */
 void check_oxygen_levels_all_valves(int use_saturation, struct measurement *measurements);
 
+/**
+ * Check if the oxygen levels for a valve are right and open or close the valve accordingly
+ */
+void check_oxygen_levels(int valve_nr, int use_saturation, struct measurement *measurement);
+
+/**
+ * Check if any valve in automatic mode needs the fast control loop: it is
+ * open, or its oxygen is close to the open level.
+ */
+int oxygen_control_fast_loop_needed(int use_saturation, const struct measurement *measurements, int n_of_measurements);
+
 /**
  * Set the configuration for a valve
  */
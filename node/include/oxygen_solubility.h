@@ -0,0 +1,47 @@
+/**
+ *  \file oxygen_solubility.h
+ *  \brief Oxygen concentration from the saturation with a fixed point table
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+
+#ifndef OXYGEN_SOLUBILITY_H
+#define OXYGEN_SOLUBILITY_H
+
+#include <stdint.h>
+
+/** Operating envelope of the table, outside it the float equations are used */
+#define SOLUBILITY_MIN_TEMPERATURE 0  /* Celsius */
+#define SOLUBILITY_MAX_TEMPERATURE 35 /* Celsius */
+#define SOLUBILITY_MIN_SALINITY    0  /* PSU */
+#define SOLUBILITY_MAX_SALINITY    40 /* PSU */
+#define SOLUBILITY_STEP_SALINITY   2  /* PSU */
+#define SOLUBILITY_STEPS_PER_C     2  /* Temperature step of 0.5 C */
+#define SOLUBILITY_N_TEMPERATURES \
+    ((SOLUBILITY_MAX_TEMPERATURE - SOLUBILITY_MIN_TEMPERATURE) * SOLUBILITY_STEPS_PER_C + 1)
+#define SOLUBILITY_N_SALINITIES    ((SOLUBILITY_MAX_SALINITY - SOLUBILITY_MIN_SALINITY) / SOLUBILITY_STEP_SALINITY + 1)
+
+/** Maximum difference with the float equations accepted by the self test, mg/l */
+#define SOLUBILITY_TOLERANCE      0.005f
+#define SOLUBILITY_MAX_SATURATION 250 /* %, the self test checks up to this saturation */
+
+/** Solubility at 100% saturation, ug/l, generated by scripts/solubility_table.py */
+extern const uint16_t oxygen_solubility_table[SOLUBILITY_N_TEMPERATURES][SOLUBILITY_N_SALINITIES];
+
+/**
+ * Result of the comparison of the table against the float equations.
+ */
+struct solubility_check {
+    uint32_t n_points; /* Points of the grid compared */
+    float max_error;   /* mg/l */
+    float max_error_saturation;
+    float max_error_temperature;
+    float max_error_salinity;
+    uint32_t table_ns; /* Average time of the table per point */
+    uint32_t float_ns; /* Average time of the float equations per point */
+};
+
+float oxygen_concentration_fast(float saturation, float salinity, float temperature);
+int oxygen_solubility_check(struct solubility_check *check);
+
+#endif /* OXYGEN_SOLUBILITY_H */
@@ -0,0 +1,63 @@
+/**
+ *  \file profiler.h
+ *  \brief Time spent in every phase of the sampling cycle
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include "smart_sensor.h"
+
+enum profile_phase {
+    PROFILE_CYCLE = 0,      /* The complete sampling job */
+    PROFILE_WAKE,           /* Console wake window */
+    PROFILE_PREHEAT,        /* Sensors power up */
+    PROFILE_ACQUIRE,        /* All the smart sensors */
+    PROFILE_JOINS,          /* Measurement joins */
+    PROFILE_RADIO_TX,       /* Transmissions */
+    PROFILE_RADIO_ACK,      /* Waiting for acknowledgments */
+    PROFILE_RADIO_RX,       /* Receive windows and commands */
+    PROFILE_STORAGE_APPEND, /* Writing frames to the storage */
+    PROFILE_STORAGE_DRAIN,  /* Sending the frames in the storage */
+    PROFILE_DISPLAY,        /* Drawing the display */
+    PROFILE_DATALOGGER,     /* Datalogger append */
+    PROFILE_PHASE_END
+};
+
+/**
+ * Timestamp of the beginning of a phase.
+ */
+struct profile_mark {
+    uint32_t cycles;
+    uint32_t uptime_ms;
+};
+
+/**
+ * Statistics of a phase, us. The average, minimum and maximum are weighted to
+ * the recent samples, every sample has a weight of 1 / (1 << PROFILE_EWMA_SHIFT),
+ * so a long uptime does not hide a recent change.
+ */
+struct profile_stats {
+    uint32_t count;   /* Samples since the reset */
+    uint32_t last_us; /* Last sample */
+    uint32_t min_us;
+    uint32_t avg_us;
+    uint32_t max_us;
+};
+
+#define PROFILE_EWMA_SHIFT 3
+
+struct profile_mark profiler_start(void);
+uint32_t profiler_elapsed_us(struct profile_mark mark);
+void profiler_stop(enum profile_phase phase, struct profile_mark mark);
+void profiler_stop_driver(enum sensor_manufacturer manufacturer, struct profile_mark mark);
+void profiler_reset(void);
+const char *profiler_phase_name(enum profile_phase phase);
+void profiler_get(enum profile_phase phase, struct profile_stats *stats);
+void profiler_get_driver(enum sensor_manufacturer manufacturer, struct profile_stats *stats);
+uint32_t profiler_average_us(const struct profile_stats *stats);
+
+#endif /* PROFILER_H */
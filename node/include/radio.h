@@ -22,6 +22,24 @@
 #define CHANNEL_DOWNLINK_6 926900000
 #define CHANNEL_DOWNLINK_7 927500000
 
+/*
+ * Length of a typical measurement frame. For the bandwidth and datarate of every
+ * distance, its time on air is close to the old hand-tuned values (33, 350, 699 ms).
+ */
+#define RADIO_REFERENCE_FRAME_LEN 72
+
+/**
+ * Time the radio was transmitting and receiving.
+ */
+struct radio_airtime {
+    uint32_t tx_ms;       /* Transmission time in the cycle */
+    uint32_t rx_ms;       /* Reception time in the cycle */
+    uint16_t tx_frames;   /* Frames sent in the cycle */
+    uint16_t rx_windows;  /* Receive windows opened in the cycle */
+    uint32_t total_tx_ms; /* Transmission time since boot */
+    uint32_t total_rx_ms; /* Reception time since boot */
+};
+
 struct mac_address {
     uint8_t dev_id[16];
     uint8_t length;
@@ -32,4 +50,10 @@ int radio_send_str(char *str, uint32_t len);
 int send_frame(char *str, uint32_t len);
 int radio_receive_str(char *str, uint32_t len, uint16_t time, char *name);
 int end_device_get_link_quality(void);
+void radio_get_link_stats(int16_t *last_rssi, int8_t *last_snr);
+uint32_t radio_time_on_air_ms(uint32_t len, uint8_t datarate, uint8_t bandwidth);
+uint32_t radio_frame_time_on_air(void);
+void radio_airtime_new_cycle(void);
+void radio_get_airtime(struct radio_airtime *current, struct radio_airtime *last_cycle);
+uint32_t radio_airtime_charge_uah(const struct radio_airtime *a);
 int get_mac_address(struct mac_address *mac);
@@ -0,0 +1,27 @@
+/**
+ *  \file response_timeout.h
+ *  \brief Response timeout learned from the latency of a sensor
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+
+#ifndef RESPONSE_TIMEOUT_H
+#define RESPONSE_TIMEOUT_H
+
+#include <stdint.h>
+
+/**
+ * Latency estimator, as the retransmission timer of TCP (RFC 6298).
+ */
+struct response_timeout {
+    uint32_t srtt_x8;   /* Smoothed latency, ms * 8 */
+    uint32_t rttvar_x4; /* Smoothed deviation of the latency, ms * 4 */
+    uint16_t samples;   /* Responses measured */
+};
+
+void response_timeout_init(struct response_timeout *rt);
+void response_timeout_update(struct response_timeout *rt, uint32_t latency_ms);
+void response_timeout_expired(struct response_timeout *rt);
+uint32_t response_timeout_get(const struct response_timeout *rt, uint32_t max_ms);
+
+#endif /* RESPONSE_TIMEOUT_H */
@@ -0,0 +1,49 @@
+/**
+ *  \file scheduler.h
+ *  \brief Periodic jobs of the node
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+enum scheduler_job_id {
+    JOB_SAMPLING = 0,
+    JOB_PING,
+    JOB_DATALOGGER,
+    JOB_STORAGE,
+    JOB_DISPLAY,
+    JOB_CONTROL,
+    JOB_END
+};
+
+/**
+ * A periodic job. The period is read from the configuration every time the job
+ * runs, so changes from the shell are applied on the next run.
+ */
+struct scheduler_job {
+    const char *name;
+    void (*run)(void);
+    uint32_t (*period_ms)(void); /* Period of the job, 0 to disable it */
+};
+
+/**
+ * Statistics of a job.
+ */
+struct scheduler_job_stats {
+    uint32_t period_ms;       /* Period in use */
+    uint32_t runs;            /* Times the job has run */
+    uint32_t misses;          /* Periods skipped because the node was busy */
+    uint32_t max_lateness_ms; /* Maximum delay from the deadline to the start of the job */
+    uint32_t last_run_ms;     /* Duration of the last run */
+};
+
+void scheduler_add(enum scheduler_job_id id, const struct scheduler_job *job, uint32_t first_run_ms);
+void scheduler_run_pending(void);
+uint32_t scheduler_time_to_next_job(void);
+void scheduler_get_stats(enum scheduler_job_id id, const char **name, struct scheduler_job_stats *stats);
+
+#endif /* SCHEDULER_H */
@@ -10,6 +10,8 @@
 #ifndef SENSOR_POWER_HW_H
 #define SENSOR_POWER_HW_H
 
+#define SENSOR_RELAY_PULSE_US 100000 /* Pulse of the bi-stable relay of the external voltage */
+
 /**
  * Initialize the sensors' power control
  */
@@ -9,6 +9,7 @@ int wake_up(char *str);
 int to_sleep(char *str);
 int set_name(char *str);
 int set_sampling_interval(char *str);
+int set_wake_interval(char *str);
 int set_display_contrast(char *str);
 int save_configuration(char *str);
 int cmd_set_saturation_conf(char *str);
@@ -34,6 +35,20 @@ int cmd_set_sensor_driver(char *str);
 int cmd_set_sensor_config(char *str);
 int cmd_detect_sensors(char *str);
 int cmd_volume_porcentage(char *str);
+int cmd_adr(char *str);
+int cmd_airtime(char *str);
+int cmd_jobs(char *str);
+int cmd_stats(char *str);
+int cmd_energy(char *str);
+int cmd_sensors(char *str);
+int cmd_uplink(char *str);
+int cmd_deadband(char *str);
+int cmd_joins(char *str);
+int cmd_o2check(char *str);
+int cmd_control(char *str);
+int cmd_pulse(char *str);
+int cmd_gps(char *str);
+int cmd_nmeacheck(char *str);
 
 #define SIZE_COMMAND 40
 
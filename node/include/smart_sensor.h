@@ -2,7 +2,9 @@
 #define _SMART_SENSOR_H
 
 #include <stdint.h>
+#include <zephyr/sys/iterable_sections.h>
 #include "measurement.h"
+#include "response_timeout.h"
 
 /* Defines */
 #define SIZE_SMART_SENSOR_NAME 10 /* Max size of the sensor ID */
@@ -15,6 +17,8 @@
 
 /**
  * Sensor manufacturers
+ * The values are saved in NVS (enabled and detected drivers). Add the new
+ * manufacturers at the end, never reorder them.
  */
 enum sensor_manufacturer {
     MANUFACTURER_NONE, /* Invalid manufacturer */
@@ -43,6 +47,33 @@ enum sensor_manufacturer {
     SENSOR_MANUFACTURER_END
 };
 
+/**
+ * Kind of command sent to a sensor, every one has its own response timeout
+ */
+enum sensor_command {
+    SENSOR_COMMAND_MEASUREMENT = 0, /* Requests while acquiring */
+    SENSOR_COMMAND_CONTROL,         /* Power modes and configuration while preparing */
+    SENSOR_COMMAND_END
+};
+
+/**
+ * Acquisition statistics of a smart sensor and its retry budget
+ */
+struct smart_sensor_stats {
+    uint32_t successes;
+    uint32_t failures;              /* Failed acquisitions with an answer from the sensor */
+    uint32_t timeouts;              /* Failed acquisitions without answer */
+    uint32_t skipped;               /* Cycles skipped while backing off */
+    uint16_t consecutive_successes;
+    uint16_t consecutive_failures;
+    uint16_t backoff_cycles;        /* Cycles to skip after the next failure */
+    uint16_t skip_remaining;        /* Cycles left before trying again */
+    uint32_t last_latency_ms;
+    uint32_t avg_latency_ms;        /* Moving average of the successful acquisitions */
+    uint32_t max_latency_ms;
+    uint8_t tries;                  /* Tries given in the last acquisition */
+};
+
 /**
  * Structure to keep the information of a smart sensor
  */
@@ -55,6 +86,8 @@ struct smart_sensor {
     int power_up_time; /* Time required before taking a measurement, in milliseconds. */
     int version;       /* A version number in case of different protocols */
     char name[SIZE_SMART_SENSOR_NAME];
+    struct smart_sensor_stats stats;
+    struct response_timeout response_timeouts[SENSOR_COMMAND_END];
 };
 
 /**
@@ -62,7 +95,6 @@ struct smart_sensor {
  * This structure keeps a list of all the functions a smart sensor can have.
  */
 struct smart_sensor_driver {
-    int (*max_sensors)(void);                                      /* Maximum number of sensors for this driver */
     int (*init_driver)(void);                                      /* Initialize the driver */
     int (*finish_driver)(void);                                    /* Finish the operations with the driver */
     int (*detect)(int sensor_number, struct smart_sensor *sensor); /* Detect a sensor */
@@ -73,9 +105,33 @@ struct smart_sensor_driver {
     int (*acquire)(int tries, struct smart_sensor *sensor, struct measurement *m);
     int (*pass_command)(struct smart_sensor *sensor, char *command);
     const char *(*name)(void); /* Get a string with the name of the driver or family of sensors */
-    int (*needs_external_voltage)(void);
 };
 
+/**
+ * Entry of the registry of drivers. The properties that don't change at run
+ * time are kept here as constants, not asked to the driver.
+ */
+struct smart_sensor_driver_entry {
+    const struct smart_sensor_driver *driver;
+    enum sensor_manufacturer manufacturer;
+    uint8_t max_sensors;            /* Maximum number of sensors for this driver */
+    uint8_t needs_external_voltage; /* The sensors are powered with the external 12V */
+    uint8_t exclusive;              /* Owns the bus: after it, no other family is probed if a sensor was found */
+};
+
+/**
+ * Register a driver. The entries of all the drivers are collected by the linker
+ * in the smart_sensor_driver_entry section.
+ */
+#define SMART_SENSOR_DRIVER_REGISTER(_driver, _manufacturer, _max_sensors, _external_voltage, _exclusive) \
+    const STRUCT_SECTION_ITERABLE(smart_sensor_driver_entry, _driver##_entry) = {                        \
+        .driver = &(_driver),                                                                           \
+        .manufacturer = (_manufacturer),                                                                \
+        .max_sensors = (_max_sensors),                                                                  \
+        .needs_external_voltage = (_external_voltage),                                                  \
+        .exclusive = (_exclusive),                                                                      \
+    }
+
 /**
  * Drivers for every sensor type
  * TODO Do they need to be here?
@@ -127,6 +183,11 @@ int smart_sensors_detect_all(void);
  */
 void smart_sensors_prepare(void);
 
+/**
+ * Prepare one smart sensor
+ */
+void smart_sensor_prepare(int sensor_number);
+
 /**
  * Prepare all the smart sensor
  */
@@ -153,12 +214,21 @@ int smart_sensor_can_calibrate(int sensor_number);
 
 /**
  * Acquire all the smart sensors and store the measuruemnts in the specified array.
+ * Reliable sensors get one try, the others communication_tries, and the sensors
+ * that stop answering are skipped for an increasing number of cycles.
  * @param n_of_sensor The number of sensors to read
+ * @param communication_tries The maximum number of tries for every sensor
  * @param measurement a pointer to store all the measurements
  * @return the number of measurements acquired
  */
 int smart_sensors_aquire_all(int n_of_sensors, int communication_tries, struct measurement *measurement);
 
+/**
+ * Acquire one smart sensor, with the same retries and statistics of smart_sensors_aquire_all().
+ * @return 1 if acquired, 0 otherwise
+ */
+int smart_sensor_acquire(int sensor_number, int communication_tries, struct measurement *measurement);
+
 /**
  * Finish the operation with the smart sensors
  */
@@ -180,6 +250,12 @@ int smart_sensor_calibrate(int sensor_number, float cal_value);
  */
 const struct smart_sensor_driver *driver_for_manufacturer(enum sensor_manufacturer manufacturer);
 
+/**
+ * Get the registry entry of the enabled driver for the specified manufacturer
+ * @return The entry or NULL if the driver is not enabled
+ */
+const struct smart_sensor_driver_entry *driver_entry_for_manufacturer(enum sensor_manufacturer manufacturer);
+
 /**
  * Initialize the serial port used to communicate with the smart sensor
  */
@@ -209,6 +285,29 @@ int get_sensors_preheat_time_ms(void);
  */
 int smart_sensor_receive_data(char *response, uint8_t size);
 
+/**
+ * Select the sensor and the kind of command being sent, for the response
+ * timeouts. NULL when there is no sensor selected, as in the detection.
+ */
+void smart_sensor_set_active(struct smart_sensor *sensor, enum sensor_command command);
+
+/**
+ * Time to wait for the first byte of a response from the active sensor.
+ * @param max_ms The worst case response time of the sensor
+ * @return The learned timeout, or max_ms if there is no active sensor
+ */
+uint32_t smart_sensor_response_timeout(uint32_t max_ms);
+
+/**
+ * The active sensor started to answer after latency_ms.
+ */
+void smart_sensor_response_received(uint32_t latency_ms);
+
+/**
+ * The active sensor did not answer in timeout_ms.
+ */
+void smart_sensor_response_timedout(uint32_t timeout_ms, uint32_t max_ms);
+
 /**
  * Get a string from the sensors UART. Return immediately after receiving a
  * newline or after a timeout. The newline is not included in the buffer.
@@ -236,7 +335,7 @@ int has_sensor_list_changed(int n_of_sensors, enum sensor_type *configured_senso
 uint32_t tics_elapsed(uint32_t tic_stamp);
 
 /**
- * Restores drivers saved in the NVS
+ * Restores the drivers enabled in the NVS from the registry of drivers
  */
 void configure_sensor_drivers(void);
 
@@ -246,10 +345,15 @@ void configure_sensor_drivers(void);
 void sensor_switch(enum sensor_manufacturer manufacturer, int state);
 
 /**
- * Function that checks if external 12V are needed
+ * Function that checks if external 12V are needed by the enabled drivers
  */
 int smart_sensors_detect_voltage(void);
 
+/**
+ * Cut the power of the smart sensors, and the external 12V if it is used
+ */
+void smart_sensors_power_off(void);
+
 /*
  * @brief: passes pressure unit, only kPa or bar at the moment
  */
@@ -11,6 +11,11 @@
 #ifndef SOLENOID_H
 #define SOLENOID_H
 
+#define SOLENOID_CHARGED_MV       7500 /* The capacitor is charged */
+#define SOLENOID_POWER_LOW_MV     7200 /* Not charged enough to move the valve */
+#define SOLENOID_CHARGE_POLL_MS   50   /* Checks of the voltage while charging */
+#define SOLENOID_CHARGE_MAX_POLLS 20
+
 /**
  * Status of the solenoid operations
  */
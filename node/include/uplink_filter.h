@@ -0,0 +1,40 @@
+/**
+ *  \file uplink_filter.h
+ *  \brief Report by exception, send only the measurements that changed
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+
+#ifndef UPLINK_FILTER_H
+#define UPLINK_FILTER_H
+
+#include <stdint.h>
+#include "measurement.h"
+#include "bsp-config.h"
+#include "defaults.h"
+
+#define UPLINK_FILTER_NODE_SLOT  (MAX_EXTERNAL_SENSORS)     /* Slot of the internal sensors of the node */
+#define UPLINK_FILTER_VALVE_SLOT (MAX_EXTERNAL_SENSORS + 1) /* Slot of the first valve */
+#define UPLINK_FILTER_SLOTS      (MAX_EXTERNAL_SENSORS + 1 + MAX_N_VALVES)
+
+/**
+ * Compact copy of a reported measurement. The variables are kept in steps of
+ * a fraction of their deadband, so the comparison is not affected by the
+ * rounding.
+ */
+struct reported_measurement {
+    int32_t steps[AGGREGATION_MAX_FIELDS]; /* Value / (deadband / UPLINK_DEADBAND_STEPS) */
+    uint8_t n_fields;
+    uint8_t sensor_status;  /* enum sensor_status */
+    uint8_t fields_invalid; /* Bit per variable without a valid value */
+    uint8_t fields_always;  /* Bit per variable without a deadband, sent every sample */
+    uint8_t valid;          /* There is a reported value in this slot */
+};
+
+void uplink_filter_reset(void);
+void uplink_filter_begin(void);
+int uplink_filter_report(int slot, const struct measurement *m);
+void uplink_filter_commit(void);
+int uplink_filter_heartbeat_due(void);
+
+#endif /* UPLINK_FILTER_H */
@@ -10,7 +10,11 @@
 #ifndef USERINTERFACE_H_
 #define USERINTERFACE_H_
 
+#include <stdint.h>
 #include "measurement.h"
+#include "bsp-config.h"
+
+#define DISPLAY_FRAME_BYTES (DISPLAY_ROWS / 8 * DISPLAY_COLUMNS) /* Bytes sent for a frame, in pages of 8 rows */
 
 /**
  * A generic measurement to be displayed. The variables are classified in
@@ -23,11 +27,37 @@ struct visual_measurement {
     char *format;                   /* The format to print the value */
 };
 
+/**
+ * Statistics of the transfers of the frame buffer to the display, from all
+ * the screens
+ */
+struct display_flush_stats {
+    uint32_t flushes; /* Frames sent to the display */
+    uint32_t skipped; /* Flushes avoided because the frame was the same */
+    uint32_t bytes;   /* Bytes sent to the display */
+};
+
 /**
  * initialize the lcd, then clears it.
  */
 void init_and_clear_lcd(void);
 
+/**
+ * Send the frame buffer to the display, unless it is the same frame that was
+ * sent the last time. The driver always sends the complete frame.
+ * @return 1 if the frame was sent, 0 if it was skipped
+ */
+int display_flush_changed(void);
+
+/**
+ * Forget what the display shows, the next display_flush_changed() sends the
+ * complete frame. Call it when the controller could have lost its memory.
+ */
+void display_invalidate(void);
+
+void display_get_flush_stats(struct display_flush_stats *stats);
+void display_reset_flush_stats(void);
+
 /**
  * Display a welcome message with the firmware version strings
  */
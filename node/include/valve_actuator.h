@@ -0,0 +1,43 @@
+/**
+ *  \file valve_actuator.h
+ *  \brief Pulses of the bi-stable valves, in the background
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+
+#ifndef VALVE_ACTUATOR_H
+#define VALVE_ACTUATOR_H
+
+#include <stdint.h>
+#include "adc.h"
+#include "bsp-config.h"
+#include "solenoid.h"
+
+/* Worst case to give the default pulses of every valve */
+#define VALVE_ACTUATOR_DRAIN_MS (2000 * 3 * MAX_N_VALVES)
+
+enum valve_pulse_direction {
+    VALVE_PULSE_FORWARD,
+    VALVE_PULSE_REVERSE,
+};
+
+/**
+ * Solenoid supply during the last pulse of a valve
+ */
+struct valve_pulse_capture {
+    int16_t mv_charged;  /* Before the pulse */
+    uint8_t n_samples;   /* 0 if the capture failed, only the finish voltage was read */
+    uint32_t interval_us;
+    int16_t mv[SOLENOID_CAPTURE_MAX_SAMPLES];
+    enum solenoid_status status;
+};
+
+void valve_actuator_init(void);
+void valve_actuator_pulse(int valve_nr, enum valve_pulse_direction direction, uint8_t n_pulses, uint32_t pulse_us);
+enum solenoid_status valve_actuator_pulse_now(int solenoid_nr, enum valve_pulse_direction direction, uint32_t pulse_us);
+enum solenoid_status valve_actuator_status(int valve_nr);
+int valve_actuator_capture(int valve_nr, struct valve_pulse_capture *capture);
+int valve_actuator_busy(void);
+int valve_actuator_wait(uint32_t timeout_ms);
+
+#endif /* VALVE_ACTUATOR_H */
@@ -2,8 +2,26 @@
 #ifndef WATCHDOG_H_
 #define WATCHDOG_H_
 
+#include <stdint.h>
+
+/*
+ * A task must check in before its timeout, or before the time it declared
+ * with watchdog_expect() plus its timeout.
+ */
+#define WATCHDOG_MAX_TASKS           4
+#define WATCHDOG_MAIN_TIMEOUT        20000 /* ms */
+#define WATCHDOG_FLASH_TIME          5000  /* ms, worst case NVS write with garbage collection */
+#define WATCHDOG_FLASH_FORMAT        90000 /* ms, erase of a complete flash */
+#define WATCHDOG_SENSOR_ACQUIRE_TIME 60000 /* ms, acquisition of one smart sensor */
+#define WATCHDOG_VALVES_TIMEOUT      2000  /* ms, one step of the valve pulses, plus the length of the pulse */
+
 int watchdog_init(void);
 void watchdog_reset(void);
-void watchdog_disable(void);
+void watchdog_expect(uint32_t duration_ms);
+
+int watchdog_task_register(const char *name, uint32_t timeout_ms);
+void watchdog_task_checkin(int task);
+void watchdog_task_expect(int task, uint32_t duration_ms);
+void watchdog_task_idle(int task);
 
 #endif
@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+"""
+Generate src/oxygen_solubility_table.c, the solubility of oxygen in ug/l at
+100% saturation used by oxygen_solubility.c. Garcia and Gordon (1992), with
+the Benson and Krause fit, the same equations as oxygen_concentration().
+
+Usage: scripts/solubility_table.py > src/oxygen_solubility_table.c
+The steps must match the SOLUBILITY_* defines of include/oxygen_solubility.h.
+"""
+import math
+
+MIN_TEMPERATURE = 0
+MAX_TEMPERATURE = 35
+STEPS_PER_C = 2
+MIN_SALINITY = 0
+MAX_SALINITY = 40
+STEP_SALINITY = 2
+
+A = [2.00907, 3.22014, 4.0501, 4.94457, -0.256847, 3.88767]
+B = [-6.24523e-3, -7.37614e-3, -1.0341e-2, -8.17083e-3]
+C0 = -4.88682e-7
+ML_TO_MG = 1.42905
+
+
+def solubility(temperature, salinity):
+    """Oxygen at 100% saturation, mg/l"""
+    ts = math.log((298.15 - temperature) / (273.15 + temperature))
+    ln = sum(a * ts**i for i, a in enumerate(A))
+    ln += salinity * sum(b * ts**i for i, b in enumerate(B)) + C0 * salinity * salinity
+    return math.exp(ln) * ML_TO_MG
+
+
+def main():
+    n_temperatures = (MAX_TEMPERATURE - MIN_TEMPERATURE) * STEPS_PER_C + 1
+    salinities = range(MIN_SALINITY, MAX_SALINITY + 1, STEP_SALINITY)
+    print("/**")
+    print(" *  \\file oxygen_solubility_table.c")
+    print(" *  \\brief Solubility of oxygen at 100% saturation, ug/l")
+    print(" *")
+    print(" *  Generated by scripts/solubility_table.py, do not edit.")
+    print(" *  Rows every %g C from %i C, columns every %i PSU from %i PSU." %
+          (1 / STEPS_PER_C, MIN_TEMPERATURE, STEP_SALINITY, MIN_SALINITY))
+    print(" *")
+    print(" *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.")
+    print(" */")
+    print('#include "oxygen_solubility.h"')
+    print()
+    print("const uint16_t oxygen_solubility_table[SOLUBILITY_N_TEMPERATURES][SOLUBILITY_N_SALINITIES] = {")
+    for t in range(n_temperatures):
+        temperature = MIN_TEMPERATURE + t / STEPS_PER_C
+        values = [round(solubility(temperature, s) * 1000) for s in salinities]
+        first = ", ".join("%5i" % v for v in values[:11])
+        second = ", ".join("%5i" % v for v in values[11:])
+        print("    {%s, /* %.1f C */" % (first, temperature))
+        print("     %s}," % second)
+    print("};")
+
+
+if __name__ == "__main__":
+    main()
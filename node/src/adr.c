@@ -0,0 +1,174 @@
+/**
+ *  \file adr.c
+ *  \brief Adaptive data rate and transmission power for the uplink
+ *
+ *  The SNR of the acknowledgments sent by the coordinator is kept in a small
+ *  window. With the best SNR of the window we choose the lowest spreading
+ *  factor (never above the configured one) that still has ADR_INSTALLATION_MARGIN
+ *  dB over the demodulation floor, and use the remaining margin to lower the
+ *  transmission power. The link is assumed symmetric, so every dB of power
+ *  below ADR_MAX_TX_POWER is taken from the measured margin.
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+#include <string.h>
+#include <zephyr/drivers/lora.h>
+#include "adr.h"
+#include "configuration.h"
+#include "debug.h"
+
+struct adr_state adr;
+
+/*
+ * Minimum SNR needed to demodulate every spreading factor, SX1276 datasheet.
+ * Indexed by SF - SF_7. Tenths of dB.
+ */
+static const int16_t required_snr[] = {-75, -100, -125, -150, -175, -200};
+
+static int16_t required_snr_for(uint8_t datarate)
+{
+    if (datarate < SF_7) {
+        return required_snr[0];
+    }
+    if (datarate > SF_12) {
+        return required_snr[SF_12 - SF_7];
+    }
+    return required_snr[datarate - SF_7];
+}
+
+static int8_t best_snr(void)
+{
+    int8_t best = adr.snr[0];
+
+    for (int i = 1; i < adr.n_samples; i++) {
+        if (adr.snr[i] > best) {
+            best = adr.snr[i];
+        }
+    }
+    return best;
+}
+
+/*
+ * Choose the uplink datarate and power from the statistics in the window.
+ */
+static void adr_update(void)
+{
+    /* Headroom with the maximum power, tenths of dB */
+    int headroom = (best_snr() - ADR_INSTALLATION_MARGIN) * 10;
+    uint8_t datarate = cfg.datarate;
+    int power_reduction;
+
+    for (uint8_t sf = SF_7; sf < cfg.datarate; sf++) {
+        if (required_snr_for(sf) <= headroom) {
+            datarate = sf;
+            break;
+        }
+    }
+    power_reduction = (headroom - required_snr_for(datarate)) / 10;
+    power_reduction -= power_reduction % ADR_TX_POWER_STEP;
+    if (power_reduction < 0) {
+        power_reduction = 0;
+    } else if (power_reduction > ADR_MAX_TX_POWER - ADR_MIN_TX_POWER) {
+        power_reduction = ADR_MAX_TX_POWER - ADR_MIN_TX_POWER;
+    }
+    if (datarate != adr.datarate || ADR_MAX_TX_POWER - power_reduction != adr.tx_power) {
+        DEBUG("ADR: SF %i -> %i, power %i -> %i dBm\n",
+              adr.datarate,
+              datarate,
+              adr.tx_power,
+              ADR_MAX_TX_POWER - power_reduction);
+    }
+    adr.datarate = datarate;
+    adr.tx_power = ADR_MAX_TX_POWER - power_reduction;
+}
+
+/**
+ * Forget the statistics and go back to the configured datarate and maximum power.
+ */
+void adr_reset(void)
+{
+    memset(&adr, 0, sizeof(adr));
+    adr.datarate = cfg.datarate;
+    adr.tx_power = ADR_MAX_TX_POWER;
+}
+
+/**
+ * Add the link statistics of a received acknowledgment.
+ */
+void adr_ack_received(int16_t rssi, int8_t snr)
+{
+    adr.missed_acks = 0;
+    adr.snr[adr.next] = snr;
+    adr.rssi[adr.next] = rssi;
+    adr.next = (adr.next + 1) % ADR_WINDOW_SIZE;
+    if (adr.n_samples < ADR_WINDOW_SIZE) {
+        adr.n_samples++;
+    }
+    if (cfg.adr_enabled && adr.n_samples == ADR_WINDOW_SIZE) {
+        adr_update();
+    }
+}
+
+/**
+ * A frame was not acknowledged. After some consecutive misses, the link
+ * estimation is not valid anymore.
+ */
+void adr_ack_missed(void)
+{
+    adr.missed_acks++;
+    if (adr.missed_acks >= ADR_MAX_MISSED_ACKS &&
+        (adr.datarate != cfg.datarate || adr.tx_power != ADR_MAX_TX_POWER)) {
+        DEBUG("ADR: %i acknowledgments missed, back to SF %i\n", adr.missed_acks, cfg.datarate);
+        adr_reset();
+    }
+}
+
+/**
+ * Spreading factor to use for the uplink.
+ */
+uint8_t adr_get_datarate(void)
+{
+    if (!cfg.adr_enabled || adr.datarate > cfg.datarate) {
+        return cfg.datarate;
+    }
+    return adr.datarate;
+}
+
+/**
+ * Transmission power to use for the uplink, dBm.
+ */
+int8_t adr_get_tx_power(void)
+{
+    if (!cfg.adr_enabled) {
+        return ADR_MAX_TX_POWER;
+    }
+    return adr.tx_power;
+}
+
+/**
+ * Estimated SNR margin of the uplink over the demodulation floor, dB.
+ * Returns 0 if there are no statistics yet.
+ */
+int adr_get_link_margin(void)
+{
+    if (adr.n_samples == 0) {
+        return 0;
+    }
+    return best_snr() - required_snr_for(adr_get_datarate()) / 10 - (ADR_MAX_TX_POWER - adr_get_tx_power());
+}
+
+/**
+ * Average RSSI of the acknowledgments in the window, dBm.
+ */
+int16_t adr_get_average_rssi(void)
+{
+    int32_t sum = 0;
+
+    if (adr.n_samples == 0) {
+        return 0;
+    }
+    for (int i = 0; i < adr.n_samples; i++) {
+        sum += adr.rssi[i];
+    }
+    return sum / adr.n_samples;
+}
@@ -1,4 +1,6 @@
 
+#include <stddef.h>
+#include <string.h>
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/flash.h>
 #include <zephyr/storage/flash_map.h>
@@ -9,6 +11,7 @@
 #include "defaults.h"
 #include "radio.h"
 #include "smart_sensor.h"
+#include "errorcodes.h"
 
 struct configuration cfg;
 struct sensor_config sen_drv;
@@ -19,12 +22,270 @@ static uint32_t _time_offset; /* zero-initialized by C */
 #define NVS_PARTITION_DEVICE FIXED_PARTITION_DEVICE(NVS_PARTITION)
 #define NVS_PARTITION_OFFSET FIXED_PARTITION_OFFSET(NVS_PARTITION)
 
-#define CONFIG_ID         1
+#define CONFIG_ID         1 /* Old layout, the whole struct configuration in one item */
 #define SENSOR_DRIVERS_ID 2
+#define CONFIG_LAYOUT_ID  3 /* Present when the configuration is stored one key per field */
+#define SENSOR_DRIVERS_MASK_ID 4 /* struct sensor_config, replaces SENSOR_DRIVERS_ID */
+
+#define CONFIG_LAYOUT_VERSION 1
+/* End of the last field of the blob layout, the padding after it is not configuration */
+#define CONFIG_BLOB_END (offsetof(struct configuration, total_volume) + sizeof(cfg.total_volume))
+#define CONFIG_KEY_BASE       0x100 /* NVS id of the first configuration key */
+#define CONFIG_FIELD_MAX_SIZE 64
+
+/*
+ * NVS key of every field of the configuration. The keys are stable between
+ * firmware versions: never renumber or reuse them, add the new ones at the end.
+ */
+enum config_key {
+    CONFIG_KEY_CHANNEL = 0,
+    CONFIG_KEY_UPLINK_CHANNEL,
+    CONFIG_KEY_DOWNLINK_CHANNEL,
+    CONFIG_KEY_SAMPLING_INTERVAL,
+    CONFIG_KEY_WAKE_INTERVAL,
+    CONFIG_KEY_LOG_INTERVAL,
+    CONFIG_KEY_PING_INTERVAL,
+    CONFIG_KEY_NAME,
+    CONFIG_KEY_N_CHANGES,
+    CONFIG_KEY_SALINITY,
+    CONFIG_KEY_FIXED_TEMPERATURE,
+    CONFIG_KEY_BATTERY_COEFFICIENT,
+    CONFIG_KEY_V_REF,
+    CONFIG_KEY_LOW_OXYGEN_ALARM,
+    CONFIG_KEY_HIGH_OXYGEN_ALARM,
+    CONFIG_KEY_SENSOR_POWERUP_TIME,
+    CONFIG_KEY_SENSOR_COMMUNICATION_TRIES,
+    CONFIG_KEY_LCD_CONTRAST,
+    CONFIG_KEY_USE_SATURATION,
+    CONFIG_KEY_SENSOR_TYPE,
+    CONFIG_KEY_VALVE_0,
+    CONFIG_KEY_VALVE_1,
+    CONFIG_KEY_VERSION,
+    CONFIG_KEY_COMMAND_STATE,
+    CONFIG_KEY_CONDUCTIVITY_FRESHWATER,
+    CONFIG_KEY_DISTANCE,
+    CONFIG_KEY_BANDWIDTH,
+    CONFIG_KEY_DATARATE,
+    CONFIG_KEY_TEMP_OFFSET,
+    CONFIG_KEY_CURRENT_SENSOR_STATUS,
+    CONFIG_KEY_TOTALIZED_FLOW,
+    CONFIG_KEY_TOTAL_VOLUME,
+    CONFIG_KEY_ADR_ENABLED,
+    CONFIG_KEY_PROFILING_FRAME,
+    CONFIG_KEY_LOAD_CURRENT_UA,
+    CONFIG_KEY_DETECTED_MANUFACTURERS,
+    CONFIG_KEY_UPLINK_MODE,
+    CONFIG_KEY_DEADBAND,
+    CONFIG_KEY_HEARTBEAT_INTERVAL,
+    CONFIG_KEY_CONTROL_INTERVAL,
+    CONFIG_KEY_GPS_MODE,
+};
+
+struct config_field {
+    uint16_t key;
+    uint16_t offset; /* In struct configuration */
+    uint16_t size;
+};
+
+#define CONFIG_FIELD(k, member)                                                                                        \
+    {                                                                                                                  \
+        .key = (k), .offset = offsetof(struct configuration, member),                                                  \
+        .size = sizeof(((struct configuration *)0)->member)                                                            \
+    }
+
+static const struct config_field config_fields[] = {
+    CONFIG_FIELD(CONFIG_KEY_CHANNEL, channel),
+    CONFIG_FIELD(CONFIG_KEY_UPLINK_CHANNEL, uplink_channel),
+    CONFIG_FIELD(CONFIG_KEY_DOWNLINK_CHANNEL, downlink_channel),
+    CONFIG_FIELD(CONFIG_KEY_SAMPLING_INTERVAL, sampling_interval),
+    CONFIG_FIELD(CONFIG_KEY_WAKE_INTERVAL, wake_interval),
+    CONFIG_FIELD(CONFIG_KEY_LOG_INTERVAL, log_interval),
+    CONFIG_FIELD(CONFIG_KEY_PING_INTERVAL, ping_interval),
+    CONFIG_FIELD(CONFIG_KEY_NAME, name),
+    CONFIG_FIELD(CONFIG_KEY_N_CHANGES, n_changes),
+    CONFIG_FIELD(CONFIG_KEY_SALINITY, salinity),
+    CONFIG_FIELD(CONFIG_KEY_FIXED_TEMPERATURE, fixed_temperature),
+    CONFIG_FIELD(CONFIG_KEY_BATTERY_COEFFICIENT, battery_coefficient),
+    CONFIG_FIELD(CONFIG_KEY_V_REF, v_ref),
+    CONFIG_FIELD(CONFIG_KEY_LOW_OXYGEN_ALARM, low_oxygen_alarm),
+    CONFIG_FIELD(CONFIG_KEY_HIGH_OXYGEN_ALARM, high_oxygen_alarm),
+    CONFIG_FIELD(CONFIG_KEY_SENSOR_POWERUP_TIME, sensor_powerup_time),
+    CONFIG_FIELD(CONFIG_KEY_SENSOR_COMMUNICATION_TRIES, sensor_communication_tries),
+    CONFIG_FIELD(CONFIG_KEY_LCD_CONTRAST, lcd_contrast),
+    CONFIG_FIELD(CONFIG_KEY_USE_SATURATION, use_saturation),
+    CONFIG_FIELD(CONFIG_KEY_SENSOR_TYPE, sensor_type),
+    CONFIG_FIELD(CONFIG_KEY_VALVE_0, valve[0]),
+    CONFIG_FIELD(CONFIG_KEY_VALVE_1, valve[1]),
+    CONFIG_FIELD(CONFIG_KEY_VERSION, version),
+    CONFIG_FIELD(CONFIG_KEY_COMMAND_STATE, command_state),
+    CONFIG_FIELD(CONFIG_KEY_CONDUCTIVITY_FRESHWATER, conductivity_freshwater),
+    CONFIG_FIELD(CONFIG_KEY_DISTANCE, distance),
+    CONFIG_FIELD(CONFIG_KEY_BANDWIDTH, bandwidth),
+    CONFIG_FIELD(CONFIG_KEY_DATARATE, datarate),
+    CONFIG_FIELD(CONFIG_KEY_TEMP_OFFSET, temp_offset),
+    CONFIG_FIELD(CONFIG_KEY_CURRENT_SENSOR_STATUS, current_sensor_status),
+    CONFIG_FIELD(CONFIG_KEY_TOTALIZED_FLOW, totalized_flow),
+    CONFIG_FIELD(CONFIG_KEY_TOTAL_VOLUME, total_volume),
+    CONFIG_FIELD(CONFIG_KEY_ADR_ENABLED, adr_enabled),
+    CONFIG_FIELD(CONFIG_KEY_PROFILING_FRAME, profiling_frame),
+    CONFIG_FIELD(CONFIG_KEY_LOAD_CURRENT_UA, load_current_ua),
+    CONFIG_FIELD(CONFIG_KEY_DETECTED_MANUFACTURERS, detected_manufacturers),
+    CONFIG_FIELD(CONFIG_KEY_UPLINK_MODE, uplink_mode),
+    CONFIG_FIELD(CONFIG_KEY_DEADBAND, deadband),
+    CONFIG_FIELD(CONFIG_KEY_HEARTBEAT_INTERVAL, heartbeat_interval),
+    CONFIG_FIELD(CONFIG_KEY_CONTROL_INTERVAL, control_interval),
+    CONFIG_FIELD(CONFIG_KEY_GPS_MODE, gps_mode),
+};
+
+BUILD_ASSERT(MAX_N_VALVES == 2, "Add a configuration key for every valve");
+BUILD_ASSERT(sizeof(((struct configuration *)0)->sensor_type) <= CONFIG_FIELD_MAX_SIZE);
+BUILD_ASSERT(sizeof(struct valve_configuration) <= CONFIG_FIELD_MAX_SIZE);
+BUILD_ASSERT(sizeof(((struct configuration *)0)->load_current_ua) <= CONFIG_FIELD_MAX_SIZE);
+BUILD_ASSERT(sizeof(((struct configuration *)0)->deadband) <= CONFIG_FIELD_MAX_SIZE);
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(configuration, CONFIG_NVS_LOG_LEVEL);
 
+static int write_field(const struct config_field *field)
+{
+    int rc = nvs_write(&fs, CONFIG_KEY_BASE + field->key, (uint8_t *)&cfg + field->offset, field->size);
+
+    if (rc < 0) {
+        LOG_ERR("Error writing the configuration key %i", field->key);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Read one key. A key with a different size, written by a firmware with
+ * another layout, keeps the default value.
+ * Returns 1 if the key was found.
+ */
+static int read_field(const struct config_field *field)
+{
+    uint8_t value[CONFIG_FIELD_MAX_SIZE];
+    int rc = nvs_read(&fs, CONFIG_KEY_BASE + field->key, value, sizeof(value));
+
+    if (rc <= 0) {
+        return 0;
+    }
+    if (rc != field->size) {
+        LOG_WRN("Configuration key %i has %i bytes, expected %i. Using the default", field->key, rc, field->size);
+        return 0;
+    }
+    memcpy((uint8_t *)&cfg + field->offset, value, field->size);
+    return 1;
+}
+
+/*
+ * Write all the keys, NVS skips the ones that did not change.
+ */
+static int write_all_fields(void)
+{
+    int ret = 0;
+
+    for (int i = 0; i < ARRAY_SIZE(config_fields); i++) {
+        if (write_field(&config_fields[i]) < 0) {
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+/*
+ * Mark the configuration as stored one key per field.
+ */
+static void write_layout(void)
+{
+    uint16_t layout = CONFIG_LAYOUT_VERSION;
+
+    (void)nvs_write(&fs, CONFIG_LAYOUT_ID, &layout, sizeof(layout));
+}
+
+/*
+ * Move a configuration saved as one blob to one key per field. The blob has the
+ * layout of the firmware that wrote it: the fields were always appended, so the
+ * fields it does not have keep the defaults. Only up to CONFIG_BLOB_END is
+ * read, the tail padding of the blob would overwrite the defaults of the fields
+ * added after it.
+ */
+static int migrate_configuration_blob(void)
+{
+    int rc = nvs_read(&fs, CONFIG_ID, (uint8_t *)&cfg, CONFIG_BLOB_END);
+
+    if (rc <= 0) {
+        return 0;
+    }
+    LOG_INF("Migrating the configuration blob of %i bytes", rc);
+    if (write_all_fields() < 0) {
+        return 1; /* Keep the blob to try again the next boot */
+    }
+    write_layout();
+    (void)nvs_delete(&fs, CONFIG_ID);
+    return 1;
+}
+
+static void load_configuration(void)
+{
+    uint16_t layout;
+    int found = 0;
+
+    set_default_configuration();
+    valves_set_default_configuration();
+    if (nvs_read(&fs, CONFIG_LAYOUT_ID, &layout, sizeof(layout)) == sizeof(layout)) {
+        for (int i = 0; i < ARRAY_SIZE(config_fields); i++) {
+            found += read_field(&config_fields[i]);
+        }
+    } else {
+        found = migrate_configuration_blob();
+        if (!found) {
+            write_layout(); /* Empty storage, the keys will be written one per field */
+        }
+    }
+    if (found) {
+        /* founded! */
+        LOG_DBG("Configuration founded in nvs");
+    } else {
+        /* not founded */
+        LOG_WRN("Configuration NOT founded in nvs");
+        cfg.n_changes = -1;
+    }
+}
+
+/*
+ * The old firmware saved the table of driver pointers. The pointers are not
+ * valid after an update, but the ones that are not NULL tell which drivers
+ * were enabled.
+ */
+static int migrate_sensor_drivers(void)
+{
+    struct {
+        int16_t n_changes;
+        uint32_t sensor_driver[SENSOR_MANUFACTURER_END]; /* Pointers, 32 bits in this MCU */
+    } old;
+    int rc = nvs_read(&fs, SENSOR_DRIVERS_ID, (uint8_t *)&old, sizeof(old));
+    int n_drivers;
+
+    if (rc <= 0) {
+        return rc;
+    }
+    n_drivers = MIN((rc - (int)offsetof(typeof(old), sensor_driver)) / (int)sizeof(uint32_t), SENSOR_MANUFACTURER_END);
+    sen_drv.n_changes = old.n_changes;
+    sen_drv.enabled_manufacturers = 0;
+    for (int i = 0; i < n_drivers; i++) {
+        if (old.sensor_driver[i] != 0) {
+            sen_drv.enabled_manufacturers |= BIT(i);
+        }
+    }
+    LOG_INF("Migrating the sensor drivers: %x", sen_drv.enabled_manufacturers);
+    rc = nvs_write(&fs, SENSOR_DRIVERS_MASK_ID, (uint8_t *)&sen_drv, sizeof(sen_drv));
+    if (rc >= 0) {
+        (void)nvs_delete(&fs, SENSOR_DRIVERS_ID);
+    }
+    return sizeof(sen_drv);
+}
+
 int read_nvs_data(void)
 {
     int rc = 0;
@@ -55,17 +316,12 @@ int read_nvs_data(void)
     }
     /* ends init */
 
-    rc = nvs_read(&fs, CONFIG_ID, (uint8_t *)&cfg, sizeof(cfg));
-    if (rc > 0) {
-        /* founded! */
-        LOG_DBG("Configuration founded in nvs");
-    } else {
-        /* not founded */
-        LOG_WRN("Configuration NOT founded in nvs");
-        cfg.n_changes = -1;
-    }
+    load_configuration();
 
-    rc = nvs_read(&fs, SENSOR_DRIVERS_ID, (uint8_t *)&sen_drv, sizeof(sen_drv));
+    rc = nvs_read(&fs, SENSOR_DRIVERS_MASK_ID, (uint8_t *)&sen_drv, sizeof(sen_drv));
+    if (rc != sizeof(sen_drv)) {
+        rc = migrate_sensor_drivers();
+    }
     if (rc > 0) {
         /* founded! */
         LOG_DBG("Sensor drivers founded in nvs");
@@ -84,10 +340,7 @@ int read_nvs_data(void)
 int write_configuration(void)
 {
     cfg.n_changes++;
-    int rc = 0;
-
-    rc = nvs_write(&fs, CONFIG_ID, (uint8_t *)&cfg, sizeof(cfg));
-    if (rc < 0) {
+    if (write_all_fields() < 0) {
         LOG_ERR("Error writing the configuration to the nvs");
         return -1;
     }
@@ -96,12 +349,29 @@ int write_configuration(void)
     return 0;
 }
 
+/*
+ * Save only one field of the configuration, without changing the counter.
+ * field must point into cfg, as &cfg.totalized_flow.
+ */
+int write_configuration_field(const void *field)
+{
+    size_t offset = (const uint8_t *)field - (const uint8_t *)&cfg;
+
+    for (int i = 0; i < ARRAY_SIZE(config_fields); i++) {
+        if (config_fields[i].offset == offset) {
+            return write_field(&config_fields[i]);
+        }
+    }
+    LOG_ERR("No configuration key at offset %i", (int)offset);
+    return -E_INVALID;
+}
+
 int write_sensor_configuration(void)
 {
     sen_drv.n_changes++;
     int rc = 0;
 
-    rc = nvs_write(&fs, SENSOR_DRIVERS_ID, (uint8_t *)&sen_drv, sizeof(sen_drv));
+    rc = nvs_write(&fs, SENSOR_DRIVERS_MASK_ID, (uint8_t *)&sen_drv, sizeof(sen_drv));
     if (rc < 0) {
         LOG_ERR("Error writing the configuration to the nvs");
         return -1;
@@ -118,7 +388,7 @@ void set_default_configuration(void)
 {
     cfg.n_changes = 0;
     cfg.sampling_interval = DEFAULT_SAMPLING_INTERVAL;
-    cfg.wake_interval = 1; /* DEFAULT_WAKE_INTERVAL; */
+    cfg.wake_interval = DEFAULT_WAKE_INTERVAL;
     cfg.log_interval = DEFAULT_LOG_INTERVAL;
     cfg.ping_interval = 60;
     cfg.salinity = DEFAULT_SALINITY;
@@ -139,40 +409,42 @@ void set_default_configuration(void)
     cfg.distance = 0;
     cfg.bandwidth = BW_500_KHZ;
     cfg.datarate = SF_7;
-    cfg.time_on_air = 33;
     strcpy(cfg.name, "1");
     cfg.temp_offset = 0.0;
     cfg.current_sensor_status = 0;
     cfg.totalized_flow = 0;
     cfg.total_volume = 1000;
+    cfg.adr_enabled = 0;
+    cfg.profiling_frame = 0;
+    cfg.load_current_ua[ENERGY_CPU_ACTIVE] = CPU_ACTIVE_CURRENT_UA;
+    cfg.load_current_ua[ENERGY_CPU_IDLE] = CPU_IDLE_CURRENT_UA;
+    cfg.load_current_ua[ENERGY_SENSORS] = SENSORS_CURRENT_UA;
+    cfg.load_current_ua[ENERGY_SENSORS_12V] = SENSORS_12V_CURRENT_UA;
+    cfg.load_current_ua[ENERGY_RADIO_TX] = RADIO_TX_CURRENT_MA * 1000;
+    cfg.load_current_ua[ENERGY_RADIO_RX] = RADIO_RX_CURRENT_MA * 1000;
+    cfg.detected_manufacturers = 0;
+    cfg.uplink_mode = UPLINK_ALL_SAMPLES;
+    cfg.deadband[DEADBAND_OXYGEN] = DEFAULT_DEADBAND_OXYGEN;
+    cfg.deadband[DEADBAND_SATURATION] = DEFAULT_DEADBAND_SATURATION;
+    cfg.deadband[DEADBAND_TEMPERATURE] = DEFAULT_DEADBAND_TEMPERATURE;
+    cfg.deadband[DEADBAND_SALINITY] = DEFAULT_DEADBAND_SALINITY;
+    cfg.deadband[DEADBAND_PH] = DEFAULT_DEADBAND_PH;
+    cfg.deadband[DEADBAND_CONDUCTIVITY] = DEFAULT_DEADBAND_CONDUCTIVITY;
+    cfg.deadband[DEADBAND_PRESSURE] = DEFAULT_DEADBAND_PRESSURE;
+    cfg.deadband[DEADBAND_LEVEL] = DEFAULT_DEADBAND_LEVEL;
+    cfg.deadband[DEADBAND_FLOW] = DEFAULT_DEADBAND_FLOW;
+    cfg.deadband[DEADBAND_VOLTAGE] = DEFAULT_DEADBAND_VOLTAGE;
+    cfg.deadband[DEADBAND_STATE] = DEFAULT_DEADBAND_STATE;
+    cfg.deadband[DEADBAND_OTHER] = DEFAULT_DEADBAND_OTHER;
+    cfg.heartbeat_interval = DEFAULT_HEARTBEAT_INTERVAL;
+    cfg.control_interval = DEFAULT_CONTROL_INTERVAL;
+    cfg.gps_mode = GPS_MODE_COLD;
 }
 
 void set_driver_default(void)
 {
     sen_drv.n_changes = 0;
-    sen_drv.sensor_driver[CHEMINS] = NULL;
-    sen_drv.sensor_driver[NORTEK] = NULL;
-    sen_drv.sensor_driver[LUFFT] = NULL;
-    sen_drv.sensor_driver[VAISALA] = NULL;
-    sen_drv.sensor_driver[INNOVEX] = &smart_sensor_driver_innovex;
-    sen_drv.sensor_driver[MAXBOTIX] = NULL;
-    sen_drv.sensor_driver[PONSEL] = NULL;
-    sen_drv.sensor_driver[TEXAS_INSTRUMENTS] = NULL;
-    sen_drv.sensor_driver[YOSEMITECH] = NULL;
-    sen_drv.sensor_driver[AQUAS] = NULL;
-    sen_drv.sensor_driver[YSI] = NULL;
-    sen_drv.sensor_driver[HUIZHONG] = NULL;
-    sen_drv.sensor_driver[TELEDYNE_ISCO] = NULL;
-    sen_drv.sensor_driver[ANBSENSORS] = NULL;
-    sen_drv.sensor_driver[TDS100] = NULL;
-    sen_drv.sensor_driver[GPS] = NULL;
-    sen_drv.sensor_driver[CHEMINS] = NULL;
-    sen_drv.sensor_driver[SEABIRD] = NULL;
-    sen_drv.sensor_driver[JIANGSU] = NULL;
-    sen_drv.sensor_driver[ACCONEER] = NULL;
-    sen_drv.sensor_driver[AQUADOPP] = NULL;
-    sen_drv.sensor_driver[FLOWQUEST] = NULL;
-    sen_drv.sensor_driver[WITMOTION] = NULL;
+    sen_drv.enabled_manufacturers = BIT(INNOVEX);
 }
 
 void set_current_time(uint32_t *time)
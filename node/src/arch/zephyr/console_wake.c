@@ -0,0 +1,78 @@
+/*
+ * Interrupt driven reception of the console UART.
+ * Zephyr specific implementation
+ *
+ * The interrupt only stores the characters and wakes up the main thread, the
+ * shell runs in the main thread so the commands never race with the sampling or
+ * the radio.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <zephyr/sys/printk.h>
+#include "errorcodes.h"
+#include "multishell.h"
+#include "console_wake.h"
+
+#define CONSOLE_RX_BUFFER_SIZE 64
+
+static const struct device *console_dev = DEVICE_DT_GET(DT_CHOSEN(zephyr_console));
+RING_BUF_DECLARE(console_rx_buffer, CONSOLE_RX_BUFFER_SIZE);
+static K_SEM_DEFINE(console_rx_sem, 0, 1);
+
+static void console_isr(const struct device *dev, void *user_data)
+{
+    uint8_t c;
+
+    ARG_UNUSED(user_data);
+    while (uart_irq_update(dev) && uart_irq_rx_ready(dev)) {
+        if (uart_fifo_read(dev, &c, 1) == 1) {
+            ring_buf_put(&console_rx_buffer, &c, 1);
+            k_sem_give(&console_rx_sem);
+        }
+    }
+}
+
+/**
+ * Enable the reception interrupt of the console UART.
+ */
+int console_wake_init(void)
+{
+    int ret;
+
+    if (!device_is_ready(console_dev)) {
+        printk("Console not ready\n");
+        return -E_NOT_DETECTED;
+    }
+    ret = uart_irq_callback_user_data_set(console_dev, console_isr, NULL);
+    if (ret < 0) {
+        printk("Console interrupt not supported\n");
+        return -E_INVALID;
+    }
+    uart_irq_rx_enable(console_dev);
+    return 0;
+}
+
+/**
+ * Sleep until a character arrives at the console or the timeout expires.
+ */
+int console_wake_wait(uint32_t timeout_ms)
+{
+    uint8_t c;
+    int received = 0;
+    int ret;
+
+    /* The CPU sleeps in the kernel idle thread until the timeout or a character */
+    ret = k_sem_take(&console_rx_sem, K_MSEC(timeout_ms));
+    if (ret != 0) {
+        return 0;
+    }
+    while (ring_buf_get(&console_rx_buffer, &c, 1) == 1) {
+        shell_char_received(c);
+        received = 1;
+    }
+    return received;
+}
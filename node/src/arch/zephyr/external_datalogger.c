@@ -47,9 +47,9 @@ int datalogger_mount(void)
     printk("Flash Start offset : %li\n", info.start_offset);
     printk("flash_pages_index : %d\n", info.index);
 
-    watchdog_disable();
+    watchdog_expect(WATCHDOG_FLASH_TIME);
     rc = nvs_mount(&fs);
-    watchdog_init();
+    watchdog_reset();
     if (rc) {
         LOG_ERR("Flash Init failed");
         return -1;
@@ -62,23 +62,23 @@ uint16_t datalogger_unsended_data_get(void)
 {
     int rc;
 
-    watchdog_disable();
+    watchdog_expect(WATCHDOG_FLASH_TIME);
     rc = nvs_read(&fs, UNSENDED_DATA_ID, &unsended_data, sizeof(unsended_data));
     if (rc <= 0) {
         /* not founded */
         unsended_data = 0;
         (void)nvs_write(&fs, UNSENDED_DATA_ID, &unsended_data, sizeof(unsended_data));
     }
-    watchdog_init();
+    watchdog_reset();
     return unsended_data;
 }
 
 void datalogger_unsended_data_flush_last(void)
 {
     unsended_data--;
-    watchdog_disable();
+    watchdog_expect(WATCHDOG_FLASH_TIME);
     (void)nvs_write(&fs, UNSENDED_DATA_ID, &unsended_data, sizeof(unsended_data));
-    watchdog_init();
+    watchdog_reset();
 }
 /*
  *
@@ -87,7 +87,7 @@ int datalogger_append(uint8_t *meas_data, size_t size)
 {
     int rc = 0;
 
-    watchdog_disable();
+    watchdog_expect(WATCHDOG_FLASH_TIME);
     rc = nvs_write(&fs, MEAS_ID, meas_data, size);
     if (rc < 0) {
         LOG_ERR("Error writing the measurement to the external flash");
@@ -103,7 +103,7 @@ int datalogger_append(uint8_t *meas_data, size_t size)
     }
     unsended_data++;
     (void)nvs_write(&fs, UNSENDED_DATA_ID, &unsended_data, sizeof(unsended_data));
-    watchdog_init();
+    watchdog_reset();
     LOG_INF("measurement written OK\n");
     printk("measurement written OK\n");
     return 0;
@@ -111,19 +111,15 @@ int datalogger_append(uint8_t *meas_data, size_t size)
 
 uint32_t datalogger_get_free_space(void)
 {
-    watchdog_disable();
-    uint32_t res = nvs_calc_free_space(&fs);
-
-    watchdog_init();
-    return res;
+    return nvs_calc_free_space(&fs);
 }
 
 void datalogger_format(void)
 {
     unsended_data = 0;
-    watchdog_disable();
+    watchdog_expect(WATCHDOG_FLASH_FORMAT);
     (void)nvs_clear(&fs);
-    watchdog_init();
+    watchdog_reset();
 }
 /*
  *
@@ -132,9 +128,7 @@ int datalogger_get(uint8_t *meas_data, size_t size, uint16_t n_from_last)
 {
     int rc;
 
-    watchdog_disable();
     rc = nvs_read_hist(&fs, MEAS_ID, meas_data, size, n_from_last);
-    watchdog_init();
     if (rc < 0) {
         LOG_WRN("No more data");
         return -1;
@@ -8,6 +8,7 @@
 #include "measurement_storage.h"
 #include "watchdog.h"
 #include "actual_conditions.h"
+#include "profiler.h"
 
 static struct nvs_fs fs;
 static uint16_t unsended_data;
@@ -121,9 +122,9 @@ int measurement_storage_mount(void)
     printk("Flash Start offset : %li\n", info.start_offset);
     printk("flash_pages_index : %d\n", info.index);
 
-    watchdog_disable();
+    watchdog_expect(WATCHDOG_FLASH_TIME);
     rc = nvs_mount(&fs);
-    watchdog_init();
+    watchdog_reset();
     if (rc) {
         LOG_ERR("Flash Init failed");
         return -1;
@@ -136,23 +137,23 @@ uint16_t unsended_data_get(void)
 {
     int rc;
 
-    watchdog_disable();
+    watchdog_expect(WATCHDOG_FLASH_TIME);
     rc = nvs_read(&fs, UNSENDED_DATA_ID, &unsended_data, sizeof(unsended_data));
     if (rc <= 0) {
         /* not founded */
         unsended_data = 0;
         (void)nvs_write(&fs, UNSENDED_DATA_ID, &unsended_data, sizeof(unsended_data));
     }
-    watchdog_init();
+    watchdog_reset();
     return unsended_data;
 }
 
 void unsended_data_flush_last(void)
 {
     unsended_data--;
-    watchdog_disable();
+    watchdog_expect(WATCHDOG_FLASH_TIME);
     (void)nvs_write(&fs, UNSENDED_DATA_ID, &unsended_data, sizeof(unsended_data));
-    watchdog_init();
+    watchdog_reset();
 }
 /*
  *
@@ -160,8 +161,9 @@ void unsended_data_flush_last(void)
 int measurement_storage_append(uint8_t *meas_data, size_t size)
 {
     int rc = 0;
+    struct profile_mark mark = profiler_start();
 
-    watchdog_disable();
+    watchdog_expect(WATCHDOG_FLASH_TIME);
     rc = nvs_write(&fs, MEAS_ID, meas_data, size);
     if (rc < 0) {
         LOG_ERR("Error writing the measurement to the external flash");
@@ -178,26 +180,23 @@ int measurement_storage_append(uint8_t *meas_data, size_t size)
         rc = measurement_storage_get(test_data, size, unsended_data);
     }
     (void)nvs_write(&fs, UNSENDED_DATA_ID, &unsended_data, sizeof(unsended_data));
-    watchdog_init();
+    watchdog_reset();
+    profiler_stop(PROFILE_STORAGE_APPEND, mark);
     LOG_INF("measurement written OK\n");
     return 0;
 }
 
 uint32_t get_free_space(void)
 {
-    watchdog_disable();
-    uint32_t res = nvs_calc_free_space(&fs);
-
-    watchdog_init();
-    return res;
+    return nvs_calc_free_space(&fs);
 }
 
 void measurement_storage_format(void)
 {
     unsended_data = 0;
-    watchdog_disable();
+    watchdog_expect(WATCHDOG_FLASH_FORMAT);
     (void)nvs_clear(&fs);
-    watchdog_init();
+    watchdog_reset();
 }
 /*
  *
@@ -206,9 +205,7 @@ int measurement_storage_get(uint8_t *meas_data, size_t size, uint16_t n_from_las
 {
     int rc;
 
-    watchdog_disable();
     rc = nvs_read_hist(&fs, MEAS_ID, meas_data, size, n_from_last);
-    watchdog_init();
     if (rc < 0) {
         LOG_WRN("No more data");
         return -1;
@@ -0,0 +1,136 @@
+/*
+ * Time spent in every phase of the sampling cycle.
+ * Zephyr specific implementation
+ *
+ * The phases are measured with the cycle counter. It wraps in about 89 s at
+ * 48 MHz, so the longer phases (preheat, some ADCPs) use the uptime in ms.
+ * The statistics are exponentially weighted, the last eight cycles or so carry
+ * most of the weight.
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include "profiler.h"
+
+#define CYCLE_COUNTER_MAX_MS 60000 /* Use the uptime for phases longer than this */
+
+static struct profile_stats phases[PROFILE_PHASE_END];
+static struct profile_stats drivers[SENSOR_MANUFACTURER_END];
+
+static const char *const phase_names[] = {
+    [PROFILE_CYCLE] = "cycle",
+    [PROFILE_WAKE] = "wake",
+    [PROFILE_PREHEAT] = "preheat",
+    [PROFILE_ACQUIRE] = "acquire",
+    [PROFILE_JOINS] = "joins",
+    [PROFILE_RADIO_TX] = "tx",
+    [PROFILE_RADIO_ACK] = "ack",
+    [PROFILE_RADIO_RX] = "rx",
+    [PROFILE_STORAGE_APPEND] = "append",
+    [PROFILE_STORAGE_DRAIN] = "drain",
+    [PROFILE_DISPLAY] = "display",
+    [PROFILE_DATALOGGER] = "datalogger",
+};
+
+/**
+ * Time since mark, us.
+ */
+uint32_t profiler_elapsed_us(struct profile_mark mark)
+{
+    uint32_t elapsed_ms = k_uptime_get_32() - mark.uptime_ms;
+
+    if (elapsed_ms > CYCLE_COUNTER_MAX_MS) {
+        return elapsed_ms * USEC_PER_MSEC;
+    }
+    return k_cyc_to_us_floor32(k_cycle_get_32() - mark.cycles);
+}
+
+/*
+ * Move value towards us by 1 / (1 << PROFILE_EWMA_SHIFT) of the difference.
+ */
+static uint32_t ewma(uint32_t value, uint32_t us)
+{
+    if (us > value) {
+        return value + ((us - value) >> PROFILE_EWMA_SHIFT);
+    }
+    return value - ((value - us) >> PROFILE_EWMA_SHIFT);
+}
+
+/*
+ * The minimum and maximum follow a new extreme at once and decay towards the
+ * recent samples otherwise.
+ */
+static void add_sample(struct profile_stats *stats, uint32_t us)
+{
+    if (stats->count == 0) {
+        stats->min_us = us;
+        stats->avg_us = us;
+        stats->max_us = us;
+    } else {
+        stats->min_us = us < stats->min_us ? us : ewma(stats->min_us, us);
+        stats->avg_us = ewma(stats->avg_us, us);
+        stats->max_us = us > stats->max_us ? us : ewma(stats->max_us, us);
+    }
+    stats->last_us = us;
+    stats->count++;
+}
+
+/**
+ * Mark the beginning of a phase.
+ */
+struct profile_mark profiler_start(void)
+{
+    struct profile_mark mark = {
+        .cycles = k_cycle_get_32(),
+        .uptime_ms = k_uptime_get_32(),
+    };
+
+    return mark;
+}
+
+/**
+ * Add the time since mark to the statistics of the phase.
+ */
+void profiler_stop(enum profile_phase phase, struct profile_mark mark)
+{
+    add_sample(&phases[phase], profiler_elapsed_us(mark));
+}
+
+/**
+ * Add the time since mark to the acquisition statistics of a driver.
+ */
+void profiler_stop_driver(enum sensor_manufacturer manufacturer, struct profile_mark mark)
+{
+    if (manufacturer < SENSOR_MANUFACTURER_END) {
+        add_sample(&drivers[manufacturer], profiler_elapsed_us(mark));
+    }
+}
+
+void profiler_reset(void)
+{
+    memset(phases, 0, sizeof(phases));
+    memset(drivers, 0, sizeof(drivers));
+}
+
+const char *profiler_phase_name(enum profile_phase phase)
+{
+    return phase_names[phase];
+}
+
+void profiler_get(enum profile_phase phase, struct profile_stats *stats)
+{
+    *stats = phases[phase];
+}
+
+void profiler_get_driver(enum sensor_manufacturer manufacturer, struct profile_stats *stats)
+{
+    *stats = drivers[manufacturer];
+}
+
+/**
+ * Average weighted to the recent samples, 0 if there are none.
+ */
+uint32_t profiler_average_us(const struct profile_stats *stats)
+{
+    return stats->avg_us;
+}
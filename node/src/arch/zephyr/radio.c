@@ -11,6 +11,9 @@
 #include "microio.h"
 #include "configuration.h"
 #include "watchdog.h"
+#include "adr.h"
+#include "profiler.h"
+#include "energy.h"
 
 #define DEFAULT_RADIO_NODE DT_ALIAS(lora0)
 BUILD_ASSERT(DT_NODE_HAS_STATUS(DEFAULT_RADIO_NODE, okay), "No default LoRa radio specified in DT");
@@ -18,12 +21,34 @@ BUILD_ASSERT(DT_NODE_HAS_STATUS(DEFAULT_RADIO_NODE, okay), "No default LoRa radi
 #define MAX_DATA_LEN 255
 #define TRANSMITING  true
 #define RECEIVING    false
+#define PREAMBLE_LEN 8
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(lora_radio, CONFIG_LORA_LOG_LEVEL);
 
 static const struct device *lora_dev;
 static int16_t rssi;
+static int8_t snr;
+static struct radio_airtime airtime;
+static struct radio_airtime last_cycle_airtime;
+
+static void radio_account_tx(uint32_t len)
+{
+    uint32_t toa = radio_time_on_air_ms(len, adr_get_datarate(), cfg.bandwidth);
+
+    airtime.tx_ms += toa;
+    airtime.tx_frames++;
+    airtime.total_tx_ms += toa;
+    energy_account(ENERGY_RADIO_TX, toa);
+}
+
+static void radio_account_rx(uint32_t time_ms)
+{
+    airtime.rx_ms += time_ms;
+    airtime.rx_windows++;
+    airtime.total_rx_ms += time_ms;
+    energy_account(ENERGY_RADIO_RX, time_ms);
+}
 
 static int lora_configure(bool transmiting)
 {
@@ -33,15 +58,17 @@ static int lora_configure(bool transmiting)
     if (transmiting) { /* Transmitting */
         config.frequency = cfg.uplink_channel;
         config.tx = transmiting;
+        config.datarate = adr_get_datarate();
+        config.tx_power = adr_get_tx_power();
     } else { /* Receiving */
         config.frequency = cfg.downlink_channel;
         config.tx = transmiting;
+        config.datarate = cfg.datarate;
+        config.tx_power = ADR_MAX_TX_POWER;
     }
     config.bandwidth = cfg.bandwidth;
-    config.datarate = cfg.datarate;
-    config.preamble_len = 8;
+    config.preamble_len = PREAMBLE_LEN;
     config.coding_rate = CR_4_5;
-    config.tx_power = 20;
     config.iq_inverted = false;
     config.public_network = false;
     ret = lora_config(lora_dev, &config);
@@ -61,6 +88,7 @@ int radio_init(void)
         return E_NOT_DETECTED;
     }
     rssi = 0;
+    snr = 0;
 
     return 0;
 }
@@ -68,22 +96,27 @@ int radio_init(void)
 int radio_send_str(char *str, uint32_t len)
 {
     int ret;
+    uint32_t size = strlen(str); /* Sent without the terminator, len is not used */
 
     /* lora_send blocks 2times estimated air time. */
     printk("Send: %s\n", str);
-    watchdog_disable();
+    watchdog_expect(2 * radio_time_on_air_ms(size, adr_get_datarate(), cfg.bandwidth));
     ret = lora_configure(TRANSMITING);
     if (ret < 0) {
         LOG_ERR("LoRa init failed");
         return -E_INVALID;
     }
 
-    ret = lora_send(lora_dev, str, strlen(str));
+    struct profile_mark mark = profiler_start();
+
+    ret = lora_send(lora_dev, str, size);
+    profiler_stop(PROFILE_RADIO_TX, mark);
     if (ret < 0) {
         LOG_ERR("LoRa send failed");
         return -E_TIMEDOUT;
     }
-    watchdog_init();
+    radio_account_tx(size);
+    watchdog_reset();
     LOG_INF("LoRa data sent");
     ret = lora_configure(RECEIVING);
     if (ret < 0) {
@@ -113,14 +146,19 @@ int send_frame(char *str, uint32_t len)
         printk("lora configure failed\n");
         return -E_INVALID;
     }
-    watchdog_disable();
+    watchdog_expect(2 * radio_time_on_air_ms(strlen(payload), adr_get_datarate(), cfg.bandwidth));
+    struct profile_mark mark = profiler_start();
+
     ret = lora_send(lora_dev, payload, strlen(payload));
+    profiler_stop(PROFILE_RADIO_TX, mark);
     if (ret < 0) {
         LOG_ERR("LoRa send failed");
         printk("Lora failed send\n");
         /* return -E_TIMEDOUT; */
+    } else {
+        radio_account_tx(strlen(payload));
     }
-    watchdog_init();
+    watchdog_reset();
     LOG_INF("LoRa data sent");
     ret = lora_configure(RECEIVING);
     if (ret < 0) {
@@ -132,26 +170,25 @@ int send_frame(char *str, uint32_t len)
 
 int radio_receive_str(char *str, uint32_t len, uint16_t time, char *name)
 {
-    int8_t snr;
     int ret = 0;
     uint8_t data[255] = {0};
 
-    /* lora_send blocks 2times estimated air time. */
-
-    watchdog_disable();
     ret = lora_configure(RECEIVING);
     if (ret < 0) {
         LOG_ERR("Lora failed\n");
-        watchdog_init();
         return -E_INVALID;
     }
+    watchdog_expect(time);
+    int64_t rx_start = k_uptime_get();
+
     ret = lora_recv(lora_dev, data, len, K_MSEC(time), &rssi, &snr);
+    radio_account_rx(k_uptime_get() - rx_start);
     if (ret < 0) {
         LOG_ERR("LoRa received failed");
-        watchdog_init();
+        watchdog_reset();
         return -E_TIMEDOUT;
     }
-    watchdog_init();
+    watchdog_reset();
     LOG_INF("Received data: %s (RSSI:%ddBm, SNR:%ddBm)", data, rssi, snr);
     printk("Received %s\n", data);
     char buffer[strlen(data) + 1];
@@ -183,6 +220,94 @@ int end_device_get_link_quality(void)
     return signal;
 }
 
+/**
+ * RSSI and SNR of the last received frame.
+ */
+void radio_get_link_stats(int16_t *last_rssi, int8_t *last_snr)
+{
+    *last_rssi = rssi;
+    *last_snr = snr;
+}
+
+/**
+ * Time on air in ms of a frame with len bytes of payload. Explicit header,
+ * CRC on and coding rate 4/5, as configured in lora_configure().
+ */
+uint32_t radio_time_on_air_ms(uint32_t len, uint8_t datarate, uint8_t bandwidth)
+{
+    uint32_t bandwidth_khz;
+    uint32_t symbol_us;
+    int32_t payload_bits;
+    int32_t bits_per_block;
+    uint32_t payload_symbols = 8;
+    uint8_t low_datarate_optimize;
+
+    switch (bandwidth) {
+        case BW_125_KHZ:
+            bandwidth_khz = 125;
+            break;
+        case BW_250_KHZ:
+            bandwidth_khz = 250;
+            break;
+        default:
+            bandwidth_khz = 500;
+            break;
+    }
+    symbol_us = (1000U << datarate) / bandwidth_khz;
+    /* The driver enables it when the symbol is longer than 16 ms */
+    low_datarate_optimize = symbol_us > 16000;
+    payload_bits = 8 * len - 4 * datarate + 28 + 16;
+    bits_per_block = 4 * (datarate - 2 * low_datarate_optimize);
+    if (payload_bits > 0) {
+        payload_symbols += ((payload_bits + bits_per_block - 1) / bits_per_block) * (CR_4_5 + 4);
+    }
+    /* The preamble has 4.25 symbols more than programmed */
+    return ((4 * PREAMBLE_LEN + 17) * symbol_us / 4 + payload_symbols * symbol_us + 999) / 1000;
+}
+
+/**
+ * Time on air in ms of a typical measurement frame with the configured
+ * datarate and bandwidth. Used to size the receive windows.
+ */
+uint32_t radio_frame_time_on_air(void)
+{
+    return radio_time_on_air_ms(RADIO_REFERENCE_FRAME_LEN, cfg.datarate, cfg.bandwidth);
+}
+
+/**
+ * Start a new sampling cycle for the airtime counters. The counters of the
+ * finished cycle are kept to be reported.
+ */
+void radio_airtime_new_cycle(void)
+{
+    last_cycle_airtime = airtime;
+    airtime.tx_ms = 0;
+    airtime.rx_ms = 0;
+    airtime.tx_frames = 0;
+    airtime.rx_windows = 0;
+}
+
+/**
+ * Get the airtime counters of the current cycle and since boot.
+ */
+void radio_get_airtime(struct radio_airtime *current, struct radio_airtime *last_cycle)
+{
+    if (current) {
+        *current = airtime;
+    }
+    if (last_cycle) {
+        *last_cycle = last_cycle_airtime;
+    }
+}
+
+/**
+ * Charge used by the radio in uAh for the given airtime.
+ */
+uint32_t radio_airtime_charge_uah(const struct radio_airtime *a)
+{
+    return ((uint64_t)a->tx_ms * RADIO_TX_CURRENT_MA + (uint64_t)a->rx_ms * RADIO_RX_CURRENT_MA) / 3600;
+}
+
 int get_mac_address(struct mac_address *mac)
 {
     (void)memset(mac->dev_id, 0x0, sizeof(mac->dev_id));
@@ -0,0 +1,130 @@
+/*
+ * Periodic jobs of the node.
+ * Zephyr specific implementation
+ *
+ * Every job has a periodic k_timer. The kernel keeps the deadlines without drift
+ * and the expiry only marks the job as pending. The jobs run one after the
+ * other in the main thread because they share the radio, the sensor bus and
+ * the sensor power. Between jobs the main thread sleeps until the next
+ * deadline, with the system tickless.
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+#include "debug.h"
+#include "scheduler.h"
+
+struct scheduler_slot {
+    const struct scheduler_job *job;
+    struct k_timer timer;
+    int64_t deadline; /* Uptime of the next expected expiration */
+    struct scheduler_job_stats stats;
+};
+
+static struct scheduler_slot slots[JOB_END];
+static ATOMIC_DEFINE(pending_jobs, JOB_END);
+
+static void job_expired(struct k_timer *timer)
+{
+    struct scheduler_slot *slot = CONTAINER_OF(timer, struct scheduler_slot, timer);
+
+    atomic_set_bit(pending_jobs, slot - slots);
+}
+
+static void start_job_timer(struct scheduler_slot *slot, uint32_t first_run_ms)
+{
+    slot->stats.period_ms = slot->job->period_ms();
+    if (slot->stats.period_ms == 0) {
+        k_timer_stop(&slot->timer);
+        return;
+    }
+    slot->deadline = k_uptime_get() + first_run_ms;
+    k_timer_start(&slot->timer, K_MSEC(first_run_ms), K_MSEC(slot->stats.period_ms));
+}
+
+/**
+ * Add a periodic job. It runs for the first time after first_run_ms.
+ */
+void scheduler_add(enum scheduler_job_id id, const struct scheduler_job *job, uint32_t first_run_ms)
+{
+    struct scheduler_slot *slot = &slots[id];
+
+    slot->job = job;
+    memset(&slot->stats, 0, sizeof(slot->stats));
+    k_timer_init(&slot->timer, job_expired, NULL);
+    start_job_timer(slot, first_run_ms);
+}
+
+static void run_job(struct scheduler_slot *slot)
+{
+    uint32_t expirations = k_timer_status_get(&slot->timer);
+    int64_t start = k_uptime_get();
+    int64_t deadline;
+
+    if (expirations == 0) {
+        return;
+    }
+    /* The deadline of the latest expiration, the previous ones were missed */
+    deadline = slot->deadline + (expirations - 1) * slot->stats.period_ms;
+    slot->deadline = deadline + slot->stats.period_ms;
+    slot->stats.misses += expirations - 1;
+    if (start - deadline > slot->stats.max_lateness_ms) {
+        slot->stats.max_lateness_ms = start - deadline;
+    }
+    slot->job->run();
+    slot->stats.runs++;
+    slot->stats.last_run_ms = k_uptime_get() - start;
+    DEBUG("Job %s: %i ms\n", slot->job->name, slot->stats.last_run_ms);
+    /* The period may have been changed from the shell */
+    if (slot->job->period_ms() != slot->stats.period_ms) {
+        start_job_timer(slot, slot->job->period_ms());
+    }
+}
+
+/**
+ * Run all the jobs that are due, in order of their id.
+ */
+void scheduler_run_pending(void)
+{
+    for (int i = 0; i < JOB_END; i++) {
+        if (!slots[i].job) {
+            continue;
+        }
+        if (atomic_test_and_clear_bit(pending_jobs, i)) {
+            run_job(&slots[i]);
+        } else if (slots[i].stats.period_ms == 0 && slots[i].job->period_ms() != 0) {
+            /* A disabled job was enabled from the shell */
+            start_job_timer(&slots[i], slots[i].job->period_ms());
+        }
+    }
+}
+
+/**
+ * Time until the next job is due, ms. 0 if there are jobs pending.
+ */
+uint32_t scheduler_time_to_next_job(void)
+{
+    uint32_t next = UINT32_MAX;
+
+    for (int i = 0; i < JOB_END; i++) {
+        if (!slots[i].job || slots[i].stats.period_ms == 0) {
+            continue;
+        }
+        if (atomic_test_bit(pending_jobs, i)) {
+            return 0;
+        }
+        next = MIN(next, k_timer_remaining_get(&slots[i].timer));
+    }
+    return next;
+}
+
+/**
+ * Get the name and statistics of a job. The name is NULL if the job was not added.
+ */
+void scheduler_get_stats(enum scheduler_job_id id, const char **name, struct scheduler_job_stats *stats)
+{
+    *name = slots[id].job ? slots[id].job->name : NULL;
+    *stats = slots[id].stats;
+}
@@ -11,9 +11,11 @@
 #include <zephyr/devicetree.h>
 #include <zephyr/drivers/gpio.h>
 #include "solenoid.h"
+#include "valve_actuator.h"
 #include "watchdog.h"
 #include "hardware.h"
 #include "smart_sensor.h"
+#include "energy.h"
 
 /* The device-tree node identifier for the "sensorpower" alias. */
 #define SENSORPOWER_NODE DT_NODELABEL(sensorpower0)
@@ -47,13 +49,11 @@ int sensor_power_init(void)
 void sensor_power_on(int external_voltage)
 {
     if (external_voltage) {
-        solenoid_prepare();
-        solenoid_activate_forward(0);
-        watchdog_reset();
-        sleep_microseconds(100000);
-        solenoid_release();
+        valve_actuator_pulse_now(0, VALVE_PULSE_FORWARD, SENSOR_RELAY_PULSE_US);
+        energy_load_on(ENERGY_SENSORS_12V);
     }
     gpio_pin_set_dt(&power_pin, 1);
+    energy_load_on(ENERGY_SENSORS);
 }
 
 /**
@@ -62,11 +62,9 @@ void sensor_power_on(int external_voltage)
 void sensor_power_off(int external_voltage)
 {
     if (external_voltage) {
-        solenoid_prepare();
-        solenoid_activate_reverse(0);
-        watchdog_reset();
-        sleep_microseconds(100000);
-        solenoid_release();
+        valve_actuator_pulse_now(0, VALVE_PULSE_REVERSE, SENSOR_RELAY_PULSE_US);
+        energy_load_off(ENERGY_SENSORS_12V);
     }
     gpio_pin_set_dt(&power_pin, 0);
+    energy_load_off(ENERGY_SENSORS);
 }
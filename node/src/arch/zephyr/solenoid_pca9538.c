@@ -139,20 +139,19 @@ enum solenoid_status solenoid_prepare(void)
     int adc;
     enum solenoid_status ret;
 
-    adc_init();
     solenoid_power_on();
-    for (i = 0; i < 20; i++) {
+    for (i = 0; i < SOLENOID_CHARGE_MAX_POLLS; i++) {
         watchdog_reset();
-        sleep_microseconds(50000);
+        sleep_microseconds(SOLENOID_CHARGE_POLL_MS * 1000);
         adc = adc_read_solenoid_supply();
         LOG_DBG("Charging cap: %d", adc);
-        if (adc > 7500) {
+        if (adc > SOLENOID_CHARGED_MV) {
             /* Capacitor is charged */
             ret = SOLENOID_OK;
             break;
         }
     }
-    if (adc_read_solenoid_supply() < 7200) {
+    if (adc_read_solenoid_supply() < SOLENOID_POWER_LOW_MV) {
         ret = SOLENOID_POWER_LOW;
     }
     LOG_DBG("Solenoid ADC: %i  i: %i", adc, i);
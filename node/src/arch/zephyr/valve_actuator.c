@@ -0,0 +1,345 @@
+/*
+ * Pulses of the bi-stable valves, in the background.
+ * Zephyr specific implementation
+ *
+ * The valves share the capacitor of the solenoid supply, so only one pulse
+ * is given at a time: charge the capacitor, activate the coil for the length
+ * of the pulse, check the voltage left and release. Every step is a delayable
+ * work item, so the caller returns immediately and the charge and the pulse
+ * overlap the radio and the display. When several valves have pulses pending
+ * they are served in turns, one pulse each.
+ *
+ * The supply is sampled across the whole pulse in one ADC sequence. A coil
+ * that is not connected leaves the capacitor charged, a short discharges it
+ * in the first part of the pulse and a valve that moves discharges it
+ * gradually. A fault is known after a single pulse, so the remaining pulses of
+ * the request are dropped instead of draining the supply. The capture blocks
+ * for the whole pulse, so the steps run in a work queue of their own and the
+ * system work queue, with the radio, is never held. The queue checks in with
+ * the watchdog at every step and is supervised only while it has pulses to give.
+ */
+
+#include <zephyr/kernel.h>
+#include "adc.h"
+#include "bsp-config.h"
+#include "debug.h"
+#include "watchdog.h"
+#include "valve_actuator.h"
+
+#define MAX_SOLENOID_FINISH_VOLTAGE 7000 /* If the solenoid finishes higher than this, disconnected */
+#define MIN_SOLENOID_FINISH_VOLTAGE 4000 /* If the solenoid finishes lower than this, short-circuit */
+#define SHORT_CIRCUIT_FRACTION      4    /* A short discharges the supply in the first quarter of the pulse */
+#define ACTUATOR_STACK_SIZE         768
+#define ACTUATOR_PRIORITY           K_PRIO_COOP(3)
+
+enum actuator_state {
+    ACTUATOR_IDLE,
+    ACTUATOR_CHARGING,
+    ACTUATOR_PULSING,
+};
+
+/**
+ * Pulses requested for a valve
+ */
+struct valve_request {
+    uint8_t pending; /* Pulses left */
+    enum valve_pulse_direction direction;
+    uint32_t pulse_us;
+    uint8_t generation;          /* Changes with every request */
+    enum solenoid_status status; /* Of the last pulse */
+};
+
+static void actuator_work(struct k_work *item);
+
+K_THREAD_STACK_DEFINE(actuator_stack, ACTUATOR_STACK_SIZE);
+static struct k_work_q actuator_queue;
+static struct valve_request requests[MAX_N_VALVES];
+static struct k_spinlock lock;
+static K_WORK_DELAYABLE_DEFINE(work, actuator_work);
+static enum actuator_state state;
+static int valve = -1;                     /* Valve being pulsed, or the last one */
+static uint8_t polls;                      /* Voltage checks while charging */
+static enum solenoid_status supply_status; /* Of the charge for the pulse in progress */
+static uint8_t pulse_generation;           /* Request of the pulse in progress */
+static struct valve_pulse_capture capture; /* Of the pulse in progress */
+static struct valve_pulse_capture last_capture[MAX_N_VALVES];
+static int watchdog_task = -1;
+
+/*
+ * Run the next step after a delay, in the queue of the actuator.
+ */
+static void schedule(k_timeout_t delay)
+{
+    k_work_reschedule_for_queue(&actuator_queue, &work, delay);
+}
+
+/*
+ * Next valve with pulses pending after the last one served, -1 if none.
+ */
+static int next_valve(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    int next = -1;
+
+    for (int i = 1; i <= MAX_N_VALVES; i++) {
+        int v = (valve + i + MAX_N_VALVES) % MAX_N_VALVES;
+
+        if (requests[v].pending > 0) {
+            next = v;
+            break;
+        }
+    }
+    k_spin_unlock(&lock, key);
+    return next;
+}
+
+static enum solenoid_status finish_voltage_status(int solenoid_mv)
+{
+    if (solenoid_mv > MAX_SOLENOID_FINISH_VOLTAGE) {
+        return SOLENOID_DISCONNECTED;
+    } else if (solenoid_mv < MIN_SOLENOID_FINISH_VOLTAGE) {
+        return SOLENOID_SHORT_CIRCUIT;
+    }
+    return SOLENOID_OK;
+}
+
+/*
+ * Classify the pulse from the shape of the supply voltage.
+ */
+static enum solenoid_status capture_status(const struct valve_pulse_capture *c)
+{
+    int n = c->n_samples;
+
+    if (n == 0) {
+        return finish_voltage_status(adc_read_solenoid_supply());
+    }
+    /* Collapsed early, there is almost no resistance */
+    if (c->mv[n / SHORT_CIRCUIT_FRACTION] < MIN_SOLENOID_FINISH_VOLTAGE) {
+        return SOLENOID_SHORT_CIRCUIT;
+    }
+    return finish_voltage_status(c->mv[n - 1]);
+}
+
+static void start_pulse(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    enum valve_pulse_direction direction = requests[valve].direction;
+    uint32_t pulse_us = requests[valve].pulse_us;
+
+    uint32_t start;
+    uint32_t elapsed_us;
+    int n;
+
+    pulse_generation = requests[valve].generation;
+    k_spin_unlock(&lock, key);
+    watchdog_task_expect(watchdog_task, pulse_us / 1000);
+    DEBUG("Valve %i pulse %s\n", valve, direction == VALVE_PULSE_FORWARD ? "forward" : "reverse");
+    start = k_cycle_get_32();
+    if (direction == VALVE_PULSE_FORWARD) {
+        solenoid_activate_forward(valve);
+    } else {
+        solenoid_activate_reverse(valve);
+    }
+    /* The samples span the pulse, the last one just before the release */
+    capture.interval_us = pulse_us / SOLENOID_CAPTURE_MAX_SAMPLES;
+    n = adc_capture_solenoid_supply(capture.mv, SOLENOID_CAPTURE_MAX_SAMPLES, capture.interval_us);
+    capture.n_samples = n > 0 ? n : 0;
+    elapsed_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+    state = ACTUATOR_PULSING;
+    schedule(elapsed_us < pulse_us ? K_USEC(pulse_us - elapsed_us) : K_NO_WAIT);
+}
+
+static void end_pulse(void)
+{
+    enum solenoid_status status = supply_status;
+    k_spinlock_key_t key;
+
+    /* Judge the pulse only if the supply was already ok */
+    if (status == SOLENOID_OK) {
+        status = capture_status(&capture);
+    }
+    solenoid_release();
+    capture.status = status;
+    key = k_spin_lock(&lock);
+    requests[valve].status = status;
+    last_capture[valve] = capture;
+    /* If the request was replaced during the pulse, all the new pulses are still due */
+    if (requests[valve].generation == pulse_generation && requests[valve].pending > 0) {
+        requests[valve].pending--;
+        /* More pulses would not help a coil that is open or shorted */
+        if (status == SOLENOID_DISCONNECTED || status == SOLENOID_SHORT_CIRCUIT) {
+            requests[valve].pending = 0;
+        }
+    }
+    k_spin_unlock(&lock, key);
+    state = ACTUATOR_IDLE;
+    schedule(K_NO_WAIT);
+}
+
+static void actuator_work(struct k_work *item)
+{
+    int mv;
+
+    watchdog_task_checkin(watchdog_task);
+    switch (state) {
+    case ACTUATOR_IDLE:
+        valve = next_valve();
+        if (valve < 0) {
+            watchdog_task_idle(watchdog_task);
+            return;
+        }
+        solenoid_power_on();
+        polls = 0;
+        state = ACTUATOR_CHARGING;
+        schedule(K_MSEC(SOLENOID_CHARGE_POLL_MS));
+        break;
+    case ACTUATOR_CHARGING:
+        mv = adc_read_solenoid_supply();
+        if (mv <= SOLENOID_CHARGED_MV && ++polls < SOLENOID_CHARGE_MAX_POLLS) {
+            schedule(K_MSEC(SOLENOID_CHARGE_POLL_MS));
+            break;
+        }
+        supply_status = mv < SOLENOID_POWER_LOW_MV ? SOLENOID_POWER_LOW : SOLENOID_OK;
+        capture.mv_charged = mv;
+        start_pulse();
+        break;
+    case ACTUATOR_PULSING:
+        end_pulse();
+        break;
+    }
+}
+
+/**
+ * Start the work queue of the pulses. Call it only once, before any pulse.
+ */
+void valve_actuator_init(void)
+{
+    const struct k_work_queue_config queue_cfg = {
+        .name = "valves",
+    };
+
+    watchdog_task = watchdog_task_register("valves", WATCHDOG_VALVES_TIMEOUT);
+    watchdog_task_idle(watchdog_task);
+
+    k_work_queue_start(
+        &actuator_queue, actuator_stack, K_THREAD_STACK_SIZEOF(actuator_stack), ACTUATOR_PRIORITY, &queue_cfg);
+}
+
+/**
+ * Give some pulses to a valve, without waiting. The pulses still pending of a
+ * previous request for the same valve are replaced.
+ * @param valve_nr The valve
+ * @param direction The direction of the current in the coil
+ * @param n_pulses How many pulses, to be sure the valve moved
+ * @param pulse_us The length of every pulse
+ */
+void valve_actuator_pulse(int valve_nr, enum valve_pulse_direction direction, uint8_t n_pulses, uint32_t pulse_us)
+{
+    k_spinlock_key_t key;
+    int idle;
+
+    if (valve_nr < 0 || valve_nr >= MAX_N_VALVES) {
+        return;
+    }
+    key = k_spin_lock(&lock);
+    requests[valve_nr].pending = n_pulses;
+    requests[valve_nr].direction = direction;
+    requests[valve_nr].pulse_us = pulse_us;
+    requests[valve_nr].generation++;
+    idle = state == ACTUATOR_IDLE;
+    k_spin_unlock(&lock, key);
+    /* A running sequence takes the request after its pulse */
+    if (idle) {
+        watchdog_task_checkin(watchdog_task); /* Supervised until the queue is idle again */
+        k_work_schedule_for_queue(&actuator_queue, &work, K_NO_WAIT);
+    }
+}
+
+/**
+ * Give a single pulse now and wait for it, for the coils that are not valves,
+ * like the relay of the external sensor supply. The pulses in the queue are
+ * finished first, so the release does not cut one of them.
+ * @param solenoid_nr The coil
+ * @param direction The direction of the current in the coil
+ * @param pulse_us The length of the pulse
+ */
+enum solenoid_status valve_actuator_pulse_now(int solenoid_nr, enum valve_pulse_direction direction, uint32_t pulse_us)
+{
+    enum solenoid_status status;
+
+    if (valve_actuator_wait(VALVE_ACTUATOR_DRAIN_MS) < 0) {
+        return SOLENOID_POWER_LOW;
+    }
+    status = solenoid_prepare();
+    if (direction == VALVE_PULSE_FORWARD) {
+        solenoid_activate_forward(solenoid_nr);
+    } else {
+        solenoid_activate_reverse(solenoid_nr);
+    }
+    watchdog_reset();
+    k_usleep(pulse_us);
+    solenoid_release();
+    return status;
+}
+
+/**
+ * Status of the last pulse given to a valve.
+ */
+enum solenoid_status valve_actuator_status(int valve_nr)
+{
+    if (valve_nr < 0 || valve_nr >= MAX_N_VALVES) {
+        return SOLENOID_INVALID_VALUE;
+    }
+    return requests[valve_nr].status;
+}
+
+/**
+ * Copy the supply voltage captured during the last pulse of a valve.
+ * @return 0 if the valve was pulsed, -1 otherwise
+ */
+int valve_actuator_capture(int valve_nr, struct valve_pulse_capture *c)
+{
+    k_spinlock_key_t key;
+
+    if (valve_nr < 0 || valve_nr >= MAX_N_VALVES) {
+        return -1;
+    }
+    key = k_spin_lock(&lock);
+    *c = last_capture[valve_nr];
+    k_spin_unlock(&lock, key);
+    return c->mv_charged > 0 ? 0 : -1;
+}
+
+/**
+ * Check if there are pulses pending or in progress.
+ */
+int valve_actuator_busy(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    int busy = state != ACTUATOR_IDLE;
+
+    for (int i = 0; i < MAX_N_VALVES; i++) {
+        busy |= requests[i].pending > 0;
+    }
+    k_spin_unlock(&lock, key);
+    return busy;
+}
+
+/**
+ * Wait until all the pulses are given, for the operations that need the
+ * valves in a known state.
+ * @return 0 if done, -1 on timeout
+ */
+int valve_actuator_wait(uint32_t timeout_ms)
+{
+    int64_t end = k_uptime_get() + timeout_ms;
+
+    while (valve_actuator_busy()) {
+        if (k_uptime_get() > end) {
+            return -1;
+        }
+        watchdog_reset();
+        k_msleep(10);
+    }
+    return 0;
+}
@@ -1,3 +1,17 @@
+/*
+ * Watchdog supervisor.
+ *
+ * The hardware watchdog is set up once and only the supervisor thread feeds it.
+ * Every task registers a timeout and checks in periodically. Before a long
+ * blocking operation the task declares how long it expects to take. If a task
+ * misses its deadline, the supervisor stops feeding the hardware watchdog and
+ * the device is reset.
+ * A task that waits for work, like a work queue, is not supervised while it
+ * is idle.
+ * The main thread is registered in watchdog_init(), watchdog_reset() and
+ * watchdog_expect() act on it.
+ */
+#include <zephyr/kernel.h>
 #include <zephyr/drivers/watchdog.h>
 #include <zephyr/sys/printk.h>
 #include "watchdog.h"
@@ -6,12 +20,59 @@
 #define WDT_LABEL      DT_LABEL(WDT_NODE)
 #define WDT_MAX_WINDOW 16000U
 
+#define SUPERVISOR_PERIOD     (WDT_MAX_WINDOW / 4) /* Feed period, ms */
+#define SUPERVISOR_STACK_SIZE 512
+#define SUPERVISOR_PRIORITY   K_PRIO_COOP(2)
+
+struct watchdog_task {
+    const char *name;
+    uint32_t timeout_ms;
+    int64_t deadline; /* Uptime before which the task has to check in */
+};
+
 const struct device *wdt_dev;
 static struct wdt_timeout_cfg cfg_wdt;
+static int wdt_channel;
+
+static struct watchdog_task tasks[WATCHDOG_MAX_TASKS];
+static int n_tasks;
+static int main_task;
+static struct k_spinlock lock;
+
+K_THREAD_STACK_DEFINE(supervisor_stack, SUPERVISOR_STACK_SIZE);
+static struct k_thread supervisor_thread;
+
+static void supervisor(void *p1, void *p2, void *p3)
+{
+    bool expired = false;
+
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+    while (1) {
+        int64_t now = k_uptime_get();
+        k_spinlock_key_t key = k_spin_lock(&lock);
+
+        for (int i = 0; i < n_tasks && !expired; i++) {
+            if (now > tasks[i].deadline) {
+                printk("Watchdog: task %s missed its deadline\n", tasks[i].name);
+                expired = true; /* Never feed again, wait for the reset */
+            }
+        }
+        k_spin_unlock(&lock, key);
+        if (!expired) {
+            wdt_feed(wdt_dev, wdt_channel);
+        }
+        k_msleep(SUPERVISOR_PERIOD);
+    }
+}
 
+/**
+ * Set up the hardware watchdog and start the supervisor. Call it only once.
+ */
 int watchdog_init(void)
 {
-    uint8_t err;
+    int err;
 
     wdt_dev = DEVICE_DT_GET(WDT_NODE);
 
@@ -28,20 +89,100 @@ int watchdog_init(void)
         printk("Watchdog install error\n");
         return -1;
     }
+    wdt_channel = err;
     err = wdt_setup(wdt_dev, 0);
     if (err < 0) {
         printk("Watchdog setup error\n");
     }
+    main_task = watchdog_task_register("main", WATCHDOG_MAIN_TIMEOUT);
+    k_thread_create(&supervisor_thread,
+                    supervisor_stack,
+                    K_THREAD_STACK_SIZEOF(supervisor_stack),
+                    supervisor,
+                    NULL,
+                    NULL,
+                    NULL,
+                    SUPERVISOR_PRIORITY,
+                    0,
+                    K_NO_WAIT);
     return 1;
 }
 
+/**
+ * Register a task to be supervised. Returns the task identifier.
+ */
+int watchdog_task_register(const char *name, uint32_t timeout_ms)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    int task = n_tasks;
+
+    if (n_tasks >= WATCHDOG_MAX_TASKS) {
+        k_spin_unlock(&lock, key);
+        printk("Watchdog: too many tasks\n");
+        return -1;
+    }
+    tasks[task].name = name;
+    tasks[task].timeout_ms = timeout_ms;
+    tasks[task].deadline = k_uptime_get() + timeout_ms;
+    n_tasks++;
+    k_spin_unlock(&lock, key);
+    return task;
+}
+
+/**
+ * The task is alive, restart its timeout.
+ */
+void watchdog_task_checkin(int task)
+{
+    if (task < 0 || task >= n_tasks) {
+        return;
+    }
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    tasks[task].deadline = k_uptime_get() + tasks[task].timeout_ms;
+    k_spin_unlock(&lock, key);
+}
+
+/**
+ * The task is starting an operation that will block for duration_ms.
+ */
+void watchdog_task_expect(int task, uint32_t duration_ms)
+{
+    if (task < 0 || task >= n_tasks) {
+        return;
+    }
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    tasks[task].deadline = k_uptime_get() + duration_ms + tasks[task].timeout_ms;
+    k_spin_unlock(&lock, key);
+}
+
+/**
+ * The task is waiting for work, it is not supervised until its next check in.
+ */
+void watchdog_task_idle(int task)
+{
+    if (task < 0 || task >= n_tasks) {
+        return;
+    }
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    tasks[task].deadline = INT64_MAX;
+    k_spin_unlock(&lock, key);
+}
+
+/**
+ * Check in the main thread.
+ */
 void watchdog_reset(void)
 {
-    /* printk("Watchdog reset\n"); */
-    wdt_feed(wdt_dev, 0);
+    watchdog_task_checkin(main_task);
 }
 
-void watchdog_disable(void)
+/**
+ * The main thread is starting an operation that will block for duration_ms.
+ */
+void watchdog_expect(uint32_t duration_ms)
 {
-    wdt_disable(wdt_dev);
+    watchdog_task_expect(main_task, duration_ms);
 }
@@ -8,7 +8,9 @@
 #include "measurement_storage.h"
 #include "watchdog.h"
 #include "radio.h"
+#include "adr.h"
 #include "debug.h"
+#include "profiler.h"
 #include "actual_conditions.h"
 #include "satellite_compression.h"
 #include "shell_commands.h"
@@ -25,6 +27,7 @@ void send_data_from_storage(int time_of_last_measurement)
     uint32_t missed_conection = 0;
     char data[255];
     char *buffer;
+    struct profile_mark mark = profiler_start();
 
     unsended_data = unsended_data_get();
     printk("%i datos para enviar\n", unsended_data);
@@ -66,6 +69,7 @@ void send_data_from_storage(int time_of_last_measurement)
         usnprintf(payload, 10, "%s %s", cfg.name, "END");
         radio_send_str(payload, strlen(payload));
     }
+    profiler_stop(PROFILE_STORAGE_DRAIN, mark);
     DEBUG("Fin envio de datos\n");
 }
 
@@ -176,31 +180,92 @@ void send_adcp_measurements(int time_of_last_measurement, enum sensor_manufactur
     send_data_from_storage(actual_state.n_of_sensors_detected);
 }
 
+/*
+ * True if the acknowledgment in data has the downlink pending token.
+ * The format is "<name> OK [P] <timestamp>".
+ */
+static bool ack_has_downlink_pending(char *data)
+{
+    char buffer[strlen(data) + 1];
+    char *s = buffer;
+    char *token;
+
+    strcpy(buffer, data);
+    strtok_r(s, " ", &s); /* Name */
+    strtok_r(s, " ", &s); /* OK */
+    while ((token = strtok_r(s, " ", &s)) != NULL) {
+        if (!strcmp(token, ACK_DOWNLINK_PENDING)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Keep an acknowledgment or a command received after an uplink.
+ * @return 1 if it was a command
+ */
+static int received_frame(char *data, struct received_command *command)
+{
+    char ack[14];
+
+    usnprintf(ack, sizeof(ack), "%s %s", cfg.name, "OK");
+    if (!strncmp(ack, data, strlen(ack))) {
+        if (ack_has_downlink_pending(data)) {
+            actual_state.downlink_pending = 1;
+        }
+    } else if (strlen(data) > 2) { /* if len data > 2 it is a command. */
+        strncpy(command->command, data, SIZE_COMMAND - 1);
+        command->command[SIZE_COMMAND - 1] = '\0';
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Open the receive windows after an uplink. Must be called right after the
+ * transmission. When a window gets a frame, the node keeps listening back to
+ * back for the rest of the queue of the coordinator, up to RX_MAX_COMMANDS
+ * commands, so coordinators that do not send the pending token are still
+ * drained. Returns RECEIVING if a command was received or the coordinator
+ * has more commands queued, then the caller should keep listening with
+ * receiving_commands().
+ */
 int if_received_data(char *data)
 {
+    static const uint16_t window_delay[] = {RX_WINDOW_1_DELAY, RX_WINDOW_2_DELAY};
     int ret = SLEEPING;
-    uint8_t queue = 0;
-    uint32_t init_time;
-    struct received_command command[3];
+    int64_t uplink_end = k_uptime_get();
+    struct received_command command[RX_MAX_COMMANDS];
+    int queue = 0;
+    struct profile_mark mark = profiler_start();
 
     memset(data, '\0', strlen(data));
-    init_time = k_uptime_get();
-    while ((k_uptime_get() - init_time) < 2000) {
+    for (int i = 0; i < ARRAY_SIZE(window_delay); i++) {
+        int32_t wait = window_delay[i] - (k_uptime_get() - uplink_end);
+
+        if (wait > 0) {
+            k_msleep(wait);
+        }
         watchdog_reset();
-        if (radio_receive_str(data, 255, (2 * cfg.time_on_air), cfg.name) > 0) {
-            if (strlen(data) > 2) { /* if len data > 2 it is a command. */
-                init_time = k_uptime_get();
-                strncpy(command[queue].command, data, SIZE_COMMAND);
-                queue++;
-                ret = RECEIVING;
+        if (radio_receive_str(data, 255, (2 * radio_frame_time_on_air()), cfg.name) > 0) {
+            do {
+                queue += received_frame(data, &command[queue]);
                 memset(data, '\0', strlen(data));
-            }
-        }
-        if (queue > 3) {
-            queue = 2;
+                watchdog_reset();
+            } while (queue < RX_MAX_COMMANDS &&
+                     radio_receive_str(data, 255, (2 * radio_frame_time_on_air()), cfg.name) > 0);
             break;
         }
     }
+    profiler_stop(PROFILE_RADIO_RX, mark);
+    if (queue > 0) {
+        ret = RECEIVING;
+    }
+    if (actual_state.downlink_pending) {
+        actual_state.downlink_pending = 0;
+        ret = RECEIVING;
+    }
     for (int i = 0; i < queue; i++) {
         data_reception(command[i].command);
     }
@@ -218,7 +283,7 @@ int receiving_commands(char *data)
 
     while ((actual_time - init_time) <= RECEPTION_TIME) {
         watchdog_reset();
-        if (radio_receive_str(data, 255, (4 * cfg.time_on_air), cfg.name) > 0) {
+        if (radio_receive_str(data, 255, (4 * radio_frame_time_on_air()), cfg.name) > 0) {
             data_reception(data);
             init_time = k_uptime_get();
             memset(data, '\0', strlen(data));
@@ -264,17 +329,30 @@ int check_acknowledgment(char *data, char *frame_name, int time_of_last_measurem
 {
     char name[10];
     int ret = 0;
+    int16_t rssi;
+    int8_t snr;
+    struct profile_mark mark = profiler_start();
+    int received = radio_receive_str(data, 255, 2 * radio_frame_time_on_air(), frame_name);
 
-    if (radio_receive_str(data, 255, 2 * cfg.time_on_air, frame_name) > 0) {
+    profiler_stop(PROFILE_RADIO_ACK, mark);
+    if (received > 0) {
         usnprintf(name, 10, "%s %s", frame_name, "OK");
         if (!strncmp(name, data, 4)) {
             watchdog_reset();
             actual_state.coordinator_found = 1;
             time_of_last_measurement = get_timestamp(data);
             set_current_time(&time_of_last_measurement);
+            if (ack_has_downlink_pending(data)) {
+                actual_state.downlink_pending = 1;
+            }
+            radio_get_link_stats(&rssi, &snr);
+            adr_ack_received(rssi, snr);
             ret = 1;
         }
     }
+    if (!ret) {
+        adr_ack_missed();
+    }
     return ret;
 }
 
@@ -308,8 +386,8 @@ void send_ping(void)
  */
 bool check_for_adcp(void)
 {
-    return ((sen_drv.sensor_driver[NORTEK] != NULL || sen_drv.sensor_driver[AQUADOPP] != NULL ||
-             sen_drv.sensor_driver[FLOWQUEST] != NULL) &&
+    return ((driver_for_manufacturer(NORTEK) != NULL || driver_for_manufacturer(AQUADOPP) != NULL ||
+             driver_for_manufacturer(FLOWQUEST) != NULL) &&
             actual_state.n_of_sensors_detected == 1 && actual_measurements[0].type == CURRENT_PROFILER_SENSOR &&
             actual_measurements[0].current_profiler_signature.current_profiler_signature_status == MEASUREMENT_OK);
 }
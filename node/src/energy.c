@@ -0,0 +1,155 @@
+/**
+ *  \file energy.c
+ *  \brief Charge used by the node, estimated from the time in every power state
+ *
+ *  The loads are switched on and off by the code that controls them (sensor
+ *  power) or accounted with their duration (radio time on air). The CPU idle
+ *  time is the time of the kernel idle thread, so every sleep of the cycle
+ *  (console wait, preheat, valve and GPS waits) counts as idle. At the start of
+ *  every sampling cycle the residency of the last cycle is closed. The charge
+ *  is the sum of the residency of every load times its current, from the table
+ *  in cfg.load_current_ua.
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+#include <string.h>
+#include <zephyr/kernel.h>
+#include "configuration.h"
+#include "energy.h"
+
+static int64_t load_on_since[ENERGY_LOAD_END];
+static uint8_t load_is_on[ENERGY_LOAD_END];
+static int64_t cycle_start;
+static uint64_t cycle_start_idle;
+static struct energy_residency cycle;
+static struct energy_residency last_cycle;
+static struct energy_residency total;
+
+static const char *const load_names[] = {
+    [ENERGY_CPU_ACTIVE] = "cpu",
+    [ENERGY_CPU_IDLE] = "idle",
+    [ENERGY_SENSORS] = "sensors",
+    [ENERGY_SENSORS_12V] = "12v",
+    [ENERGY_RADIO_TX] = "tx",
+    [ENERGY_RADIO_RX] = "rx",
+};
+
+/**
+ * Switch on a load. Does nothing if it is already on.
+ */
+void energy_load_on(enum energy_load load)
+{
+    if (!load_is_on[load]) {
+        load_on_since[load] = k_uptime_get();
+        load_is_on[load] = 1;
+    }
+}
+
+/**
+ * Switch off a load and account the time it was on. Does nothing if it is
+ * already off.
+ */
+void energy_load_off(enum energy_load load)
+{
+    if (load_is_on[load]) {
+        energy_account(load, k_uptime_get() - load_on_since[load]);
+        load_is_on[load] = 0;
+    }
+}
+
+/**
+ * Account time_ms with a load on.
+ */
+void energy_account(enum energy_load load, uint32_t time_ms)
+{
+    cycle.load_ms[load] += time_ms;
+    total.load_ms[load] += time_ms;
+}
+
+/**
+ * Cycles the CPU spent in the kernel idle thread since the boot.
+ */
+static uint64_t idle_cycles(void)
+{
+    k_thread_runtime_stats_t stats;
+
+    if (k_thread_runtime_stats_all_get(&stats) != 0) {
+        return 0;
+    }
+    return stats.idle_cycles;
+}
+
+/**
+ * Close the residency of the cycle. The loads that are on stay on, their time
+ * so far is accounted in the cycle that ends.
+ */
+void energy_new_cycle(void)
+{
+    int64_t now = k_uptime_get();
+    uint64_t elapsed = now - cycle_start;
+    uint64_t now_idle = idle_cycles();
+    uint64_t idle = k_cyc_to_ms_floor64(now_idle - cycle_start_idle);
+
+    for (int i = 0; i < ENERGY_LOAD_END; i++) {
+        if (load_is_on[i]) {
+            energy_account(i, now - load_on_since[i]);
+            load_on_since[i] = now;
+        }
+    }
+    if (idle > elapsed) {
+        idle = elapsed;
+    }
+    cycle.elapsed_ms = elapsed;
+    cycle.load_ms[ENERGY_CPU_IDLE] = idle;
+    cycle.load_ms[ENERGY_CPU_ACTIVE] = elapsed - idle;
+    total.elapsed_ms += elapsed;
+    total.load_ms[ENERGY_CPU_IDLE] += idle;
+    total.load_ms[ENERGY_CPU_ACTIVE] += elapsed - idle;
+    last_cycle = cycle;
+    memset(&cycle, 0, sizeof(cycle));
+    cycle_start = now;
+    cycle_start_idle = now_idle;
+}
+
+/**
+ * Residency of the last complete cycle and since the boot.
+ */
+void energy_get_residency(struct energy_residency *last, struct energy_residency *since_boot)
+{
+    *last = last_cycle;
+    *since_boot = total;
+}
+
+static uint64_t charge_ua_ms(const struct energy_residency *r)
+{
+    uint64_t ua_ms = 0;
+
+    for (int i = 0; i < ENERGY_LOAD_END; i++) {
+        ua_ms += r->load_ms[i] * cfg.load_current_ua[i];
+    }
+    return ua_ms;
+}
+
+/**
+ * Charge used in a period, uAh.
+ */
+uint32_t energy_charge_uah(const struct energy_residency *r)
+{
+    return charge_ua_ms(r) / (3600 * MSEC_PER_SEC);
+}
+
+/**
+ * Charge per day at the average current of a period, mAh.
+ */
+uint32_t energy_mah_per_day(const struct energy_residency *r)
+{
+    if (r->elapsed_ms == 0) {
+        return 0;
+    }
+    return charge_ua_ms(r) * 24 / r->elapsed_ms / 1000;
+}
+
+const char *energy_load_name(enum energy_load load)
+{
+    return load_names[load];
+}
@@ -37,11 +37,21 @@
 #include "sampling.h"
 #include "oxygen_control.h"
 #include "solenoid.h"
+#include "valve_actuator.h"
 #include "adc.h"
 #include "local_sensors.h"
 #include "watchdog.h"
 #include "measurement_storage.h"
 #include "comunication.h"
+#include "adr.h"
+#include "node_statistics.h"
+#include "measurement_aggregation.h"
+#include "measurement_operations.h"
+#include "oxygen_solubility.h"
+#include "uplink_filter.h"
+#include "console_wake.h"
+#include "scheduler.h"
+#include "profiler.h"
 #if CONFIG_EXTERNAL_DATALOGGER
 #include "external_datalogger.h"
 #include "compressed_measurement.h"
@@ -49,8 +59,9 @@
 
 /* Local prototypes */
 static void serialize_and_send_measurements(char *data, size_t size);
+static void send_summary_measurements(char *data, size_t size);
 static void processes_init(void);
-static void should_wake(int tics);
+static void should_wake(void);
 static void serialiaze_and_send_node(void);
 /* static const struct device *get_si7006_device(void); */
 
@@ -75,6 +86,7 @@ struct oxycontroller_state actual_state = {
     .coordinator_found = 0,
     .missed_conection = 0,
     .using_external_memory = 0,
+    .downlink_pending = 0,
 
 };
 
@@ -84,89 +96,240 @@ struct measurement valve_measurements[MAX_N_VALVES];
 static uint32_t time_of_last_measurement; /* zero-initialized by C */
 const struct device *si7007_dev;
 
-int main(void)
+/*
+ * Sample all the sensors, send the measurements and show them.
+ */
+static void sampling_job_run(void)
 {
     uint8_t radio_state = SLEEPING;
+    struct profile_mark cycle = profiler_start();
+    struct profile_mark mark = cycle;
 
-    processes_init();
-    display_set_auto_flush(0);
+    /* Wait for local command */
+    should_wake();
+    profiler_stop(PROFILE_WAKE, mark);
+    node_statistics_new_cycle();
+    DEBUG("Sampling...\n");
+    sensor_power_on(smart_sensors_detect_voltage());
+    watchdog_reset();
+    sleep_microseconds(500000);
+    led_on(0);
+    sampling(cfg.sensor_communication_tries, actual_state.n_of_sensors_detected, actual_measurements);
+    time_of_last_measurement = get_current_time();
+    if (!smart_sensors_detect_voltage()) {
+        check_oxygen_levels_all_valves(cfg.use_saturation, actual_measurements);
+    }
+    acquire_local_sensors(&node_measurement, valve_measurements);
+    smart_sensors_power_off();
+    /* Start radio communication */
+    char data[255];
+
+    node_statistics_append(time_of_last_measurement);
+    if (check_for_adcp()) {
+        struct smart_sensor *s = smart_sensor_get(0);
+
+        send_adcp_measurements(time_of_last_measurement, s->manufacturer);
+        serialiaze_and_send_node();
+    } else if (cfg.uplink_mode == UPLINK_SUMMARY) {
+        send_ping();
+        send_summary_measurements(data, sizeof(data));
+    } else {
+        /* With UPLINK_EXCEPTION only the changes are sent */
+        send_ping();
+        serialize_and_send_measurements(data, sizeof(data));
+    }
+
+    radio_state = if_received_data(data);
+    if (radio_state == RECEIVING) {
+        radio_state = receiving_commands(data);
+    }
+    mark = profiler_start();
+    /* Recover the controller every cycle, this also makes the next flush complete */
+    init_and_clear_lcd();
+    display_end_device_status(node_measurement.node.battery_voltage);
+    display_all_measurements(actual_state.n_of_sensors_detected, actual_measurements, cfg.use_saturation);
+    display_flush_changed();
+    profiler_stop(PROFILE_DISPLAY, mark);
+    smart_sensors_power_off();
     led_off(0);
-    uint32_t elapsed = 0;
+    rs485_sleep(UART_SMART_SENSOR);
+    profiler_stop(PROFILE_CYCLE, cycle);
+}
 
-    while (1) {
-        if (should_start_sampling(cfg.sampling_interval)) {
-            /* Wait for local command */
-            should_wake(2000000);
-            display_driver_periodic_refresh();
-            DEBUG("Sampling...\n");
-            sensor_power_on(smart_sensors_detect_voltage());
-            watchdog_reset();
-            sleep_microseconds(500000);
-            led_on(0);
-            sampling(3, actual_state.n_of_sensors_detected, actual_measurements);
-            time_of_last_measurement = get_current_time();
-            if (!smart_sensors_detect_voltage()) {
-                check_oxygen_levels_all_valves(cfg.use_saturation, actual_measurements);
-            }
-            acquire_local_sensors(&node_measurement, valve_measurements);
-            sensor_power_off(smart_sensors_detect_voltage());
-            /* Start radio communication */
-            char data[255];
+static uint32_t sampling_job_period(void)
+{
+    return cfg.sampling_interval * MSEC_PER_SEC;
+}
 
-            if (check_for_adcp()) {
-                struct smart_sensor *s = smart_sensor_get(0);
+/*
+ * Ping the coordinator between samples, to receive its commands.
+ */
+static void ping_job_run(void)
+{
+    if (cfg.sampling_interval > cfg.ping_interval) {
+        send_ping();
+    }
+}
 
-                send_adcp_measurements(time_of_last_measurement, s->manufacturer);
-                serialiaze_and_send_node();
-            } else {
-                send_ping();
-                serialize_and_send_measurements(data, sizeof(data));
-            }
+static uint32_t ping_job_period(void)
+{
+    return cfg.ping_interval * MSEC_PER_SEC;
+}
 
-            radio_state = if_received_data(data);
-            if (radio_state == RECEIVING) {
-                radio_state = receiving_commands(data);
-            }
-            init_and_clear_lcd();
-            display_end_device_status(node_measurement.node.battery_voltage);
-            display_all_measurements(actual_state.n_of_sensors_detected, actual_measurements, cfg.use_saturation);
-            display_flush();
-            sensor_power_off(smart_sensors_detect_voltage());
-            led_off(0);
-            rs485_sleep(UART_SMART_SENSOR);
 #if CONFIG_EXTERNAL_DATALOGGER
-            int total_measurements = actual_state.n_of_sensors_detected;
-            struct compressed_measurement_list *list = k_malloc(256);
-            int compressed_size;
-
-            compressed_size = compress_measurement_list(actual_measurements, total_measurements, 256, list);
-            list->timestamp = time_of_last_measurement;
-            DEBUG("Storing %i bytes from actual_measurements\n", compressed_size);
-            watchdog_reset();
-            datalogger_append((uint8_t *)list, 256);
-            k_free(list);
-            /* DEBUG("Free space: %i\n", datalogger_get_free_space()); */
+/*
+ * Store the last measurements in the external datalogger.
+ */
+static void datalogger_job_run(void)
+{
+    int total_measurements = actual_state.n_of_sensors_detected;
+    struct compressed_measurement_list *list;
+    int compressed_size;
+    struct profile_mark mark;
+
+    if (time_of_last_measurement == 0) {
+        return; /* Nothing sampled yet */
+    }
+    mark = profiler_start();
+    list = k_malloc(256);
+    compressed_size = compress_measurement_list(actual_measurements, total_measurements, 256, list);
+    list->timestamp = time_of_last_measurement;
+    DEBUG("Storing %i bytes from actual_measurements\n", compressed_size);
+    watchdog_reset();
+    datalogger_append((uint8_t *)list, 256);
+    k_free(list);
+    profiler_stop(PROFILE_DATALOGGER, mark);
+}
+
+static uint32_t datalogger_job_period(void)
+{
+    return cfg.log_interval * MSEC_PER_SEC;
+}
 #endif
-            elapsed = k_uptime_get();
-            DEBUG("--- elapsed: %i\n", elapsed); /* in msec */
-            DEBUG("Sleeping for %iseg\n", cfg.sampling_interval);
-        } else {
-            int32_t sleep_time = k_uptime_get() - elapsed;
-            uint32_t interval = 1000 * ((cfg.sampling_interval * 1000) - sleep_time);
 
-            if (sleep_time > (cfg.sampling_interval * 1000)) {
-                interval = 0;
-            }
-            if (interval < 0 || interval > (cfg.ping_interval * 1000000)) {
-                interval = cfg.ping_interval * 1000000;
-            }
-            display_flush();
-            watchdog_disable();
-            sleep_microseconds(interval);
-            watchdog_init();
-            if (cfg.sampling_interval > cfg.ping_interval) {
-                send_ping();
-            }
+/*
+ * Retry the frames left in the storage by a failed transmission.
+ */
+static void storage_job_run(void)
+{
+    if (unsended_data_get() > 0 && is_channel_free()) {
+        send_data_from_storage(time_of_last_measurement);
+    }
+}
+
+static uint32_t storage_job_period(void)
+{
+    return STORAGE_RETRY_INTERVAL * MSEC_PER_SEC;
+}
+
+/*
+ * Fast oxygen control. While a valve is open or the oxygen is close to its
+ * open level, only the sensors associated with the valves are read, every
+ * cfg.control_interval, and the valves are checked with the new values. The
+ * other sensors are not prepared nor read.
+ */
+static void control_job_run(void)
+{
+    int n_sensors = actual_state.n_of_sensors_detected;
+    uint32_t associated = 0;
+    int power_up_ms = 0;
+
+    for (int v = 0; v < MAX_N_VALVES; v++) {
+        int s = cfg.valve[v].associated_sensor;
+
+        if (cfg.valve[v].is_active && s >= 0 && s < n_sensors) {
+            associated |= BIT(s);
+        }
+    }
+    if (associated == 0) {
+        return;
+    }
+    DEBUG("Fast control\n");
+    sensor_power_on(smart_sensors_detect_voltage());
+    for (int s = 0; s < n_sensors; s++) {
+        if (associated & BIT(s)) {
+            smart_sensor_prepare(s);
+            power_up_ms = MAX(power_up_ms, smart_sensor_get(s)->power_up_time);
+        }
+    }
+    watchdog_expect(power_up_ms);
+    sleep_microseconds(power_up_ms * 1000);
+    watchdog_reset();
+    for (int s = 0; s < n_sensors; s++) {
+        if (associated & BIT(s)) {
+            smart_sensor_acquire(s, cfg.sensor_communication_tries, &actual_measurements[s]);
+            measurements_derive_sensor(s, actual_measurements);
+        }
+    }
+    smart_sensors_power_off();
+    rs485_sleep(UART_SMART_SENSOR);
+    check_oxygen_levels_all_valves(cfg.use_saturation, actual_measurements);
+    for (int v = 0; v < MAX_N_VALVES; v++) {
+        valve_measurements[v].valve.valve_open = valve_in_open_state(v);
+    }
+}
+
+/*
+ * The fast loop runs only when it is needed, and never with sensors that use
+ * the external voltage, like the control after every sample.
+ */
+static uint32_t control_job_period(void)
+{
+    if (cfg.control_interval == 0 || cfg.control_interval >= cfg.sampling_interval || smart_sensors_detect_voltage() ||
+        !oxygen_control_fast_loop_needed(cfg.use_saturation, actual_measurements, actual_state.n_of_sensors_detected)) {
+        return 0;
+    }
+    return cfg.control_interval * MSEC_PER_SEC;
+}
+
+static void display_job_run(void)
+{
+    display_driver_periodic_refresh();
+    /* Send the complete frame again after refreshing the controller */
+    display_invalidate();
+}
+
+static uint32_t display_job_period(void)
+{
+    return DISPLAY_REFRESH_INTERVAL * MSEC_PER_SEC;
+}
+
+static const struct scheduler_job sampling_job = {"sampling", sampling_job_run, sampling_job_period};
+static const struct scheduler_job ping_job = {"ping", ping_job_run, ping_job_period};
+#if CONFIG_EXTERNAL_DATALOGGER
+static const struct scheduler_job datalogger_job = {"datalogger", datalogger_job_run, datalogger_job_period};
+#endif
+static const struct scheduler_job storage_job = {"storage", storage_job_run, storage_job_period};
+static const struct scheduler_job display_job = {"display", display_job_run, display_job_period};
+static const struct scheduler_job control_job = {"control", control_job_run, control_job_period};
+
+int main(void)
+{
+    processes_init();
+    display_set_auto_flush(0);
+    led_off(0);
+
+    scheduler_add(JOB_SAMPLING, &sampling_job, 0); /* Sample at the beginning */
+    scheduler_add(JOB_PING, &ping_job, ping_job_period());
+#if CONFIG_EXTERNAL_DATALOGGER
+    scheduler_add(JOB_DATALOGGER, &datalogger_job, datalogger_job_period());
+#endif
+    scheduler_add(JOB_STORAGE, &storage_job, storage_job_period());
+    scheduler_add(JOB_DISPLAY, &display_job, display_job_period());
+    scheduler_add(JOB_CONTROL, &control_job, control_job_period());
+
+    while (1) {
+        scheduler_run_pending();
+        /* Sleep until the next job or a character in the console */
+        display_flush_changed();
+        uint32_t idle_time = scheduler_time_to_next_job();
+
+        watchdog_expect(idle_time);
+        int woken = console_wake_wait(idle_time);
+
+        watchdog_reset();
+        if (woken) {
+            should_wake();
         }
     }
     return 0;
@@ -179,6 +342,7 @@ static void processes_init(void)
     serial_init(UART_SMART_SENSOR, 9600, 0, 0, 0);
     serial_init(COMM_UART, 11520, 0, 0, 0);
     microio_init(COMM_UART, COMM_UART);
+    console_wake_init();
     radio_init();
     adc_init();
     watchdog_init();
@@ -186,6 +350,7 @@ static void processes_init(void)
     int status = solenoid_init();
 
     DEBUG("Solenoid init %i\n", status);
+    valve_actuator_init();
     if (status == SOLENOID_OK) {
         actual_state.has_solenoid_control = 1;
     }
@@ -198,13 +363,13 @@ static void processes_init(void)
         set_default_configuration();
         valves_set_default_configuration();
     }
+    adr_reset();
     shell_init(command_list, cfg.name);
     init_and_clear_lcd();
     display_welcome_message();
-    watchdog_disable();
     sleep_microseconds(1000000);
     display_clear();
-    display_flush();
+    display_flush_changed();
     display_set_auto_flush(1);
 
     if (sen_drv.n_changes < 0) {
@@ -221,6 +386,13 @@ static void serialize_and_send_measurements(char *data, size_t size)
     int n_active_valves = 0;
     struct smart_sensor s;
     int sensor_number = 0;
+    int slot;
+    int delivered = 1;
+    int filter = cfg.uplink_mode == UPLINK_EXCEPTION;
+
+    if (filter) {
+        uplink_filter_begin();
+    }
     /* send valves measurements here if they are active */
     actual_measurements[actual_state.n_of_sensors_detected] = node_measurement;
     for (int i = 0; i < MAX_N_VALVES; i++) {
@@ -237,13 +409,25 @@ static void serialize_and_send_measurements(char *data, size_t size)
             s = *smart_sensor_get(i);
             sensor_number = s.number;
         }
+        if (i < actual_state.n_of_sensors_detected) {
+            slot = i;
+        } else if (i == actual_state.n_of_sensors_detected) {
+            slot = UPLINK_FILTER_NODE_SLOT;
+        } else {
+            slot = UPLINK_FILTER_VALVE_SLOT + sensor_number - 1;
+        }
+        if (filter && !uplink_filter_report(slot, &actual_measurements[i])) {
+            continue;
+        }
         int pos = usnprintf(data, size, ":%u:%s:%i:", time_of_last_measurement, cfg.name, sensor_number);
 
         serialize_measurement(&(actual_measurements[i]), 255, &(data[pos]));
         if (i == actual_state.n_of_sensors_detected) {
             if (is_channel_free()) {
                 send_frame(data, size);
-                check_acknowledgment(data, cfg.name, time_of_last_measurement);
+                delivered = check_acknowledgment(data, cfg.name, time_of_last_measurement);
+            } else {
+                delivered = 0;
             }
         } else {
             measurement_storage_append(data, n_size);
@@ -252,25 +436,29 @@ static void serialize_and_send_measurements(char *data, size_t size)
     if (is_channel_free()) {
         send_data_from_storage(time_of_last_measurement);
     }
+    /* The deadbands are relative to the values the coordinator has, the storage retries its frames */
+    if (filter && delivered) {
+        uplink_filter_commit();
+    }
 }
 
-static void should_wake(int tics)
+/*
+ * Keep the console open for cfg.wake_interval seconds, or while the device is
+ * in the WAKE state. The CPU sleeps until a character arrives.
+ */
+static void should_wake(void)
 {
-    const struct device *dev = DEVICE_DT_GET(DT_CHOSEN(zephyr_console));
-    uint8_t c;
+    int64_t window_end = k_uptime_get() + cfg.wake_interval * MSEC_PER_SEC;
+    int64_t remaining;
 
     printk("Wake?\n");
-    for (int j = 0; j < tics; ++j) {
+    while ((remaining = window_end - k_uptime_get()) > 0) {
         watchdog_reset();
-        while (uart_poll_in(dev, &c) >= 0) {
-            shell_char_received(c);
-        }
+        console_wake_wait(MIN(remaining, MSEC_PER_SEC));
     }
     while (cfg.command_state == WAKE) {
         watchdog_reset();
-        while (uart_poll_in(dev, &c) >= 0) {
-            shell_char_received(c);
-        }
+        console_wake_wait(MSEC_PER_SEC);
     }
     printk("Timeout\n");
 }
@@ -320,17 +508,56 @@ int detect_sensors(void)
         display_printf("No solenoid control.\n");
     }
     if (cfg.command_state == SLEEP) {
-        should_wake(2000000);
+        should_wake();
     }
-    watchdog_init();
+    watchdog_reset();
     restore_meas_unit_flag();
     sensor_power_on(smart_sensors_detect_voltage());
     actual_state.n_of_sensors_detected = smart_sensors_detect_all();
-    sensor_power_off(smart_sensors_detect_voltage());
+    smart_sensors_power_off();
 
     return 0;
 }
 
+/*
+ * Summary mode. Every sample is added to the statistics of the interval and
+ * only sent if a sensor is in alarm. When the log interval is over, the means
+ * are sent in the measurement frames, with the rest of the statistics in STAT
+ * AGG frames.
+ */
+static void send_summary_measurements(char *data, size_t size)
+{
+    static float saved[AGGREGATION_SLOTS][AGGREGATION_MAX_FIELDS];
+    static enum measurement_status saved_status[AGGREGATION_SLOTS][AGGREGATION_MAX_FIELDS];
+    int n_sensors = actual_state.n_of_sensors_detected;
+    int alarm = 0;
+
+    for (int i = 0; i < n_sensors; i++) {
+        aggregation_add(i, &actual_measurements[i]);
+        alarm |= measurement_in_alarm(&actual_measurements[i]);
+    }
+    aggregation_add(AGGREGATION_NODE_SLOT, &node_measurement);
+    if (aggregation_interval_elapsed()) {
+        DEBUG("Sending the summary of the interval\n");
+        node_statistics_append_aggregation(time_of_last_measurement);
+        for (int i = 0; i < n_sensors; i++) {
+            aggregation_apply_means(i, &actual_measurements[i], saved[i], saved_status[i]);
+        }
+        aggregation_apply_means(
+            AGGREGATION_NODE_SLOT, &node_measurement, saved[AGGREGATION_NODE_SLOT], saved_status[AGGREGATION_NODE_SLOT]);
+        serialize_and_send_measurements(data, size);
+        /* The display and the datalogger use the last samples */
+        for (int i = 0; i < n_sensors; i++) {
+            aggregation_restore(&actual_measurements[i], saved[i], saved_status[i]);
+        }
+        aggregation_restore(&node_measurement, saved[AGGREGATION_NODE_SLOT], saved_status[AGGREGATION_NODE_SLOT]);
+        aggregation_reset();
+    } else if (alarm) {
+        DEBUG("Alarm, sending the samples\n");
+        serialize_and_send_measurements(data, size);
+    }
+}
+
 static void serialiaze_and_send_node(void)
 {
     char buffer[256];
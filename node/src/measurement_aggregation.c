@@ -0,0 +1,337 @@
+/**
+ *  \file measurement_aggregation.c
+ *  \brief Statistics of the measurements over the log interval
+ *
+ *  Every sample updates the count, minimum, maximum, mean and the sum of the
+ *  squared differences of every variable of the sensors and the node with
+ *  Welford's method, so no sample is kept. The statistics are restarted with
+ *  aggregation_reset() when they are sent.
+ *
+ *  Directions and totalizers are not aggregated, their mean has no meaning.
+ *  The valves are not aggregated either, their variables are listed only for
+ *  the deadbands of the uplink filter.
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+#include <string.h>
+#include <math.h>
+#include "timeutils.h"
+#include "configuration.h"
+#include "measurement_aggregation.h"
+
+static struct field_summary summary[AGGREGATION_SLOTS][AGGREGATION_MAX_FIELDS];
+static uint8_t n_fields[AGGREGATION_SLOTS];
+static int64_t interval_start;
+static uint8_t interval_started;
+
+/*
+ * Read or write the variables of a measurement. The class of the deadband of
+ * every variable is returned in deadband_class if it is not NULL.
+ * @return The number of variables of the measurement
+ */
+static int access_fields(
+    struct measurement *m, float *value, enum measurement_status *status, uint8_t *deadband_class, int write)
+{
+    int n = 0;
+
+#define FIELD(member, field, class)                                                                                    \
+    do {                                                                                                               \
+        if (write) {                                                                                                   \
+            m->member.field = value[n];                                                                                \
+            m->member.field##_status = status[n];                                                                      \
+        } else {                                                                                                       \
+            value[n] = m->member.field;                                                                                \
+            status[n] = m->member.field##_status;                                                                      \
+        }                                                                                                              \
+        if (deadband_class != NULL) {                                                                                  \
+            deadband_class[n] = (class);                                                                               \
+        }                                                                                                              \
+        n++;                                                                                                           \
+    } while (0)
+
+/* The variables of the node and the valves have no status */
+#define PLAIN_FIELD(member, field, class)                                                                              \
+    do {                                                                                                               \
+        if (write) {                                                                                                   \
+            m->member.field = value[n];                                                                                \
+        } else {                                                                                                       \
+            value[n] = m->member.field;                                                                                \
+            status[n] = MEASUREMENT_OK;                                                                                \
+        }                                                                                                              \
+        if (deadband_class != NULL) {                                                                                  \
+            deadband_class[n] = (class);                                                                               \
+        }                                                                                                              \
+        n++;                                                                                                           \
+    } while (0)
+
+    switch (m->type) {
+    case OXYGEN_SENSOR:
+        FIELD(oxygen, concentration, DEADBAND_OXYGEN);
+        FIELD(oxygen, temperature, DEADBAND_TEMPERATURE);
+        FIELD(oxygen, saturation, DEADBAND_SATURATION);
+        FIELD(oxygen, salinity, DEADBAND_SALINITY);
+        break;
+    case PH_SENSOR:
+        FIELD(pH, pH, DEADBAND_PH);
+        FIELD(pH, temperature, DEADBAND_TEMPERATURE);
+        break;
+    case CONDUCTIVITY_SENSOR:
+        FIELD(conductivity, conductivity, DEADBAND_CONDUCTIVITY);
+        FIELD(conductivity, salinity, DEADBAND_SALINITY);
+        FIELD(conductivity, temperature, DEADBAND_TEMPERATURE);
+        break;
+    case PRESSURE_SENSOR:
+        FIELD(pressure, pressure, DEADBAND_PRESSURE);
+        FIELD(pressure, temperature, DEADBAND_TEMPERATURE);
+        break;
+    case TEMPERATURE_SENSOR:
+        FIELD(temperature, temperature, DEADBAND_TEMPERATURE);
+        FIELD(temperature, depth, DEADBAND_LEVEL);
+        break;
+    case TURBIDITY_SENSOR:
+        FIELD(turbidity, turbidity, DEADBAND_OTHER);
+        FIELD(turbidity, temperature, DEADBAND_TEMPERATURE);
+        break;
+    case CHLOROPHYLL_SENSOR:
+        FIELD(chlorophyll, chlorophyll, DEADBAND_OTHER);
+        FIELD(chlorophyll, temperature, DEADBAND_TEMPERATURE);
+        break;
+    case CTDO_SENSOR:
+        FIELD(ctdo, conductivity, DEADBAND_CONDUCTIVITY);
+        FIELD(ctdo, temperature, DEADBAND_TEMPERATURE);
+        FIELD(ctdo, saturation, DEADBAND_SATURATION);
+        break;
+    case CHELSEA_SENSOR:
+        FIELD(chelsea, chlorophyll, DEADBAND_OTHER);
+        FIELD(chelsea, phycocyanin, DEADBAND_OTHER);
+        FIELD(chelsea, turbidity, DEADBAND_OTHER);
+        break;
+    case SUSPENDED_SOLIDS_SENSOR:
+        FIELD(suspended_solids, suspended_solids, DEADBAND_OTHER);
+        FIELD(suspended_solids, temperature, DEADBAND_TEMPERATURE);
+        break;
+    case WATER_POTENCIAL_SENSOR:
+        FIELD(water_potencial, water_potencial, DEADBAND_OTHER);
+        FIELD(water_potencial, temperature, DEADBAND_TEMPERATURE);
+        break;
+    case PHREATIC_LEVEL_SENSOR:
+        FIELD(phreatic_level, phreatic_level, DEADBAND_LEVEL);
+        FIELD(phreatic_level, pressure, DEADBAND_PRESSURE);
+        FIELD(phreatic_level, temperature, DEADBAND_TEMPERATURE);
+        break;
+    case LINE_PRESSURE_SENSOR:
+        FIELD(line_pressure, line_pressure, DEADBAND_PRESSURE);
+        FIELD(line_pressure, temperature, DEADBAND_TEMPERATURE);
+        break;
+    case WAVE_SENSOR:
+        FIELD(wave, height, DEADBAND_LEVEL);
+        FIELD(wave, temperature, DEADBAND_TEMPERATURE);
+        break;
+    case RADIATION_SENSOR:
+        FIELD(radiation, radiation, DEADBAND_OTHER);
+        break;
+    case RADIATION_UV_SENSOR:
+        FIELD(radiation_uv, energy_flow, DEADBAND_OTHER);
+        break;
+    case DISTANCE_SENSOR:
+        FIELD(distance, mean_distance, DEADBAND_LEVEL);
+        break;
+    case RAIN_SENSOR:
+        FIELD(rain, rain, DEADBAND_OTHER);
+        break;
+    case WATERING_RATE_SENSOR:
+        FIELD(watering_rate, watering_rate, DEADBAND_FLOW);
+        break;
+    case FLOW_SENSOR:
+        FIELD(flow, speed, DEADBAND_FLOW);
+        break;
+    case FLOW_WATER_SENSOR:
+        FIELD(flow_water, flow_water, DEADBAND_FLOW);
+        FIELD(flow_water, frequency, DEADBAND_OTHER);
+        FIELD(flow_water, distance, DEADBAND_LEVEL);
+        break;
+    case FLOW_ULTRASONIC_SENSOR:
+        FIELD(flow_ultrasonic, rate, DEADBAND_FLOW);
+        FIELD(flow_ultrasonic, speed, DEADBAND_FLOW);
+        FIELD(flow_ultrasonic, depth, DEADBAND_LEVEL);
+        break;
+    case WEATHER_STATION_SENSOR:
+        FIELD(weather_station, air_temperature, DEADBAND_TEMPERATURE);
+        FIELD(weather_station, relative_humidity, DEADBAND_OTHER);
+        FIELD(weather_station, average_wind, DEADBAND_OTHER);
+        FIELD(weather_station, wind_gusts, DEADBAND_OTHER);
+        break;
+    case WIND_SENSOR:
+        FIELD(wind, average_wind, DEADBAND_OTHER);
+        FIELD(wind, wind_gusts, DEADBAND_OTHER);
+        break;
+    case VOLUME_SENSOR:
+        FIELD(volume, volume, DEADBAND_OTHER);
+        FIELD(volume, porcentage, DEADBAND_OTHER);
+        FIELD(volume, distance, DEADBAND_LEVEL);
+        break;
+    case NODE_INTERNAL_SENSOR:
+        PLAIN_FIELD(node, battery_voltage, DEADBAND_VOLTAGE);
+        PLAIN_FIELD(node, sensor_voltage, DEADBAND_VOLTAGE);
+        PLAIN_FIELD(node, temperature, DEADBAND_TEMPERATURE);
+        PLAIN_FIELD(node, humidity, DEADBAND_OTHER);
+        break;
+    case VALVE_SENSOR:
+        PLAIN_FIELD(valve, valve_open, DEADBAND_STATE);
+        PLAIN_FIELD(valve, injection_mode, DEADBAND_STATE);
+        PLAIN_FIELD(valve, injection_open_level, DEADBAND_OXYGEN);
+        PLAIN_FIELD(valve, injection_close_level, DEADBAND_OXYGEN);
+        break;
+    default:
+        break;
+    }
+#undef FIELD
+#undef PLAIN_FIELD
+    return n;
+}
+
+/**
+ * Get the variables of a measurement, with the class of their deadband.
+ * @param value, status, deadband_class Arrays of AGGREGATION_MAX_FIELDS
+ * @return The number of variables, 0 if the type of measurement is not known
+ */
+int measurement_get_fields(const struct measurement *m,
+                           float *value,
+                           enum measurement_status *status,
+                           uint8_t *deadband_class)
+{
+    /* Only read, the cast is safe */
+    return access_fields((struct measurement *)m, value, status, deadband_class, 0);
+}
+
+/**
+ * Start a new interval, forgetting the statistics of all the variables.
+ */
+void aggregation_reset(void)
+{
+    memset(summary, 0, sizeof(summary));
+    memset(n_fields, 0, sizeof(n_fields));
+    interval_start = get_uptime_ms();
+    interval_started = 1;
+}
+
+/**
+ * Add a sample to the statistics of a slot. Only the variables with a valid
+ * status are counted.
+ */
+void aggregation_add(int slot, const struct measurement *m)
+{
+    float value[AGGREGATION_MAX_FIELDS];
+    enum measurement_status status[AGGREGATION_MAX_FIELDS];
+    int n;
+
+    if (slot < 0 || slot >= AGGREGATION_SLOTS) {
+        return;
+    }
+    if (!interval_started) {
+        aggregation_reset();
+    }
+    if (m->type != NODE_INTERNAL_SENSOR && m->sensor_status != SENSOR_OK) {
+        return;
+    }
+    /* Only read, the cast is safe */
+    n = access_fields((struct measurement *)m, value, status, NULL, 0);
+    n_fields[slot] = n;
+    for (int i = 0; i < n; i++) {
+        struct field_summary *f = &summary[slot][i];
+        float delta;
+
+        if (status[i] != MEASUREMENT_OK || isnan(value[i])) {
+            continue;
+        }
+        if (f->count == 0 || value[i] < f->min) {
+            f->min = value[i];
+        }
+        if (f->count == 0 || value[i] > f->max) {
+            f->max = value[i];
+        }
+        f->count++;
+        delta = value[i] - f->mean;
+        f->mean += delta / f->count;
+        f->m2 += delta * (value[i] - f->mean);
+    }
+}
+
+/**
+ * Get the statistics of the variables of a slot.
+ * @param fields An array of AGGREGATION_MAX_FIELDS to receive the statistics
+ * @return The number of variables
+ */
+int aggregation_get(int slot, struct field_summary *fields)
+{
+    if (slot < 0 || slot >= AGGREGATION_SLOTS) {
+        return 0;
+    }
+    memcpy(fields, summary[slot], sizeof(summary[slot]));
+    return n_fields[slot];
+}
+
+/**
+ * Check if the log interval has elapsed since the statistics were restarted.
+ */
+int aggregation_interval_elapsed(void)
+{
+    return interval_started && ms_elapsed(&interval_start) >= (int64_t)cfg.log_interval * 1000;
+}
+
+/**
+ * Sample standard deviation of a variable.
+ */
+float field_summary_stddev(const struct field_summary *f)
+{
+    if (f->count < 2) {
+        return 0.0f;
+    }
+    return sqrtf(f->m2 / (f->count - 1));
+}
+
+int aggregation_apply_means(int slot, struct measurement *m, float *saved, enum measurement_status *saved_status)
+{
+    float value[AGGREGATION_MAX_FIELDS];
+    enum measurement_status status[AGGREGATION_MAX_FIELDS];
+    int n = access_fields(m, saved, saved_status, NULL, 0);
+
+    for (int i = 0; i < n; i++) {
+        if (slot >= 0 && slot < AGGREGATION_SLOTS && i < n_fields[slot] && summary[slot][i].count > 0) {
+            value[i] = summary[slot][i].mean;
+            status[i] = MEASUREMENT_OK;
+        } else {
+            value[i] = saved[i];
+            status[i] = saved_status[i];
+        }
+    }
+    access_fields(m, value, status, NULL, 1);
+    return n;
+}
+
+void aggregation_restore(struct measurement *m, const float *saved, const enum measurement_status *saved_status)
+{
+    /* The arrays are only read, the casts are safe */
+    access_fields(m, (float *)saved, (enum measurement_status *)saved_status, NULL, 1);
+}
+
+int measurement_in_alarm(const struct measurement *m)
+{
+    float level;
+
+    if (m->type != OXYGEN_SENSOR || m->sensor_status != SENSOR_OK) {
+        return 0;
+    }
+    if (cfg.use_saturation) {
+        if (m->oxygen.saturation_status != MEASUREMENT_OK) {
+            return 0;
+        }
+        level = m->oxygen.saturation;
+    } else {
+        if (m->oxygen.concentration_status != MEASUREMENT_OK) {
+            return 0;
+        }
+        level = m->oxygen.concentration;
+    }
+    return level < cfg.low_oxygen_alarm || level > cfg.high_oxygen_alarm;
+}
@@ -9,11 +9,13 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "debug.h"
 #include "measurement.h"
 #include "temperature.h"
 #include "oxygen_saturation.h"
+#include "oxygen_solubility.h"
 #include "measurement_operations.h"
 #include "smart_sensor.h"
 #include "configuration.h"
@@ -38,45 +40,6 @@ int almost_same_depth(float depth1, float depth2)
     }
 }
 
-/*
- * Join the salinity measurement from a conductivity sensor at about the same depth
- * of an oxygen sensor.
- * @param n_of_measurements The number of measurements in the array to check
- * @param measurement An array with all the measurements to check.
- * @return 1 if two sensors can be joined, 0 otherwise.
- */
-int measurements_join_oxygen_with_salinity(int n_of_measurements, struct measurement *measurement)
-{
-    int sensors_at_same_depth = 0;
-    /* Check if there are oxygen sensors */
-    for (int i = 0; i < n_of_measurements; i++) {
-        if (measurement[i].type == OXYGEN_SENSOR) {
-            struct oxygen_measurement *oxygen = &(measurement[i].oxygen);
-
-            DEBUG("Oxygen sensor (S%i), with depth: %.1f\n", i + 1, (double)oxygen->depth);
-            for (int j = 0; j < n_of_measurements; j++) {
-                if (measurement[j].type == CONDUCTIVITY_SENSOR) {
-                    struct conductivity_measurement *conductivity = &(measurement[j].conductivity);
-
-                    if (almost_same_depth(conductivity->depth, oxygen->depth)) {
-                        /* Found two sensor at similar depth. Set the salinity of the oxygen measurement */
-                        /* to the value measured by the conductivity sensor */
-                        DEBUG("Salinity sensor (S%i), with depth: %.1f salinity %.2f\n",
-                              j + 1,
-                              (double)conductivity->depth,
-                              (double)conductivity->salinity);
-                        oxygen->salinity = conductivity->salinity;
-                        oxygen->salinity_status = MEASUREMENT_OK;
-                        sensors_at_same_depth = 1;
-                        break;
-                    }
-                }
-            }
-        }
-    }
-    return sensors_at_same_depth;
-}
-
 /**
  * Calculate the oxygen concentration for a measurement using the saturation
  * obtained from the optical measurement, the salinity and the temperature
@@ -93,128 +56,233 @@ void measurement_calculate_oxygen_concentration(struct measurement *measurement)
               (double)oxygen->saturation,
               (double)oxygen->salinity,
               (double)oxygen->temperature);
-        oxygen->concentration = oxygen_concentration(oxygen->saturation, oxygen->salinity, kelvin(oxygen->temperature));
+        oxygen->concentration = oxygen_concentration_fast(oxygen->saturation, oxygen->salinity, oxygen->temperature);
         DEBUG("New concentration %.2f\n", (double)oxygen->concentration);
     }
 }
 
+static struct join_plan plan;
+
 /**
- * Calculate the oxygen concentration for a list of measurement using the saturation
- * obtained from the optical measurement, the salinity and the temperature
- * The concentration can be calculated only if we have valid oxygen and temperature measurements.
- * @param n_of_measurements The number of measurements in the array to process
- * @param measurement An array with all the measurements to process.
+ * Forget the join plan, it is built again with the next measurements.
+ * Called when the sensors are detected.
  */
-void measurements_list_calculate_oxygen_concentration(int n_of_measurements, struct measurement *measurement)
+void join_plan_invalidate(void)
 {
-    /* Check if there are oxygen sensors */
-    for (int i = 0; i < n_of_measurements; i++) {
-        const struct smart_sensor *sensor = smart_sensor_get(i);
+    plan.valid = 0;
+}
 
-        if (sensor->manufacturer == INNOVEX) {
-            if (measurement[i].type == OXYGEN_SENSOR) {
-                measurement_calculate_oxygen_concentration(&(measurement[i]));
-            }
-        }
-    }
+/**
+ * Get the join plan in use.
+ */
+const struct join_plan *join_plan_get(void)
+{
+    return &plan;
 }
 
 /*
- * Join two level measurements.
- * @param n_of_measurements The number of measurements in the array to check
- * @param measurement An array with all the measurements to check.
- * @return 1 if two sensors can be joined.
+ * Find the partners of every derived measurement. The types and the order of
+ * the sensors only change with a detection, but the depths are reported by the
+ * sensors, so the plan is kept only if every oxygen and conductivity sensor
+ * answered.
  */
-int measurements_join_two_levels(int n_of_measurements, struct measurement *measurement)
+static void join_plan_build(int n_of_measurements, struct measurement *measurement)
 {
-    int two_levels = 0;
-    /* Check if there are oxygen sensors */
+    int depths_known = 1;
+
+    memset(&plan, 0, sizeof(plan));
+    plan.current_ac[0] = plan.current_ac[1] = plan.current_ac[2] = -1;
     for (int i = 0; i < n_of_measurements; i++) {
-        if (measurement[i].type == LEVEL_SENSOR) {
-            struct level_measurement *level_1 = &(measurement[i].level);
+        const struct smart_sensor *sensor = smart_sensor_get(i);
 
-            DEBUG("Level 1 sensor (S%i): %.1f\n", i + 1, (double)level_1->level_1);
+        switch (measurement[i].type) {
+        case OXYGEN_SENSOR:
+            if (measurement[i].sensor_status != SENSOR_OK) {
+                depths_known = 0;
+            }
+            /* The first conductivity sensor at about the same depth gives the salinity */
+            for (int j = 0; j < n_of_measurements; j++) {
+                if (measurement[j].type == CONDUCTIVITY_SENSOR &&
+                    almost_same_depth(measurement[j].conductivity.depth, measurement[i].oxygen.depth)) {
+                    plan.salinity[plan.n_salinity].oxygen = i;
+                    plan.salinity[plan.n_salinity].conductivity = j;
+                    plan.n_salinity++;
+                    break;
+                }
+            }
+            if (sensor != NULL && sensor->manufacturer == INNOVEX) {
+                plan.concentration[plan.n_concentration++] = i;
+            }
+            break;
+        case CONDUCTIVITY_SENSOR:
+            if (measurement[i].sensor_status != SENSOR_OK) {
+                depths_known = 0;
+            }
+            break;
+        case LEVEL_SENSOR:
+            /* The next level sensor gives the second level */
             for (int j = i + 1; j < n_of_measurements; j++) {
                 if (measurement[j].type == LEVEL_SENSOR) {
-                    struct level_measurement *level_2 = &(measurement[j].level);
-
-                    DEBUG("Level 2 sensor (S%i): %.1f\n", j + 1, (double)level_2->level_1);
-                    level_1->level_2 = level_2->level_1;
-                    level_1->level_2_status = MEASUREMENT_OK;
-                    two_levels = 1;
+                    plan.level[plan.n_levels].first = i;
+                    plan.level[plan.n_levels].second = j;
+                    plan.n_levels++;
+                    break;
+                }
+            }
+            break;
+        case CURRENT_AC_SENSOR:
+            /* The first three sensors are the phases, the first one carries all */
+            for (int phase = 0; phase < 3; phase++) {
+                if (plan.current_ac[phase] < 0) {
+                    plan.current_ac[phase] = i;
                     break;
                 }
             }
+            break;
+        case FLOW_WATER_SENSOR:
+            plan.flow[plan.n_flow++] = i;
+            break;
+        default:
+            break;
         }
     }
-    return two_levels;
+    plan.n_of_measurements = n_of_measurements;
+    plan.valid = depths_known;
 }
 
-int measurements_join_current_ac(int n_of_measurements, struct measurement *measurement)
+/*
+ * Copy the salinity of the conductivity sensors to the oxygen sensors at the same depth.
+ */
+static void join_oxygen_with_salinity(struct measurement *measurement)
 {
-    int phases = 0;
+    for (int k = 0; k < plan.n_salinity; k++) {
+        struct oxygen_measurement *oxygen = &(measurement[plan.salinity[k].oxygen].oxygen);
+        struct conductivity_measurement *conductivity = &(measurement[plan.salinity[k].conductivity].conductivity);
 
-    for (int i = 0; i < n_of_measurements; i++) {
-        struct current_ac_measurement *current = &(measurement[i].current_ac);
+        DEBUG("Salinity of S%i from S%i: %.2f\n",
+              plan.salinity[k].oxygen + 1,
+              plan.salinity[k].conductivity + 1,
+              (double)conductivity->salinity);
+        oxygen->salinity = conductivity->salinity;
+        oxygen->salinity_status = MEASUREMENT_OK;
+    }
+}
 
-        for (int j = i + 1; j < n_of_measurements; j++) {
-            if ((measurement[j].type == CURRENT_AC_SENSOR) && (phases == 0)) {
-                struct current_ac_measurement *current_2 = &(measurement[j].current_ac);
+static void join_two_levels(struct measurement *measurement)
+{
+    for (int k = 0; k < plan.n_levels; k++) {
+        struct level_measurement *level_1 = &(measurement[plan.level[k].first].level);
+        struct level_measurement *level_2 = &(measurement[plan.level[k].second].level);
 
-                DEBUG("Current 2 (S: %i): %.1f\n", i + 1, (double)current_2->phase_1);
-                current->phase_2 = current_2->phase_1;
-                current->phase_2_status = MEASUREMENT_OK;
-                phases++;
-            }
-            if ((measurement[j].type == CURRENT_AC_SENSOR) && (phases > 0)) {
-                struct current_ac_measurement *current_3 = &(measurement[j].current_ac);
+        DEBUG("Level 2 of S%i from S%i: %.1f\n",
+              plan.level[k].first + 1,
+              plan.level[k].second + 1,
+              (double)level_2->level_1);
+        level_1->level_2 = level_2->level_1;
+        level_1->level_2_status = MEASUREMENT_OK;
+    }
+}
 
-                DEBUG("Current 3 (S: %i): %.1f\n", i + 1, (double)current_3->phase_1);
-                current->phase_3 = current_3->phase_1;
-                current->phase_3_status = MEASUREMENT_OK;
-                phases++;
-            }
-        }
-        if (phases >= 2) {
-            return 0;
-        }
+static void join_current_ac(struct measurement *measurement)
+{
+    struct current_ac_measurement *current;
+
+    if (plan.current_ac[0] < 0) {
+        return;
+    }
+    current = &(measurement[plan.current_ac[0]].current_ac);
+    if (plan.current_ac[1] >= 0) {
+        current->phase_2 = measurement[plan.current_ac[1]].current_ac.phase_1;
+        current->phase_2_status = MEASUREMENT_OK;
+        DEBUG("Current 2 (S%i): %.1f\n", plan.current_ac[1] + 1, (double)current->phase_2);
+    }
+    if (plan.current_ac[2] >= 0) {
+        current->phase_3 = measurement[plan.current_ac[2]].current_ac.phase_1;
+        current->phase_3_status = MEASUREMENT_OK;
+        DEBUG("Current 3 (S%i): %.1f\n", plan.current_ac[2] + 1, (double)current->phase_3);
     }
-    return 0;
 }
 
-int gets_totalized_flow_measurement(int n_of_measurements, struct measurement *measurement)
+/*
+ * Totalize the largest flow of the flowmeters and give the total to all of them.
+ */
+static int totalize_flow(struct measurement *measurement)
 {
     float flow = 0;
+    int ret;
 
-    for (int i = 0; i < n_of_measurements; i++) {
-        if (measurement[i].type == FLOW_WATER_SENSOR) {
-            struct flow_water_measurement *flow_water = &(measurement[i].flow_water);
+    if (plan.n_flow == 0) {
+        return 0;
+    }
+    for (int k = 0; k < plan.n_flow; k++) {
+        struct flow_water_measurement *flow_water = &(measurement[plan.flow[k]].flow_water);
 
-            if (flow_water->flow_water > flow) {
-                flow = flow_water->flow_water;
-            }
+        if (flow_water->flow_water > flow) {
+            flow = flow_water->flow_water;
         }
-        cfg.totalized_flow += (uint32_t)round(flow * cfg.sampling_interval * 0.001f);
-        for (int i = 0; i < n_of_measurements; i++) {
-            if (measurement[i].type == FLOW_WATER_SENSOR) {
-                struct flow_water_measurement *flow_water = &(measurement[i].flow_water);
+    }
+    cfg.totalized_flow += (uint32_t)round(flow * cfg.sampling_interval * 0.001f);
+    for (int k = 0; k < plan.n_flow; k++) {
+        struct flow_water_measurement *flow_water = &(measurement[plan.flow[k]].flow_water);
 
-                flow_water->accumulated = cfg.totalized_flow;
-                flow_water->flow_water = flow;
-                flow_water->accumulated_status = MEASUREMENT_OK;
-                flow_water->flow_water_status = MEASUREMENT_OK;
-                int ret;
+        flow_water->accumulated = cfg.totalized_flow;
+        flow_water->flow_water = flow;
+        flow_water->accumulated_status = MEASUREMENT_OK;
+        flow_water->flow_water_status = MEASUREMENT_OK;
+    }
+    ret = write_configuration_field(&cfg.totalized_flow);
+    if (ret < 0) {
+        printk("Error guardando totalizador!\n");
+        return -1;
+    }
+    printk("Totalizador %i\n", cfg.totalized_flow);
+    return 0;
+}
 
-                ret = write_configuration();
-                if (ret < 0) {
-                    printk("Error guardando totalizador!\n");
-                    return -1;
-                }
-                printk("Totalizador %i\n", cfg.totalized_flow);
-            }
+/**
+ * Calculate the salinity and the concentration of one oxygen sensor acquired
+ * alone, with the last measurements of its partners.
+ * @param index The index of the sensor in the array
+ * @param measurement An array with all the measurements.
+ */
+void measurements_derive_sensor(int index, struct measurement *measurement)
+{
+    if (!plan.valid) {
+        return;
+    }
+    for (int k = 0; k < plan.n_salinity; k++) {
+        if (plan.salinity[k].oxygen == index) {
+            measurement[index].oxygen.salinity = measurement[plan.salinity[k].conductivity].conductivity.salinity;
+            measurement[index].oxygen.salinity_status = MEASUREMENT_OK;
         }
     }
-    return 0;
+    for (int k = 0; k < plan.n_concentration; k++) {
+        if (plan.concentration[k] == index) {
+            measurement_calculate_oxygen_concentration(&(measurement[index]));
+        }
+    }
+}
+
+/**
+ * Calculate the measurements that depend on other sensors: the salinity and
+ * concentration of the oxygen sensors, the second level, the AC phases and the
+ * totalized flow. The partners are taken from the join plan, which is built
+ * only after a detection.
+ * @param n_of_measurements The number of measurements in the array to process
+ * @param measurement An array with all the measurements to process.
+ */
+void measurements_derive(int n_of_measurements, struct measurement *measurement)
+{
+    if (!plan.valid || plan.n_of_measurements != n_of_measurements) {
+        join_plan_build(n_of_measurements, measurement);
+    }
+    join_oxygen_with_salinity(measurement);
+    for (int k = 0; k < plan.n_concentration; k++) {
+        measurement_calculate_oxygen_concentration(&(measurement[plan.concentration[k]]));
+    }
+    join_two_levels(measurement);
+    join_current_ac(measurement);
+    totalize_flow(measurement);
 }
 
 int average_oil_level(int n_of_measurements, struct measurement *measurement)
@@ -12,6 +12,7 @@
 #include "modbus.h"
 #include "debug.h"
 #include "watchdog.h"
+#include "smart_sensor.h"
 
 #define MAX_RESPONSE_SIZE 100
 #define TIMEOUT_MS        500
@@ -55,6 +56,7 @@ static int modbus_get_response(uint8_t serial_port, uint8_t *response, int max_s
     int64_t start;
     int n = 0;
     int c;
+    uint32_t first_byte_timeout = smart_sensor_response_timeout(TIMEOUT_MS);
 
     rs485_receive(UART_SMART_SENSOR);
     start = get_uptime_ms();
@@ -64,15 +66,21 @@ static int modbus_get_response(uint8_t serial_port, uint8_t *response, int max_s
         c = serial_getchar(serial_port);
         if (c < 0) {
             /* For now the max response time is 200ms, so we use 400ms to be sure is a timeout*/
-            if (ms_elapsed(&start) > TIMEOUT_MS) {
+            if (ms_elapsed(&start) > (n == 0 ? first_byte_timeout : TIMEOUT_MS)) {
                 break;
             }
         } else {
+            if (n == 0) {
+                smart_sensor_response_received(ms_elapsed(&start));
+            }
             *response++ = c;
             start = get_uptime_ms();
             n++;
         }
     }
+    if (n == 0) {
+        smart_sensor_response_timedout(first_byte_timeout, TIMEOUT_MS);
+    }
     return n;
 }
 
@@ -0,0 +1,195 @@
+/**
+ *  \file node_statistics.c
+ *  \brief Statistics of the node sent to the coordinator
+ *
+ *  Every NODE_STATISTICS_INTERVAL seconds a set of STAT frames is queued in the
+ *  measurement storage, one per section, so they are sent with the measurements.
+ *  The frames have the same header as the measurements:
+ *  :<timestamp>:<name>:0:STAT <section> <values>
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+#include <string.h>
+#include <zephyr/kernel.h>
+#include "microio.h"
+#include "debug.h"
+#include "configuration.h"
+#include "measurement_storage.h"
+#include "radio.h"
+#include "profiler.h"
+#include "energy.h"
+#include "adc.h"
+#include "smart_sensor.h"
+#include "actual_conditions.h"
+#include "measurement_aggregation.h"
+#include "node_statistics.h"
+
+#define STATISTICS_FRAME_LEN 110
+
+static int64_t uptime_at_last_statistics;
+static uint8_t statistics_sent;
+
+static int statistics_header(char *frame, size_t size, uint32_t timestamp, int sensor_number, const char *section)
+{
+    return usnprintf(frame, size, ":%u:%s:%i:STAT %s", timestamp, cfg.name, sensor_number, section);
+}
+
+static void append_airtime(uint32_t timestamp)
+{
+    char frame[STATISTICS_FRAME_LEN];
+    struct radio_airtime current;
+    struct radio_airtime last_cycle;
+    int pos;
+
+    radio_get_airtime(&current, &last_cycle);
+    pos = statistics_header(frame, sizeof(frame), timestamp, 0, "AIR");
+    usnprintf(frame + pos,
+              sizeof(frame) - pos,
+              " %u %u %u %u %u",
+              last_cycle.tx_ms,
+              last_cycle.rx_ms,
+              radio_airtime_charge_uah(&last_cycle),
+              current.total_tx_ms / MSEC_PER_SEC,
+              current.total_rx_ms / MSEC_PER_SEC);
+    measurement_storage_append(frame, STATISTICS_FRAME_LEN);
+}
+
+/*
+ * Charge of the last cycle, uAh, and per day at the rate of the last cycle and
+ * since the boot, mAh. The battery voltage, mV, is there to validate the model.
+ */
+static void append_energy(uint32_t timestamp)
+{
+    char frame[STATISTICS_FRAME_LEN];
+    struct energy_residency last_cycle;
+    struct energy_residency total;
+    int pos;
+
+    energy_get_residency(&last_cycle, &total);
+    pos = statistics_header(frame, sizeof(frame), timestamp, 0, "ENERGY");
+    usnprintf(frame + pos,
+              sizeof(frame) - pos,
+              " %u %u %u %u %i",
+              (uint32_t)(last_cycle.elapsed_ms / MSEC_PER_SEC),
+              energy_charge_uah(&last_cycle),
+              energy_mah_per_day(&last_cycle),
+              energy_mah_per_day(&total),
+              adc_read_battery());
+    measurement_storage_append(frame, STATISTICS_FRAME_LEN);
+}
+
+/*
+ * Average of every phase of the cycle, ms, in the order of enum profile_phase.
+ */
+static void append_profile(uint32_t timestamp)
+{
+    char frame[STATISTICS_FRAME_LEN];
+    struct profile_stats stats;
+    int pos;
+
+    pos = statistics_header(frame, sizeof(frame), timestamp, 0, "PROF");
+    for (int i = 0; i < PROFILE_PHASE_END && pos < sizeof(frame); i++) {
+        profiler_get(i, &stats);
+        pos += usnprintf(frame + pos, sizeof(frame) - pos, " %u", profiler_average_us(&stats) / USEC_PER_MSEC);
+    }
+    measurement_storage_append(frame, STATISTICS_FRAME_LEN);
+}
+
+/*
+ * Acquisition statistics of every smart sensor, one frame per sensor with its
+ * number in the header.
+ */
+static void append_sensors(uint32_t timestamp)
+{
+    char frame[STATISTICS_FRAME_LEN];
+    struct smart_sensor *s;
+    int pos;
+
+    for (int i = 0; i < actual_state.n_of_sensors_detected; i++) {
+        s = smart_sensor_get(i);
+        if (s == NULL) {
+            continue;
+        }
+        pos = statistics_header(frame, sizeof(frame), timestamp, s->number, "SENS");
+        usnprintf(frame + pos,
+                  sizeof(frame) - pos,
+                  " %u %u %u %u %u %u %u",
+                  s->stats.successes,
+                  s->stats.failures,
+                  s->stats.timeouts,
+                  s->stats.skipped,
+                  s->stats.avg_latency_ms,
+                  s->stats.max_latency_ms,
+                  s->stats.tries);
+        measurement_storage_append(frame, STATISTICS_FRAME_LEN);
+    }
+}
+
+static void append_aggregation(uint32_t timestamp, int sensor_number, int slot)
+{
+    char frame[STATISTICS_FRAME_LEN];
+    struct field_summary fields[AGGREGATION_MAX_FIELDS];
+    int n = aggregation_get(slot, fields);
+    int pos;
+
+    if (n == 0) {
+        return;
+    }
+    pos = statistics_header(frame, sizeof(frame), timestamp, sensor_number, "AGG");
+    for (int i = 0; i < n && pos < sizeof(frame); i++) {
+        pos += usnprintf(frame + pos,
+                         sizeof(frame) - pos,
+                         " %u %.2f %.2f %.2f",
+                         fields[i].count,
+                         (double)fields[i].min,
+                         (double)fields[i].max,
+                         (double)field_summary_stddev(&fields[i]));
+    }
+    measurement_storage_append(frame, STATISTICS_FRAME_LEN);
+}
+
+/**
+ * Queue the statistics of the log interval, one frame per sensor and one for
+ * the node: samples, minimum, maximum and standard deviation of every variable.
+ * The means are sent in the measurement frames.
+ */
+void node_statistics_append_aggregation(uint32_t timestamp)
+{
+    struct smart_sensor *s;
+
+    for (int i = 0; i < actual_state.n_of_sensors_detected; i++) {
+        s = smart_sensor_get(i);
+        if (s != NULL) {
+            append_aggregation(timestamp, s->number, i);
+        }
+    }
+    append_aggregation(timestamp, 0, AGGREGATION_NODE_SLOT);
+}
+
+/**
+ * Mark the start of a new sampling cycle in all the counters.
+ */
+void node_statistics_new_cycle(void)
+{
+    radio_airtime_new_cycle();
+    energy_new_cycle();
+}
+
+/**
+ * Queue the statistics frames if the interval has elapsed.
+ */
+void node_statistics_append(uint32_t timestamp)
+{
+    if (statistics_sent && (k_uptime_get() - uptime_at_last_statistics) < NODE_STATISTICS_INTERVAL * MSEC_PER_SEC) {
+        return;
+    }
+    DEBUG("Queueing node statistics\n");
+    append_airtime(timestamp);
+    append_energy(timestamp);
+    append_sensors(timestamp);
+    if (cfg.profiling_frame) {
+        append_profile(timestamp);
+    }
+    uptime_at_last_statistics = k_uptime_get();
+    statistics_sent = 1;
+}
@@ -32,6 +32,11 @@
 /* The frame buffer for the screen */
 uint8_t frame_buffer[DISPLAY_ROWS * DISPLAY_STRIDE];
 
+/* Hash of the frame buffer as it was last sent to the display */
+static uint32_t flushed_hash;
+static uint8_t flushed_hash_valid;
+static struct display_flush_stats flush_stats;
+
 /*
  * Local prototypes
  */
@@ -86,6 +91,51 @@ void init_and_clear_lcd(void)
     display_init(frame_buffer);
     display_driver_set_contrast(cfg.lcd_contrast);
     display_clear();
+    display_invalidate();
+}
+
+/*
+ * FNV-1a of the frame buffer
+ */
+static uint32_t frame_hash(void)
+{
+    uint32_t hash = 2166136261UL;
+
+    for (int i = 0; i < sizeof(frame_buffer); i++) {
+        hash = (hash ^ frame_buffer[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+int display_flush_changed(void)
+{
+    uint32_t hash = frame_hash();
+
+    if (flushed_hash_valid && hash == flushed_hash) {
+        flush_stats.skipped++;
+        return 0;
+    }
+    flushed_hash = hash;
+    flushed_hash_valid = 1;
+    display_flush();
+    flush_stats.flushes++;
+    flush_stats.bytes += DISPLAY_FRAME_BYTES;
+    return 1;
+}
+
+void display_invalidate(void)
+{
+    flushed_hash_valid = 0;
+}
+
+void display_get_flush_stats(struct display_flush_stats *stats)
+{
+    *stats = flush_stats;
+}
+
+void display_reset_flush_stats(void)
+{
+    memset(&flush_stats, 0, sizeof(flush_stats));
 }
 /**
  * Display which memory will be in use
@@ -112,7 +162,7 @@ void display_welcome_message(void)
     mac_address_to_string(&mac.dev_id, mac.length, mac_string);
     display_printf("%s\n", mac_string);
     display_which_memory();
-    display_flush();
+    display_flush_changed();
     /*    lcd_printf("%.2x %.2x %.2x %.2x\n", (mac_address >> 48) & 0xFFFF, (mac_address >> 32) & 0xFFFF, (mac_address
      */
     /*    >> 16) & 0xFFFF,  mac_address & 0xFFFF ); */
@@ -149,7 +199,7 @@ void display_going_to_sleep(int seconds)
     display_printf("Sleeping in");
     display_move(10, 30);
     display_printf("%i seconds\n", seconds);
-    display_flush();
+    display_flush_changed();
 }
 
 void display_all_measurements(int n_of_sensors_active, struct measurement *measurement, uint8_t use_sat)
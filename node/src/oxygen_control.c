@@ -17,6 +17,7 @@
 #include "hardware.h"
 #include "adc.h"
 #include "solenoid.h"
+#include "valve_actuator.h"
 #include "debug.h"
 #include "oxygen_saturation.h"
 #include "measurement.h"
@@ -27,8 +28,7 @@
 /*
  * Local defines and constants
  */
-#define MAX_SOLENOID_FINISH_VOLTAGE 7000 /* If the solenoid finishes higher than this, disconnected */
-#define MIN_SOLENOID_FINISH_VOLTAGE 4000 /* If the solenoid finishes lower than this, short-circuit */
+#define VALVE_ACTUATION_TIME 2000 /* ms, worst case capacitor charge and pulse */
 
 const struct valve_configuration default_valve_configuration = {
     .associated_sensor = 1,
@@ -46,15 +46,9 @@ const struct valve_configuration default_valve_configuration = {
  */
 struct valve_state {
     uint8_t valve_is_open;       /* Flag to notify that the valve is open */
-    uint8_t valve_retries;       /* Number of times remaining to pulse the valve again for security */
     enum solenoid_status status; /* The status of the valve */
 };
 
-/*
- * Local prototypes
- */
-static enum solenoid_status check_valve_finish_voltage(void);
-
 /*
  * Valve configuration.
  * The configuration is in another place, we just keep a pointer to that place here.
@@ -94,6 +88,10 @@ enum solenoid_status open_oxygen_flow(int valve_nr)
         status = SOLENOID_INVALID_VALUE;
         goto finish;
     }
+    if (cfg(valve_nr)->valve_type == VALVE_NORMALLY_OPEN || cfg(valve_nr)->valve_type == VALVE_NORMALLY_CLOSE) {
+        /* Driving the coils directly must not cut a pulse in progress */
+        valve_actuator_wait(VALVE_ACTUATOR_DRAIN_MS);
+    }
     if (cfg(valve_nr)->valve_type == VALVE_NORMALLY_OPEN) {
         status = solenoid_release();
     } else if (cfg(valve_nr)->valve_type == VALVE_NORMALLY_CLOSE) {
@@ -101,27 +99,16 @@ enum solenoid_status open_oxygen_flow(int valve_nr)
     } else if (cfg(valve_nr)->valve_type == VALVE_BISTABLE || cfg(valve_nr)->valve_type == VALVE_BISTABLE_INVERSE) {
         if (!actual_state[valve_nr].valve_is_open) {
             actual_state[valve_nr].valve_is_open = 1;
-            actual_state[valve_nr].valve_retries = cfg(valve_nr)->valve_number_of_pulses;
-        }
-        if (actual_state[valve_nr].valve_retries > 0) {
-            actual_state[valve_nr].valve_retries--;
-            /* Send a pulse in the open direction */
+            /* Pulses in the open direction, given in the background */
             DEBUG("Opening valve\n");
-            watchdog_disable();
-            status = solenoid_prepare(); /* Here we get the status of the solenoid power supply */
-            if (cfg(valve_nr)->valve_type == VALVE_BISTABLE) {
-                solenoid_activate_forward(valve_nr);
-            } else {
-                solenoid_activate_reverse(valve_nr);
-            }
-            sleep_microseconds(cfg(valve_nr)->solenoid_pulse_length);
-            /* Read the solenoid voltage just before release, only if it was already ok */
-            if (status == SOLENOID_OK) {
-                status = check_valve_finish_voltage();
-            }
-            solenoid_release();
-            watchdog_init();
+            valve_actuator_pulse(valve_nr,
+                                 cfg(valve_nr)->valve_type == VALVE_BISTABLE ? VALVE_PULSE_FORWARD
+                                                                             : VALVE_PULSE_REVERSE,
+                                 cfg(valve_nr)->valve_number_of_pulses,
+                                 cfg(valve_nr)->solenoid_pulse_length);
         }
+        /* The status of the previous pulse request, the one above may still be pending */
+        status = valve_actuator_status(valve_nr);
     }
 finish:
     return status;
@@ -139,6 +126,10 @@ enum solenoid_status close_oxygen_flow(int valve_nr)
         status = SOLENOID_INVALID_VALUE;
         goto finish;
     }
+    if (cfg(valve_nr)->valve_type == VALVE_NORMALLY_OPEN || cfg(valve_nr)->valve_type == VALVE_NORMALLY_CLOSE) {
+        /* Driving the coils directly must not cut a pulse in progress */
+        valve_actuator_wait(VALVE_ACTUATOR_DRAIN_MS);
+    }
     if (cfg(valve_nr)->valve_type == VALVE_NORMALLY_OPEN) {
         status = solenoid_activate_forward(valve_nr);
     } else if (cfg(valve_nr)->valve_type == VALVE_NORMALLY_CLOSE) {
@@ -146,27 +137,16 @@ enum solenoid_status close_oxygen_flow(int valve_nr)
     } else if (cfg(valve_nr)->valve_type == VALVE_BISTABLE || cfg(valve_nr)->valve_type == VALVE_BISTABLE_INVERSE) {
         if (actual_state[valve_nr].valve_is_open) {
             actual_state[valve_nr].valve_is_open = 0;
-            actual_state[valve_nr].valve_retries = cfg(valve_nr)->valve_number_of_pulses;
-        }
-        if (actual_state[valve_nr].valve_retries > 0) {
-            actual_state[valve_nr].valve_retries--;
-            /* Send a pulse in the close direction */
+            /* Pulses in the close direction, given in the background */
             DEBUG("Closing valve\n");
-            watchdog_disable();
-            status = solenoid_prepare();
-            if (cfg(valve_nr)->valve_type == VALVE_BISTABLE) {
-                solenoid_activate_reverse(valve_nr);
-            } else {
-                solenoid_activate_forward(valve_nr);
-            }
-            sleep_microseconds(cfg(valve_nr)->solenoid_pulse_length);
-            /* Read the solenoid voltage just before release, only if it was already ok */
-            if (status == SOLENOID_OK) {
-                status = check_valve_finish_voltage();
-            }
-            solenoid_release();
-            watchdog_init();
+            valve_actuator_pulse(valve_nr,
+                                 cfg(valve_nr)->valve_type == VALVE_BISTABLE ? VALVE_PULSE_REVERSE
+                                                                             : VALVE_PULSE_FORWARD,
+                                 cfg(valve_nr)->valve_number_of_pulses,
+                                 cfg(valve_nr)->solenoid_pulse_length);
         }
+        /* The status of the previous pulse request, the one above may still be pending */
+        status = valve_actuator_status(valve_nr);
     }
 finish:
     return status;
@@ -238,6 +218,44 @@ void check_oxygen_levels_all_valves(int use_saturation, struct measurement *meas
     }
 }
 
+/**
+ * Check if any valve in automatic mode needs the fast control loop: it is
+ * open, or its oxygen is close to the open level.
+ * @param use_saturation A Flag to tell if the check is using the saturation value
+ * @param measurements A list with the last measurements of all sensors.
+ * @param n_of_measurements The number of measurements in the list
+ */
+int oxygen_control_fast_loop_needed(int use_saturation, const struct measurement *measurements, int n_of_measurements)
+{
+    const struct measurement *m;
+    float level;
+
+    for (int valve = 0; valve < MAX_N_VALVES; ++valve) {
+        if (!cfg(valve)->is_active || cfg(valve)->injection_mode != INJECTION_AUTO) {
+            continue;
+        }
+        if (cfg(valve)->associated_sensor < 0 || cfg(valve)->associated_sensor >= n_of_measurements) {
+            continue;
+        }
+        if (actual_state[valve].valve_is_open) {
+            return 1;
+        }
+        m = &(measurements[cfg(valve)->associated_sensor]);
+        if (m->type != OXYGEN_SENSOR || m->sensor_status != SENSOR_OK) {
+            continue;
+        }
+        if (use_saturation) {
+            level = m->oxygen.saturation - OXYGEN_CONTROL_NEAR_SATURATION;
+        } else {
+            level = m->oxygen.concentration - OXYGEN_CONTROL_NEAR_LEVEL;
+        }
+        if (level < cfg(valve)->injection_open_level) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 /**
  * Set the configuration for a valve
  */
@@ -302,10 +320,9 @@ enum solenoid_status valve_detect_and_close(int valve_nr)
     enum solenoid_status status;
 
     actual_state[valve_nr].valve_is_open = 1; /* Assume valve may be open */
-    actual_state[valve_nr].valve_retries = 0;
-    do {
-        status = close_oxygen_flow(valve_nr);
-    } while (actual_state[valve_nr].valve_retries > 0);
+    close_oxygen_flow(valve_nr);
+    valve_actuator_wait(VALVE_ACTUATION_TIME * cfg(valve_nr)->valve_number_of_pulses);
+    status = valve_actuator_status(valve_nr);
     if (status == SOLENOID_DISCONNECTED) {
         status = SOLENOID_NOT_DETECTED;
     }
@@ -339,20 +356,6 @@ int valve_in_open_state(int valve_nr)
     return actual_state[valve_nr].valve_is_open;
 }
 
-static enum solenoid_status check_valve_finish_voltage(void)
-{
-    enum solenoid_status status = SOLENOID_OK;
-
-    int solenoid_mv = adc_read_solenoid_supply();
-
-    if (solenoid_mv > MAX_SOLENOID_FINISH_VOLTAGE) {
-        status = SOLENOID_DISCONNECTED;
-    } else if (solenoid_mv < MIN_SOLENOID_FINISH_VOLTAGE) {
-        status = SOLENOID_SHORT_CIRCUIT;
-    }
-    return status;
-}
-
 /**
  * Detect a bi-stable valve and get the start and end voltage.
  * @param The valve number
@@ -364,6 +367,8 @@ enum solenoid_status detect_valve(int valve_nr, int *mv_charged, int *mv_dischar
 {
     enum solenoid_status status;
 
+    /* The supply is used here directly */
+    valve_actuator_wait(VALVE_ACTUATOR_DRAIN_MS);
     watchdog_reset();
     solenoid_prepare();
     *mv_charged = adc_read_solenoid_supply();
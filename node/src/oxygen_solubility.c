@@ -0,0 +1,140 @@
+/**
+ *  \file oxygen_solubility.c
+ *  \brief Oxygen concentration from the saturation with a fixed point table
+ *
+ *  The concentration is the saturation times the solubility of oxygen at
+ *  the temperature and salinity of the water. The solubility equations are
+ *  exponentials of polynomials, slow in soft float on the M0+, so the
+ *  solubility is kept in a constant table of ug/l every 0.5 C and 2 PSU and
+ *  interpolated in fixed point. The table is generated with the same equations
+ *  by scripts/solubility_table.py. The error of the interpolation grows with
+ *  the saturation and stays below 0.004 mg/l up to 250%, checked with the
+ *  "o2check" shell command and the host test in tests/oxygen_solubility.
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+#include <math.h>
+#include "oxygen_saturation.h"
+#include "temperature.h"
+#include "watchdog.h"
+#include "profiler.h"
+#include "oxygen_solubility.h"
+
+#define WEIGHT_SHIFT      8  /* Interpolation weights in 1/256 */
+#define CHECK_SATURATIONS 11 /* Saturations checked, 0 to SOLUBILITY_MAX_SATURATION */
+
+/*
+ * Split a position in the table, in 1/256 of a step, in the index of the cell
+ * and the weight of the next row. The last point of the range uses the last cell.
+ */
+static int cell_of(int32_t position, int n, int32_t *weight)
+{
+    int index = position >> WEIGHT_SHIFT;
+
+    *weight = position & ((1 << WEIGHT_SHIFT) - 1);
+    if (index >= n - 1) {
+        index = n - 2;
+        *weight = 1 << WEIGHT_SHIFT;
+    }
+    return index;
+}
+
+/**
+ * Oxygen concentration, mg/l.
+ * @param saturation Saturation, %
+ * @param salinity PSU
+ * @param temperature Celsius
+ */
+float oxygen_concentration_fast(float saturation, float salinity, float temperature)
+{
+    int32_t t_position;
+    int32_t s_position;
+    int32_t t_weight;
+    int32_t s_weight;
+    int t;
+    int s;
+    int32_t low;
+    int32_t high;
+    int32_t value;
+
+    if (!(temperature >= SOLUBILITY_MIN_TEMPERATURE && temperature <= SOLUBILITY_MAX_TEMPERATURE) ||
+        !(salinity >= SOLUBILITY_MIN_SALINITY && salinity <= SOLUBILITY_MAX_SALINITY)) {
+        return oxygen_concentration(saturation, salinity, kelvin(temperature));
+    }
+    /* Positions in 1/256 of a step of the table */
+    t_position = (int32_t)((temperature - SOLUBILITY_MIN_TEMPERATURE) * (SOLUBILITY_STEPS_PER_C * 256) + 0.5f);
+    s_position = (int32_t)((salinity - SOLUBILITY_MIN_SALINITY) * (256.0f / SOLUBILITY_STEP_SALINITY) + 0.5f);
+    t = cell_of(t_position, SOLUBILITY_N_TEMPERATURES, &t_weight);
+    s = cell_of(s_position, SOLUBILITY_N_SALINITIES, &s_weight);
+    /* Along the temperature, ug/l in 1/256 */
+    low = oxygen_solubility_table[t][s] * ((1 << WEIGHT_SHIFT) - t_weight) +
+          oxygen_solubility_table[t + 1][s] * t_weight;
+    high = oxygen_solubility_table[t][s + 1] * ((1 << WEIGHT_SHIFT) - t_weight) +
+           oxygen_solubility_table[t + 1][s + 1] * t_weight;
+    /* Along the salinity */
+    value = low + (((high - low) * s_weight) >> WEIGHT_SHIFT);
+    return saturation * (float)value * (1.0f / (100.0f * 1000.0f * (1 << WEIGHT_SHIFT)));
+}
+
+/**
+ * Compare the table with the float equations every 0.1 C and 1 PSU, at
+ * saturations from 0 to SOLUBILITY_MAX_SATURATION, and time both at 100%.
+ * @return 0 if the error is within SOLUBILITY_TOLERANCE, -1 otherwise
+ */
+int oxygen_solubility_check(struct solubility_check *check)
+{
+    volatile float sink;
+    struct profile_mark mark;
+    uint32_t table_us;
+    uint32_t float_us;
+
+    check->n_points = 0;
+    check->max_error = 0.0f;
+    for (int t = 0; t <= (SOLUBILITY_MAX_TEMPERATURE - SOLUBILITY_MIN_TEMPERATURE) * 10; t++) {
+        watchdog_reset();
+        for (int s = 0; s <= SOLUBILITY_MAX_SALINITY - SOLUBILITY_MIN_SALINITY; s++) {
+            float temperature = SOLUBILITY_MIN_TEMPERATURE + t * 0.1f;
+            float salinity = SOLUBILITY_MIN_SALINITY + s;
+            /* The concentration is proportional to the saturation */
+            float reference = oxygen_concentration(100.0f, salinity, kelvin(temperature)) / 100.0f;
+
+            for (int i = 0; i < CHECK_SATURATIONS; i++) {
+                float saturation = (float)SOLUBILITY_MAX_SATURATION * i / (CHECK_SATURATIONS - 1);
+                float fast = oxygen_concentration_fast(saturation, salinity, temperature);
+                float error = fabsf(fast - reference * saturation);
+
+                if (error > check->max_error) {
+                    check->max_error = error;
+                    check->max_error_saturation = saturation;
+                    check->max_error_temperature = temperature;
+                    check->max_error_salinity = salinity;
+                }
+                check->n_points++;
+            }
+        }
+    }
+    /* Same points, timed apart */
+    mark = profiler_start();
+    for (int t = 0; t <= (SOLUBILITY_MAX_TEMPERATURE - SOLUBILITY_MIN_TEMPERATURE) * 10; t++) {
+        watchdog_reset();
+        for (int s = 0; s <= SOLUBILITY_MAX_SALINITY - SOLUBILITY_MIN_SALINITY; s++) {
+            sink = oxygen_concentration_fast(
+                100.0f, SOLUBILITY_MIN_SALINITY + s, SOLUBILITY_MIN_TEMPERATURE + t * 0.1f);
+        }
+    }
+    table_us = profiler_elapsed_us(mark);
+    watchdog_reset();
+    mark = profiler_start();
+    for (int t = 0; t <= (SOLUBILITY_MAX_TEMPERATURE - SOLUBILITY_MIN_TEMPERATURE) * 10; t++) {
+        watchdog_reset();
+        for (int s = 0; s <= SOLUBILITY_MAX_SALINITY - SOLUBILITY_MIN_SALINITY; s++) {
+            sink = oxygen_concentration(
+                100.0f, SOLUBILITY_MIN_SALINITY + s, kelvin(SOLUBILITY_MIN_TEMPERATURE + t * 0.1f));
+        }
+    }
+    float_us = profiler_elapsed_us(mark);
+    (void)sink;
+    check->table_ns = (uint64_t)table_us * 1000 / (check->n_points / CHECK_SATURATIONS);
+    check->float_ns = (uint64_t)float_us * 1000 / (check->n_points / CHECK_SATURATIONS);
+    return check->max_error <= SOLUBILITY_TOLERANCE ? 0 : -1;
+}
@@ -0,0 +1,155 @@
+/**
+ *  \file oxygen_solubility_table.c
+ *  \brief Solubility of oxygen at 100% saturation, ug/l
+ *
+ *  Generated by scripts/solubility_table.py, do not edit.
+ *  Rows every 0.5 C from 0 C, columns every 2 PSU from 0 PSU.
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+#include "oxygen_solubility.h"
+
+const uint16_t oxygen_solubility_table[SOLUBILITY_N_TEMPERATURES][SOLUBILITY_N_SALINITIES] = {
+    {14621, 14419, 14219, 14022, 13827, 13635, 13446, 13259, 13075, 12894, 12715, /* 0.0 C */
+     12538, 12364, 12192, 12022, 11855, 11690, 11527, 11367, 11209, 11052},
+    {14416, 14217, 14021, 13828, 13637, 13449, 13263, 13080, 12899, 12721, 12545, /* 0.5 C */
+     12371, 12200, 12031, 11865, 11700, 11538, 11378, 11221, 11065, 10912},
+    {14216, 14021, 13828, 13638, 13451, 13266, 13084, 12904, 12726, 12551, 12378, /* 1.0 C */
+     12208, 12040, 11874, 11711, 11549, 11390, 11233, 11078, 10925, 10774},
+    {14020, 13829, 13640, 13453, 13269, 13088, 12909, 12732, 12558, 12386, 12216, /* 1.5 C */
+     12049, 11883, 11721, 11560, 11401, 11245, 11090, 10938, 10788, 10640},
+    {13829, 13641, 13456, 13273, 13092, 12914, 12738, 12564, 12393, 12224, 12057, /* 2.0 C */
+     11893, 11730, 11570, 11412, 11257, 11103, 10951, 10801, 10654, 10508},
+    {13643, 13458, 13276, 13096, 12918, 12743, 12570, 12400, 12232, 12066, 11902, /* 2.5 C */
+     11740, 11581, 11423, 11268, 11115, 10964, 10815, 10668, 10522, 10379},
+    {13460, 13279, 13100, 12923, 12749, 12577, 12407, 12239, 12074, 11911, 11750, /* 3.0 C */
+     11591, 11434, 11280, 11127, 10977, 10828, 10681, 10537, 10394, 10253},
+    {13282, 13104, 12928, 12754, 12583, 12414, 12247, 12082, 11920, 11760, 11601, /* 3.5 C */
+     11445, 11291, 11139, 10989, 10841, 10695, 10551, 10409, 10268, 10130},
+    {13107, 12932, 12759, 12589, 12421, 12255, 12091, 11929, 11769, 11612, 11456, /* 4.0 C */
+     11303, 11151, 11002, 10854, 10709, 10565, 10423, 10283, 10145, 10009},
+    {12937, 12765, 12595, 12427, 12262, 12099, 11938, 11779, 11622, 11467, 11314, /* 4.5 C */
+     11163, 11014, 10867, 10722, 10579, 10438, 10298, 10161, 10025,  9891},
+    {12770, 12601, 12434, 12269, 12107, 11946, 11788, 11632, 11477, 11325, 11175, /* 5.0 C */
+     11026, 10880, 10735, 10593, 10452, 10313, 10176, 10040,  9907,  9775},
+    {12607, 12441, 12277, 12115, 11955, 11797, 11642, 11488, 11336, 11186, 11039, /* 5.5 C */
+     10893, 10749, 10607, 10466, 10328, 10191, 10056,  9923,  9791,  9662},
+    {12447, 12284, 12123, 11964, 11807, 11651, 11498, 11347, 11198, 11051, 10905, /* 6.0 C */
+     10762, 10620, 10480, 10342, 10206, 10072,  9939,  9808,  9678,  9551},
+    {12291, 12131, 11972, 11816, 11661, 11509, 11358, 11209, 11063, 10918, 10775, /* 6.5 C */
+     10634, 10494, 10357, 10221, 10087,  9954,  9824,  9695,  9568,  9442},
+    {12139, 11981, 11825, 11671, 11519, 11369, 11221, 11075, 10930, 10788, 10647, /* 7.0 C */
+     10508, 10371, 10236, 10102,  9970,  9840,  9711,  9584,  9459,  9335},
+    {11989, 11834, 11681, 11529, 11380, 11232, 11087, 10943, 10801, 10660, 10522, /* 7.5 C */
+     10385, 10250, 10117,  9986,  9856,  9728,  9601,  9476,  9353,  9231},
+    {11843, 11690, 11539, 11390, 11243, 11098, 10955, 10813, 10674, 10536, 10400, /* 8.0 C */
+     10265, 10132, 10001,  9872,  9744,  9618,  9493,  9370,  9249,  9129},
+    {11700, 11549, 11401, 11255, 11110, 10967, 10826, 10687, 10549, 10414, 10280, /* 8.5 C */
+     10147, 10016,  9887,  9760,  9634,  9510,  9387,  9266,  9146,  9028},
+    {11559, 11412, 11266, 11122, 10979, 10839, 10700, 10563, 10428, 10294, 10162, /* 9.0 C */
+     10032,  9903,  9776,  9651,  9527,  9404,  9283,  9164,  9046,  8930},
+    {11422, 11277, 11133, 10991, 10851, 10713, 10576, 10442, 10308, 10177, 10047, /* 9.5 C */
+      9919,  9792,  9667,  9543,  9421,  9301,  9182,  9064,  8948,  8834},
+    {11288, 11145, 11003, 10864, 10726, 10590, 10455, 10323, 10191, 10062,  9934, /* 10.0 C */
+      9808,  9683,  9560,  9438,  9318,  9199,  9082,  8966,  8852,  8739},
+    {11156, 11015, 10876, 10739, 10603, 10469, 10337, 10206, 10077,  9949,  9823, /* 10.5 C */
+      9699,  9576,  9455,  9335,  9217,  9100,  8984,  8870,  8758,  8647},
+    {11027, 10888, 10752, 10616, 10483, 10351, 10220, 10092,  9965,  9839,  9715, /* 11.0 C */
+      9593,  9472,  9352,  9234,  9118,  9002,  8889,  8776,  8665,  8556},
+    {10901, 10764, 10629, 10496, 10365, 10235, 10107,  9980,  9855,  9731,  9609, /* 11.5 C */
+      9488,  9369,  9251,  9135,  9020,  8907,  8795,  8684,  8575,  8467},
+    {10777, 10643, 10510, 10379, 10249, 10121,  9995,  9870,  9747,  9625,  9505, /* 12.0 C */
+      9386,  9268,  9152,  9038,  8925,  8813,  8703,  8594,  8486,  8379},
+    {10656, 10523, 10393, 10263, 10136, 10010,  9885,  9763,  9641,  9521,  9403, /* 12.5 C */
+      9285,  9170,  9056,  8943,  8831,  8721,  8612,  8505,  8399,  8294},
+    {10537, 10406, 10278, 10150, 10025,  9901,  9778,  9657,  9537,  9419,  9302, /* 13.0 C */
+      9187,  9073,  8960,  8849,  8739,  8631,  8524,  8418,  8313,  8210},
+    {10420, 10292, 10165, 10040,  9916,  9794,  9673,  9554,  9436,  9319,  9204, /* 13.5 C */
+      9090,  8978,  8867,  8758,  8649,  8542,  8436,  8332,  8229,  8127},
+    {10306, 10179, 10054,  9931,  9809,  9689,  9570,  9452,  9336,  9221,  9108, /* 14.0 C */
+      8996,  8885,  8776,  8668,  8561,  8455,  8351,  8248,  8146,  8046},
+    {10194, 10069,  9946,  9825,  9704,  9586,  9468,  9353,  9238,  9125,  9013, /* 14.5 C */
+      8903,  8794,  8686,  8579,  8474,  8370,  8267,  8166,  8065,  7966},
+    {10084,  9961,  9840,  9720,  9602,  9485,  9369,  9255,  9142,  9031,  8920, /* 15.0 C */
+      8812,  8704,  8598,  8493,  8389,  8286,  8185,  8085,  7986,  7888},
+    { 9976,  9855,  9736,  9618,  9501,  9386,  9272,  9159,  9048,  8938,  8829, /* 15.5 C */
+      8722,  8616,  8511,  8408,  8305,  8204,  8104,  8006,  7908,  7812},
+    { 9870,  9751,  9633,  9517,  9402,  9288,  9176,  9065,  8956,  8847,  8740, /* 16.0 C */
+      8634,  8530,  8426,  8324,  8223,  8124,  8025,  7928,  7831,  7736},
+    { 9766,  9649,  9533,  9418,  9305,  9193,  9082,  8973,  8865,  8758,  8652, /* 16.5 C */
+      8548,  8445,  8343,  8242,  8143,  8044,  7947,  7851,  7756,  7662},
+    { 9665,  9549,  9435,  9322,  9210,  9099,  8990,  8882,  8776,  8670,  8566, /* 17.0 C */
+      8463,  8362,  8261,  8162,  8064,  7967,  7871,  7776,  7682,  7590},
+    { 9565,  9451,  9338,  9226,  9116,  9007,  8900,  8793,  8688,  8584,  8482, /* 17.5 C */
+      8380,  8280,  8181,  8083,  7986,  7890,  7796,  7702,  7610,  7518},
+    { 9467,  9354,  9243,  9133,  9025,  8917,  8811,  8706,  8602,  8500,  8399, /* 18.0 C */
+      8299,  8200,  8102,  8005,  7910,  7815,  7722,  7629,  7538,  7448},
+    { 9370,  9260,  9150,  9042,  8934,  8829,  8724,  8620,  8518,  8417,  8317, /* 18.5 C */
+      8218,  8121,  8024,  7929,  7834,  7741,  7649,  7558,  7468,  7379},
+    { 9276,  9167,  9058,  8952,  8846,  8741,  8638,  8536,  8435,  8336,  8237, /* 19.0 C */
+      8140,  8043,  7948,  7854,  7761,  7669,  7578,  7488,  7399,  7311},
+    { 9183,  9075,  8969,  8863,  8759,  8656,  8554,  8453,  8354,  8255,  8158, /* 19.5 C */
+      8062,  7967,  7873,  7780,  7688,  7598,  7508,  7419,  7332,  7245},
+    { 9092,  8986,  8880,  8776,  8674,  8572,  8471,  8372,  8274,  8177,  8081, /* 20.0 C */
+      7986,  7892,  7799,  7708,  7617,  7528,  7439,  7351,  7265,  7179},
+    { 9003,  8898,  8794,  8691,  8590,  8489,  8390,  8292,  8195,  8100,  8005, /* 20.5 C */
+      7911,  7819,  7727,  7637,  7547,  7459,  7371,  7285,  7199,  7115},
+    { 8915,  8811,  8709,  8607,  8507,  8408,  8311,  8214,  8118,  8024,  7930, /* 21.0 C */
+      7838,  7746,  7656,  7567,  7478,  7391,  7305,  7219,  7135,  7052},
+    { 8828,  8726,  8625,  8525,  8426,  8329,  8232,  8137,  8042,  7949,  7857, /* 21.5 C */
+      7765,  7675,  7586,  7498,  7411,  7325,  7239,  7155,  7072,  6989},
+    { 8743,  8642,  8543,  8444,  8347,  8250,  8155,  8061,  7968,  7876,  7784, /* 22.0 C */
+      7694,  7605,  7517,  7430,  7344,  7259,  7175,  7092,  7009,  6928},
+    { 8660,  8560,  8462,  8365,  8268,  8173,  8079,  7986,  7894,  7803,  7713, /* 22.5 C */
+      7624,  7537,  7450,  7364,  7279,  7195,  7112,  7029,  6948,  6868},
+    { 8578,  8480,  8382,  8286,  8191,  8098,  8005,  7913,  7822,  7732,  7644, /* 23.0 C */
+      7556,  7469,  7383,  7298,  7214,  7131,  7049,  6968,  6888,  6808},
+    { 8497,  8400,  8304,  8209,  8116,  8023,  7931,  7841,  7751,  7662,  7575, /* 23.5 C */
+      7488,  7402,  7318,  7234,  7151,  7069,  6988,  6908,  6828,  6750},
+    { 8418,  8322,  8227,  8134,  8041,  7950,  7859,  7770,  7681,  7594,  7507, /* 24.0 C */
+      7422,  7337,  7253,  7170,  7089,  7008,  6928,  6848,  6770,  6693},
+    { 8340,  8245,  8152,  8059,  7968,  7878,  7788,  7700,  7613,  7526,  7441, /* 24.5 C */
+      7356,  7273,  7190,  7108,  7027,  6947,  6868,  6790,  6713,  6636},
+    { 8263,  8170,  8077,  7986,  7896,  7807,  7719,  7631,  7545,  7460,  7375, /* 25.0 C */
+      7292,  7209,  7127,  7047,  6967,  6888,  6810,  6732,  6656,  6580},
+    { 8187,  8095,  8004,  7914,  7825,  7737,  7650,  7564,  7478,  7394,  7311, /* 25.5 C */
+      7228,  7147,  7066,  6986,  6907,  6829,  6752,  6676,  6600,  6525},
+    { 8113,  8022,  7932,  7843,  7755,  7668,  7582,  7497,  7413,  7330,  7247, /* 26.0 C */
+      7166,  7085,  7005,  6927,  6849,  6772,  6695,  6620,  6545,  6471},
+    { 8040,  7950,  7861,  7774,  7687,  7601,  7516,  7432,  7348,  7266,  7185, /* 26.5 C */
+      7104,  7025,  6946,  6868,  6791,  6715,  6639,  6565,  6491,  6418},
+    { 7968,  7879,  7792,  7705,  7619,  7534,  7450,  7367,  7285,  7204,  7123, /* 27.0 C */
+      7044,  6965,  6887,  6810,  6734,  6659,  6584,  6511,  6438,  6366},
+    { 7897,  7810,  7723,  7637,  7553,  7469,  7386,  7304,  7222,  7142,  7063, /* 27.5 C */
+      6984,  6906,  6829,  6753,  6678,  6604,  6530,  6457,  6385,  6314},
+    { 7827,  7741,  7655,  7571,  7487,  7404,  7322,  7241,  7161,  7081,  7003, /* 28.0 C */
+      6925,  6848,  6772,  6697,  6623,  6549,  6477,  6405,  6333,  6263},
+    { 7759,  7673,  7589,  7505,  7422,  7340,  7259,  7179,  7100,  7022,  6944, /* 28.5 C */
+      6867,  6791,  6716,  6642,  6568,  6496,  6424,  6353,  6282,  6213},
+    { 7691,  7607,  7523,  7440,  7359,  7278,  7198,  7119,  7040,  6963,  6886, /* 29.0 C */
+      6810,  6735,  6661,  6587,  6515,  6443,  6372,  6301,  6232,  6163},
+    { 7624,  7541,  7458,  7377,  7296,  7216,  7137,  7059,  6981,  6905,  6829, /* 29.5 C */
+      6754,  6680,  6606,  6534,  6462,  6391,  6321,  6251,  6182,  6114},
+    { 7559,  7476,  7395,  7314,  7234,  7155,  7077,  7000,  6923,  6847,  6773, /* 30.0 C */
+      6698,  6625,  6553,  6481,  6410,  6340,  6270,  6201,  6133,  6066},
+    { 7494,  7412,  7332,  7252,  7173,  7095,  7018,  6941,  6866,  6791,  6717, /* 30.5 C */
+      6644,  6571,  6500,  6429,  6358,  6289,  6220,  6152,  6085,  6018},
+    { 7430,  7350,  7270,  7191,  7113,  7036,  6960,  6884,  6809,  6735,  6662, /* 31.0 C */
+      6590,  6518,  6447,  6377,  6308,  6239,  6171,  6104,  6037,  5971},
+    { 7367,  7288,  7209,  7131,  7054,  6978,  6902,  6827,  6754,  6680,  6608, /* 31.5 C */
+      6536,  6466,  6396,  6326,  6257,  6190,  6122,  6056,  5990,  5925},
+    { 7305,  7226,  7149,  7072,  6995,  6920,  6845,  6772,  6699,  6626,  6555, /* 32.0 C */
+      6484,  6414,  6345,  6276,  6208,  6141,  6074,  6009,  5944,  5879},
+    { 7244,  7166,  7089,  7013,  6938,  6863,  6789,  6716,  6644,  6573,  6502, /* 32.5 C */
+      6432,  6363,  6294,  6226,  6159,  6093,  6027,  5962,  5898,  5834},
+    { 7183,  7107,  7031,  6955,  6881,  6807,  6734,  6662,  6591,  6520,  6450, /* 33.0 C */
+      6381,  6312,  6245,  6177,  6111,  6045,  5980,  5916,  5852,  5789},
+    { 7124,  7048,  6973,  6898,  6825,  6752,  6680,  6608,  6538,  6468,  6399, /* 33.5 C */
+      6330,  6263,  6196,  6129,  6064,  5999,  5934,  5871,  5808,  5745},
+    { 7065,  6990,  6916,  6842,  6769,  6697,  6626,  6555,  6486,  6416,  6348, /* 34.0 C */
+      6280,  6213,  6147,  6081,  6017,  5952,  5889,  5826,  5763,  5702},
+    { 7007,  6933,  6859,  6787,  6715,  6643,  6573,  6503,  6434,  6366,  6298, /* 34.5 C */
+      6231,  6165,  6099,  6034,  5970,  5907,  5844,  5781,  5720,  5659},
+    { 6950,  6876,  6804,  6732,  6661,  6590,  6520,  6451,  6383,  6315,  6249, /* 35.0 C */
+      6182,  6117,  6052,  5988,  5924,  5861,  5799,  5737,  5676,  5616},
+};
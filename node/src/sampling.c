@@ -13,15 +13,11 @@
 #include "debug.h"
 #include "smart_sensor.h"
 #include "measurement_operations.h"
-#include "timeutils.h"
 #include "sampling.h"
 #include "watchdog.h"
 #include "local_sensors.h"
 #include "configuration.h"
-
-#define DEPRECATED 0
-
-static uint64_t uptime_at_last_sample; /* zero-initialized by C; The uptime at the moment we did the last acquisition */
+#include "profiler.h"
 
 /**
  * Collect all the samples
@@ -31,42 +27,24 @@ int sampling(int communication_tries, int n_of_sensors, struct measurement *meas
     /* Smart sensors */
     DEBUG("Acquiring %i external sensors\n", n_of_sensors);
     if (n_of_sensors > 0) {
+        struct profile_mark mark = profiler_start();
+
         smart_sensor_prepare_all(n_of_sensors);
-        watchdog_disable();
         uint32_t t = get_sensors_preheat_time_ms() * 1000;
 
         DEBUG("Preheating sensors for: %i us\n", t);
+        watchdog_expect(t / 1000);
         sleep_microseconds(t);
+        watchdog_reset();
+        profiler_stop(PROFILE_PREHEAT, mark);
+        mark = profiler_start();
         smart_sensors_aquire_all(n_of_sensors, communication_tries, measurements);
-        watchdog_init();
-        measurements_join_oxygen_with_salinity(n_of_sensors, measurements);
-        measurements_list_calculate_oxygen_concentration(n_of_sensors, measurements);
-        measurements_join_two_levels(n_of_sensors, measurements);
-        measurements_join_current_ac(n_of_sensors, measurements);
+        profiler_stop(PROFILE_ACQUIRE, mark);
+        mark = profiler_start();
+        measurements_derive(n_of_sensors, measurements);
         average_oil_level(n_of_sensors, measurements);
-        gets_totalized_flow_measurement(n_of_sensors, measurements);
-    }
-    uptime_at_last_sample = get_uptime_ms();
-    return 0;
-}
-
-/**
- * Check if we it should start a sampling process.
- */
-int should_start_sampling(uint32_t sampling_interval)
-{
-    DEBUG("Should sample: %lli\n", get_uptime_ms() - uptime_at_last_sample);
-    if (uptime_at_last_sample == 0) {
-        return 1; /* Force sampling at the beginning */
-    }
-    if ((get_uptime_ms() - uptime_at_last_sample) > (sampling_interval * 1000)) {
-        return 1;
-    }
-#if DEPRECATED
-    if (is_calib_switch_active()) {
-        return 1;
+        profiler_stop(PROFILE_JOINS, mark);
     }
-#endif
     return 0;
 }
 
@@ -77,15 +55,13 @@ void acquire_local_sensors(struct measurement *node_measurement, struct measurem
 {
     uint16_t humidity;
     float temperature;
-    int v_bat;
-    int v_sensor;
+    struct adc_readings analog;
 
     node_measurement->type = NODE_INTERNAL_SENSOR;
     node_measurement->sensor_number = 0;
-    v_bat = adc_read_battery();
-    v_sensor = adc_read_sensor_supply();
-    node_measurement->node.battery_voltage = ((float)v_bat / 1000.0f);
-    node_measurement->node.sensor_voltage = ((float)v_sensor / 1000.0f);
+    adc_read_all(&analog);
+    node_measurement->node.battery_voltage = ((float)analog.battery_mv / 1000.0f);
+    node_measurement->node.sensor_voltage = ((float)analog.sensor_supply_mv / 1000.0f);
     watchdog_reset();
     int ret = local_sensors_get_hum_and_temp(&humidity, &temperature);
 
@@ -19,6 +19,18 @@
 #include "led.h"
 #include "measurement_storage.h"
 #include "shell_commands.h"
+#include "adr.h"
+#include "scheduler.h"
+#include "profiler.h"
+#include "energy.h"
+#include "userinterface.h"
+#include "measurement_aggregation.h"
+#include "measurement_operations.h"
+#include "oxygen_solubility.h"
+#include "uplink_filter.h"
+#include "valve_actuator.h"
+#include "gps_pa1010d.h"
+#include "nmea.h"
 #include <stdio.h>
 #if CONFIG_EXTERNAL_DATALOGGER
 #include "compressed_measurement.h"
@@ -31,6 +43,7 @@ struct shell_command command_list[] = {
     {"sleep",             to_sleep                           },
     {"name",              set_name                           },
     {"interval",          set_sampling_interval              },
+    {"wake",              set_wake_interval                  },
     {"contrast",          set_display_contrast               },
     {"commit",            save_configuration                 },
     {"reboot",            cmd_reboot                         },
@@ -57,6 +70,20 @@ struct shell_command command_list[] = {
     {"savedrivers",       cmd_set_sensor_config              },
     {"detect",            cmd_detect_sensors                 },
     {"volume",            cmd_volume_porcentage              },
+    {"adr",               cmd_adr                            },
+    {"airtime",           cmd_airtime                        },
+    {"jobs",              cmd_jobs                           },
+    {"stats",             cmd_stats                          },
+    {"energy",            cmd_energy                         },
+    {"sensors",           cmd_sensors                        },
+    {"uplink",            cmd_uplink                         },
+    {"deadband",          cmd_deadband                       },
+    {"joins",             cmd_joins                          },
+    {"o2check",           cmd_o2check                        },
+    {"control",           cmd_control                        },
+    {"pulse",             cmd_pulse                          },
+    {"gps",               cmd_gps                            },
+    {"nmeacheck",         cmd_nmeacheck                      },
     {0,                   0                                  }
 };
 
@@ -114,7 +141,7 @@ int to_sleep(char *str)
 {
     printk("To sleep\n");
     cfg.command_state = SLEEP;
-    write_configuration();
+    write_configuration_field(&cfg.command_state);
     return 0;
 }
 
@@ -160,6 +187,25 @@ int set_sampling_interval(char *str)
     return 0;
 }
 
+/**
+ * Set the time the console waits for a command every cycle
+ */
+int set_wake_interval(char *str)
+{
+    char buffer[20];
+    size_t size = sizeof(buffer);
+
+    if (!str) {
+        printk("Wake: %i\n", cfg.wake_interval);
+        usnprintf(buffer, size, "%s %s %i", cfg.name, "Wake", cfg.wake_interval);
+        radio_send_str(buffer, strlen(buffer) + 1);
+    } else {
+        cfg.wake_interval = atol(str);
+        printk("Set wake in: %i\n", cfg.wake_interval);
+    }
+    return 0;
+}
+
 /**
  * Set display contrast
  */
@@ -191,7 +237,7 @@ int cmd_reboot(char *s)
 
     if (!s) {
         cfg.command_state = SLEEP;
-        write_configuration();
+        write_configuration_field(&cfg.command_state);
         usnprintf(buffer, size, "%s %s", cfg.name, "Rebooting...");
         radio_send_str(buffer, strlen(buffer) + 1);
         printk("Rebooting...\n");
@@ -433,17 +479,14 @@ int cmd_set_distance(char *str)
             case 0:
                 cfg.bandwidth = BW_500_KHZ;
                 cfg.datarate = SF_7;
-                cfg.time_on_air = 33;
                 break;
             case 1:
                 cfg.bandwidth = BW_500_KHZ;
                 cfg.datarate = SF_11;
-                cfg.time_on_air = 350;
                 break;
             case 2:
                 cfg.bandwidth = BW_250_KHZ;
                 cfg.datarate = SF_11;
-                cfg.time_on_air = 699;
                 break;
         }
         cfg.command_state = SLEEP;
@@ -480,9 +523,9 @@ int cmd_tunnel(char *str)
 
     printk("power on\n");
     sensor_power_on(smart_sensors_detect_voltage());
-    watchdog_disable();
+    watchdog_expect(500);
     sleep_microseconds(500000);
-    watchdog_init();
+    watchdog_reset();
     serial_flush(UART_SMART_SENSOR); /* Clean the receive buffer */
     driver->init_driver();
     printk("Tunnel: %s--\n", str);
@@ -521,21 +564,13 @@ int cmd_current_sensor_status(char *str)
         if (!strncmp(str, "off", 3)) {
             printk("Desactivando sensor\n");
             cfg.current_sensor_status = 0;
-            solenoid_prepare();
-            solenoid_activate_reverse(0);
-            watchdog_reset();
-            sleep_microseconds(100000);
-            solenoid_release();
+            valve_actuator_pulse_now(0, VALVE_PULSE_REVERSE, SENSOR_RELAY_PULSE_US);
             usnprintf(buffer, size, "%s %s", cfg.name, "current OFF");
             radio_send_str(buffer, strlen(buffer) + 1);
         } else if (!strncmp(str, "on", 2)) {
             printk("Activando sensor\n");
             cfg.current_sensor_status = 1;
-            solenoid_prepare();
-            solenoid_activate_forward(0);
-            watchdog_reset();
-            sleep_microseconds(100000);
-            solenoid_release();
+            valve_actuator_pulse_now(0, VALVE_PULSE_FORWARD, SENSOR_RELAY_PULSE_US);
             usnprintf(buffer, size, "%s %s", cfg.name, "current ON");
             radio_send_str(buffer, strlen(buffer) + 1);
         } else {
@@ -630,7 +665,7 @@ int cmd_set_sensor_driver(char *str)
         printk("\nSensor states:\n");
         for (int i = 0; i < SENSOR_MANUFACTURER_END; i++) {
             if (sensor_names[i]) {
-                const char *status = (sen_drv.sensor_driver[i] != NULL) ? "active" : "inactive";
+                const char *status = (driver_for_manufacturer(i) != NULL) ? "active" : "inactive";
                 char buffer[50];
                 size_t size = sizeof(buffer);
 
@@ -754,10 +789,8 @@ int cmd_externalflash_datalogger_format(char *str)
 {
     int rc = 0;
 
-    watchdog_disable();
     printk("Erase external datalogger flash. Wait a 1 minute\n");
     datalogger_format();
-    watchdog_init();
 
     rc = datalogger_mount();
     if (rc != 0) {
@@ -864,3 +897,616 @@ int cmd_volume_porcentage(char *str)
     }
     return 0;
 }
+
+/**
+ * Adaptive data rate. Without arguments show the state of the uplink,
+ * "on" or "off" enable or disable it.
+ */
+int cmd_adr(char *str)
+{
+    char buffer[80];
+    size_t size = sizeof(buffer);
+
+    if (!str) {
+        uint32_t toa = radio_time_on_air_ms(RADIO_REFERENCE_FRAME_LEN, adr_get_datarate(), cfg.bandwidth);
+
+        printk("ADR: %s\n", cfg.adr_enabled ? "on" : "off");
+        printk("SF: %i (configured %i), power: %i dBm\n", adr_get_datarate(), cfg.datarate, adr_get_tx_power());
+        printk("Margin: %i dB, RSSI: %i dBm, samples: %i, missed: %i\n",
+               adr_get_link_margin(),
+               adr_get_average_rssi(),
+               adr.n_samples,
+               adr.missed_acks);
+        usnprintf(buffer,
+                  size,
+                  "%s %s %s SF %i %i dBm margin %i toa %i",
+                  cfg.name,
+                  "ADR",
+                  cfg.adr_enabled ? "on" : "off",
+                  adr_get_datarate(),
+                  adr_get_tx_power(),
+                  adr_get_link_margin(),
+                  toa);
+        radio_send_str(buffer, strlen(buffer) + 1);
+    } else if (!strncmp(str, "on", 2)) {
+        cfg.adr_enabled = 1;
+        adr_reset();
+        printk("ADR on\n");
+    } else if (!strncmp(str, "off", 3)) {
+        cfg.adr_enabled = 0;
+        adr_reset();
+        printk("ADR off\n");
+    } else {
+        printk("Enter on or off\n");
+    }
+    return 0;
+}
+
+/**
+ * Show the time the radio was transmitting and receiving.
+ */
+int cmd_airtime(char *str)
+{
+    char buffer[80];
+    size_t size = sizeof(buffer);
+    struct radio_airtime current;
+    struct radio_airtime last_cycle;
+
+    radio_get_airtime(&current, &last_cycle);
+    printk("Frame time on air: %i ms\n", radio_frame_time_on_air());
+    printk("Cycle: TX %i ms (%i frames), RX %i ms (%i windows)\n",
+           current.tx_ms,
+           current.tx_frames,
+           current.rx_ms,
+           current.rx_windows);
+    printk("Last cycle: TX %i ms, RX %i ms, %i uAh\n",
+           last_cycle.tx_ms,
+           last_cycle.rx_ms,
+           radio_airtime_charge_uah(&last_cycle));
+    printk("Total: TX %i s, RX %i s\n", current.total_tx_ms / MSEC_PER_SEC, current.total_rx_ms / MSEC_PER_SEC);
+    usnprintf(buffer,
+              size,
+              "%s %s TX %i RX %i uAh %i total TX %i RX %i",
+              cfg.name,
+              "Airtime",
+              last_cycle.tx_ms,
+              last_cycle.rx_ms,
+              radio_airtime_charge_uah(&last_cycle),
+              current.total_tx_ms / MSEC_PER_SEC,
+              current.total_rx_ms / MSEC_PER_SEC);
+    radio_send_str(buffer, strlen(buffer) + 1);
+    return 0;
+}
+
+/**
+ * Show the periodic jobs and their deadline misses.
+ */
+int cmd_jobs(char *str)
+{
+    char buffer[60];
+    size_t size = sizeof(buffer);
+    const char *name;
+    struct scheduler_job_stats stats;
+
+    for (int i = 0; i < JOB_END; i++) {
+        scheduler_get_stats(i, &name, &stats);
+        if (!name) {
+            continue;
+        }
+        printk("%s: period %i s, runs %i, misses %i, late %i ms, last %i ms\n",
+               name,
+               stats.period_ms / MSEC_PER_SEC,
+               stats.runs,
+               stats.misses,
+               stats.max_lateness_ms,
+               stats.last_run_ms);
+        usnprintf(buffer, size, "%s %s %i %i %i", cfg.name, name, stats.runs, stats.misses, stats.max_lateness_ms);
+        radio_send_str(buffer, strlen(buffer) + 1);
+    }
+    return 0;
+}
+
+static void print_profile(const char *name, const struct profile_stats *stats)
+{
+    printk("%s: n %i, min %i, avg %i, max %i ms\n",
+           name,
+           stats->count,
+           stats->min_us / USEC_PER_MSEC,
+           profiler_average_us(stats) / USEC_PER_MSEC,
+           stats->max_us / USEC_PER_MSEC);
+}
+
+/*
+ * Show the time spent in every phase of the sampling cycle, weighted to the
+ * recent cycles.
+ * stats reset clears the statistics, stats frame on|off sends them to the
+ * coordinator with the node statistics.
+ */
+int cmd_stats(char *str)
+{
+    char buffer[80];
+    size_t size = sizeof(buffer);
+    struct profile_stats stats;
+    struct display_flush_stats lcd;
+    const struct smart_sensor_driver *driver;
+
+    if (!str) {
+        for (int i = 0; i < PROFILE_PHASE_END; i++) {
+            profiler_get(i, &stats);
+            if (stats.count == 0) {
+                continue;
+            }
+            print_profile(profiler_phase_name(i), &stats);
+            usnprintf(buffer,
+                      size,
+                      "%s %s %i %i %i",
+                      cfg.name,
+                      profiler_phase_name(i),
+                      stats.min_us / USEC_PER_MSEC,
+                      profiler_average_us(&stats) / USEC_PER_MSEC,
+                      stats.max_us / USEC_PER_MSEC);
+            radio_send_str(buffer, strlen(buffer) + 1);
+        }
+        for (int i = 0; i < SENSOR_MANUFACTURER_END; i++) {
+            profiler_get_driver(i, &stats);
+            driver = driver_for_manufacturer(i);
+            if (stats.count == 0 || driver == NULL) {
+                continue;
+            }
+            print_profile(driver->name(), &stats);
+        }
+        /* All the screens, not only the sampling cycle */
+        display_get_flush_stats(&lcd);
+        printk("LCD: %u flushes, %u skipped, %u bytes\n", lcd.flushes, lcd.skipped, lcd.bytes);
+    } else if (!strncmp(str, "reset", 5)) {
+        profiler_reset();
+        display_reset_flush_stats();
+        printk("Statistics cleared\n");
+    } else if (!strncmp(str, "frame on", 8)) {
+        cfg.profiling_frame = 1;
+        printk("Profiling frame on\n");
+    } else if (!strncmp(str, "frame off", 9)) {
+        cfg.profiling_frame = 0;
+        printk("Profiling frame off\n");
+    } else {
+        printk("Enter reset, frame on or frame off\n");
+    }
+    return 0;
+}
+
+/*
+ * Show the estimated charge used by the node and the time in every power state.
+ * energy <load> <uA> sets the current of a load.
+ */
+int cmd_energy(char *str)
+{
+    char buffer[80];
+    size_t size = sizeof(buffer);
+    struct energy_residency last_cycle;
+    struct energy_residency total;
+    char *arg;
+
+    if (!str) {
+        energy_get_residency(&last_cycle, &total);
+        printk("Last cycle: %u s, %u uAh, %u mAh/day\n",
+               (uint32_t)(last_cycle.elapsed_ms / MSEC_PER_SEC),
+               energy_charge_uah(&last_cycle),
+               energy_mah_per_day(&last_cycle));
+        printk("Since boot: %u s, %u mAh, %u mAh/day\n",
+               (uint32_t)(total.elapsed_ms / MSEC_PER_SEC),
+               energy_charge_uah(&total) / 1000,
+               energy_mah_per_day(&total));
+        for (int i = 0; i < ENERGY_LOAD_END; i++) {
+            printk("%s: %u ms last cycle, %u uA\n",
+                   energy_load_name(i),
+                   (uint32_t)last_cycle.load_ms[i],
+                   cfg.load_current_ua[i]);
+        }
+        printk("Battery: %i mV\n", adc_read_battery());
+        usnprintf(buffer,
+                  size,
+                  "%s %s %u uAh %u mAh/day %i mV",
+                  cfg.name,
+                  "ENERGY",
+                  energy_charge_uah(&last_cycle),
+                  energy_mah_per_day(&last_cycle),
+                  adc_read_battery());
+        radio_send_str(buffer, strlen(buffer) + 1);
+        return 0;
+    }
+    arg = strtok_r(str, " ", &str);
+    for (int i = 0; i < ENERGY_LOAD_END; i++) {
+        if (!strcmp(arg, energy_load_name(i))) {
+            if (!str || !*str) {
+                printk("Enter the current in uA\n");
+                return -E_INVALID;
+            }
+            cfg.load_current_ua[i] = atoi(str);
+            printk("%s: %u uA\n", energy_load_name(i), cfg.load_current_ua[i]);
+            return 0;
+        }
+    }
+    printk("Enter cpu, idle, sensors, 12v, tx or rx and the current in uA\n");
+    return -E_INVALID;
+}
+
+/*
+ * Show the acquisition statistics of every smart sensor.
+ */
+int cmd_sensors(char *str)
+{
+    char buffer[80];
+    size_t size = sizeof(buffer);
+    struct smart_sensor *s;
+
+    for (int i = 0; i < actual_state.n_of_sensors_detected; i++) {
+        s = smart_sensor_get(i);
+        if (s == NULL) {
+            continue;
+        }
+        printk("%i %s: ok %u, fail %u, timeout %u, skipped %u\n",
+               s->number,
+               s->name,
+               s->stats.successes,
+               s->stats.failures,
+               s->stats.timeouts,
+               s->stats.skipped);
+        printk("  latency %u ms, avg %u ms, max %u ms, tries %i, backoff %i\n",
+               s->stats.last_latency_ms,
+               s->stats.avg_latency_ms,
+               s->stats.max_latency_ms,
+               s->stats.tries,
+               s->stats.backoff_cycles);
+        usnprintf(buffer,
+                  size,
+                  "%s %i %u %u %u %u %u",
+                  cfg.name,
+                  s->number,
+                  s->stats.successes,
+                  s->stats.failures,
+                  s->stats.timeouts,
+                  s->stats.skipped,
+                  s->stats.avg_latency_ms);
+        radio_send_str(buffer, strlen(buffer) + 1);
+    }
+    return 0;
+}
+
+static const char *uplink_mode_name(uint8_t mode)
+{
+    switch (mode) {
+    case UPLINK_SUMMARY:
+        return "summary";
+    case UPLINK_EXCEPTION:
+        return "exception";
+    default:
+        return "all";
+    }
+}
+
+/*
+ * Show or set what is sent after every sample: uplink all | summary | exception [heartbeat].
+ * In summary mode the samples are aggregated over the log interval. In
+ * exception mode only the measurements out of their deadband are sent, and
+ * everything every heartbeat seconds.
+ */
+int cmd_uplink(char *str)
+{
+    char buffer[80];
+    size_t size = sizeof(buffer);
+    char *arg;
+
+    if (!str) {
+        printk("Uplink: %s, interval %i s, heartbeat %i s\n",
+               uplink_mode_name(cfg.uplink_mode),
+               cfg.log_interval,
+               cfg.heartbeat_interval);
+        usnprintf(buffer,
+                  size,
+                  "%s %s %s %i %i",
+                  cfg.name,
+                  "uplink",
+                  uplink_mode_name(cfg.uplink_mode),
+                  cfg.log_interval,
+                  cfg.heartbeat_interval);
+        radio_send_str(buffer, strlen(buffer) + 1);
+        return 0;
+    }
+    arg = strtok_r(str, " ", &str);
+    if (!strcmp(arg, "all")) {
+        cfg.uplink_mode = UPLINK_ALL_SAMPLES;
+        printk("Uplink every sample\n");
+    } else if (!strcmp(arg, "summary")) {
+        cfg.uplink_mode = UPLINK_SUMMARY;
+        aggregation_reset();
+        printk("Uplink the summary every %i s\n", cfg.log_interval);
+    } else if (!strcmp(arg, "exception")) {
+        if (str && *str) {
+            if (atoi(str) <= 0) {
+                printk("Enter the heartbeat in seconds\n");
+                return -E_INVALID;
+            }
+            cfg.heartbeat_interval = atoi(str);
+        }
+        cfg.uplink_mode = UPLINK_EXCEPTION;
+        uplink_filter_reset();
+        printk("Uplink the changes, everything every %i s\n", cfg.heartbeat_interval);
+    } else {
+        printk("Enter all, summary or exception\n");
+        return -E_INVALID;
+    }
+    return 0;
+}
+
+static const char *const deadband_class_name[DEADBAND_CLASS_END] = {
+    [DEADBAND_OXYGEN] = "oxygen",
+    [DEADBAND_SATURATION] = "saturation",
+    [DEADBAND_TEMPERATURE] = "temperature",
+    [DEADBAND_SALINITY] = "salinity",
+    [DEADBAND_PH] = "ph",
+    [DEADBAND_CONDUCTIVITY] = "conductivity",
+    [DEADBAND_PRESSURE] = "pressure",
+    [DEADBAND_LEVEL] = "level",
+    [DEADBAND_FLOW] = "flow",
+    [DEADBAND_VOLTAGE] = "voltage",
+    [DEADBAND_STATE] = "state",
+    [DEADBAND_OTHER] = "other",
+};
+
+/*
+ * Show or set the deadbands of the report by exception: deadband [<class> <value>].
+ * A deadband of 0 sends every sample of the class.
+ */
+int cmd_deadband(char *str)
+{
+    char buffer[80];
+    size_t size = sizeof(buffer);
+    char *arg;
+    float value;
+
+    if (!str) {
+        for (int i = 0; i < DEADBAND_CLASS_END; i++) {
+            printk("%s: %.3f\n", deadband_class_name[i], (double)cfg.deadband[i]);
+            usnprintf(buffer,
+                      size,
+                      "%s %s %s %.3f",
+                      cfg.name,
+                      "deadband",
+                      deadband_class_name[i],
+                      (double)cfg.deadband[i]);
+            radio_send_str(buffer, strlen(buffer) + 1);
+        }
+        return 0;
+    }
+    arg = strtok_r(str, " ", &str);
+    for (int i = 0; i < DEADBAND_CLASS_END; i++) {
+        if (!strcmp(arg, deadband_class_name[i])) {
+            if (!str || !*str) {
+                printk("Enter the deadband\n");
+                return -E_INVALID;
+            }
+            string_to_float(str, &value);
+            if (value < 0.0f) {
+                return -E_INVALID;
+            }
+            cfg.deadband[i] = value;
+            uplink_filter_reset();
+            printk("%s: %.3f\n", deadband_class_name[i], (double)cfg.deadband[i]);
+            return 0;
+        }
+    }
+    printk("Enter oxygen, saturation, temperature, salinity, ph, conductivity, pressure, level, flow, voltage, "
+           "state or other and the deadband\n");
+    return -E_INVALID;
+}
+
+/*
+ * Show the join plan: the sensors that give the salinity to the oxygen
+ * sensors, the second level and the AC phases. Sensors are numbered from 1.
+ */
+int cmd_joins(char *str)
+{
+    char buffer[60];
+    size_t size = sizeof(buffer);
+    const struct join_plan *plan = join_plan_get();
+
+    if (!plan->valid) {
+        printk("Join plan not built yet\n");
+    }
+    for (int k = 0; k < plan->n_salinity; k++) {
+        usnprintf(buffer,
+                  size,
+                  "%s %s S%i S%i",
+                  cfg.name,
+                  "salinity",
+                  plan->salinity[k].oxygen + 1,
+                  plan->salinity[k].conductivity + 1);
+        printk("%s\n", buffer);
+        radio_send_str(buffer, strlen(buffer) + 1);
+    }
+    for (int k = 0; k < plan->n_concentration; k++) {
+        printk("Concentration S%i\n", plan->concentration[k] + 1);
+    }
+    for (int k = 0; k < plan->n_levels; k++) {
+        usnprintf(
+            buffer, size, "%s %s S%i S%i", cfg.name, "level", plan->level[k].first + 1, plan->level[k].second + 1);
+        printk("%s\n", buffer);
+        radio_send_str(buffer, strlen(buffer) + 1);
+    }
+    if (plan->current_ac[0] >= 0) {
+        usnprintf(buffer,
+                  size,
+                  "%s %s S%i S%i S%i",
+                  cfg.name,
+                  "phases",
+                  plan->current_ac[0] + 1,
+                  plan->current_ac[1] + 1,
+                  plan->current_ac[2] + 1);
+        printk("%s\n", buffer);
+        radio_send_str(buffer, strlen(buffer) + 1);
+    }
+    for (int k = 0; k < plan->n_flow; k++) {
+        printk("Totalized flow S%i\n", plan->flow[k] + 1);
+    }
+    return 0;
+}
+
+/*
+ * Compare the oxygen solubility table with the float equations over the
+ * operating envelope, up to SOLUBILITY_MAX_SATURATION, and show the time per
+ * calculation of both.
+ */
+int cmd_o2check(char *str)
+{
+    char buffer[80];
+    size_t size = sizeof(buffer);
+    struct solubility_check check;
+    int ret = oxygen_solubility_check(&check);
+
+    printk("%u points, max error %.4f mg/l at %.0f%% %.1f C %.0f PSU: %s\n",
+           check.n_points,
+           (double)check.max_error,
+           (double)check.max_error_saturation,
+           (double)check.max_error_temperature,
+           (double)check.max_error_salinity,
+           ret == 0 ? "OK" : "FAIL");
+    printk("Table %u ns, float %u ns\n", check.table_ns, check.float_ns);
+    usnprintf(buffer,
+              size,
+              "%s %s %.4f %u %u %s",
+              cfg.name,
+              "o2check",
+              (double)check.max_error,
+              check.table_ns,
+              check.float_ns,
+              ret == 0 ? "OK" : "FAIL");
+    radio_send_str(buffer, strlen(buffer) + 1);
+    return ret < 0 ? -E_INVALID : 0;
+}
+
+/*
+ * Show or set the interval of the fast oxygen control loop: control [seconds].
+ * 0 checks the valves only after every sample.
+ */
+int cmd_control(char *str)
+{
+    char buffer[40];
+    size_t size = sizeof(buffer);
+
+    if (!str) {
+        printk("Control interval: %i s\n", cfg.control_interval);
+        usnprintf(buffer, size, "%s %s %i", cfg.name, "control", cfg.control_interval);
+        radio_send_str(buffer, strlen(buffer) + 1);
+        return 0;
+    }
+    if (atoi(str) < 0 || atoi(str) > UINT16_MAX) {
+        return -E_INVALID;
+    }
+    cfg.control_interval = atoi(str);
+    printk("Control interval set to %i s\n", cfg.control_interval);
+    return 0;
+}
+
+/*
+ * Show the solenoid supply captured during the last pulse of a valve: pulse <valve>.
+ */
+int cmd_pulse(char *str)
+{
+    char buffer[40];
+    size_t size = sizeof(buffer);
+    struct valve_pulse_capture capture;
+    int valve_nr;
+
+    if (!str) {
+        return -E_INVALID;
+    }
+    valve_nr = atoi(str) - 1; /* The system counts from 0 */
+    if (valve_actuator_capture(valve_nr, &capture) < 0) {
+        return -E_INVALID;
+    }
+    printk("Valve %i charged %i mV, status %i\n", valve_nr + 1, capture.mv_charged, capture.status);
+    for (int i = 0; i < capture.n_samples; i++) {
+        printk("%6u us %5i mV\n", i * capture.interval_us, capture.mv[i]);
+    }
+    usnprintf(buffer,
+              size,
+              "%s %s %i %i %i %i",
+              cfg.name,
+              "pulse",
+              valve_nr + 1,
+              capture.status,
+              capture.mv_charged,
+              capture.n_samples > 0 ? capture.mv[capture.n_samples - 1] : 0);
+    radio_send_str(buffer, strlen(buffer) + 1);
+    return 0;
+}
+
+/*
+ * Show the GPS fix statistics or set how the GPS is kept between samples: gps [cold|standby].
+ */
+int cmd_gps(char *str)
+{
+    char buffer[60];
+    size_t size = sizeof(buffer);
+    struct gps_fix_stats stats;
+
+    if (str) {
+        if (!strcmp(str, "cold")) {
+            cfg.gps_mode = GPS_MODE_COLD;
+        } else if (!strcmp(str, "standby")) {
+            cfg.gps_mode = GPS_MODE_STANDBY;
+        } else {
+            return -E_INVALID;
+        }
+    }
+    gps_pa1010d_get_stats(&stats);
+    printk("GPS mode: %s, in standby: %s\n",
+           cfg.gps_mode == GPS_MODE_STANDBY ? "standby" : "cold",
+           gps_pa1010d_in_standby() ? "yes" : "no");
+    printk("Fixes %u, timeouts %u\n", stats.n_fixes, stats.n_timeouts);
+    printk("Time to fix %u ms, average %u ms, HDOP %.1f\n",
+           stats.last_time_to_fix_ms,
+           stats.average_time_to_fix_ms,
+           (double)stats.last_hdop);
+    printk("Next budget %u ms\n", stats.budget_ms);
+    usnprintf(buffer,
+              size,
+              "%s %s %i %u %u %u %.1f",
+              cfg.name,
+              "gps",
+              cfg.gps_mode,
+              stats.n_fixes,
+              stats.n_timeouts,
+              stats.average_time_to_fix_ms,
+              (double)stats.last_hdop);
+    radio_send_str(buffer, strlen(buffer) + 1);
+    return 0;
+}
+
+/*
+ * Check the NMEA parser with its test sentences and show the time per character.
+ */
+int cmd_nmeacheck(char *str)
+{
+    char buffer[60];
+    size_t size = sizeof(buffer);
+    struct nmea_check check;
+    int ret = nmea_parser_check(&check);
+
+    printk("%u sentences, %u checksum errors, %u failures: %s\n",
+           check.n_sentences,
+           check.n_checksum_errors,
+           check.n_failures,
+           ret == 0 ? "OK" : "FAIL");
+    printk("%u ns per character\n", check.ns_per_byte);
+    usnprintf(buffer,
+              size,
+              "%s %s %u %u %s",
+              cfg.name,
+              "nmeacheck",
+              check.n_failures,
+              check.ns_per_byte,
+              ret == 0 ? "OK" : "FAIL");
+    radio_send_str(buffer, strlen(buffer) + 1);
+    return ret < 0 ? -E_INVALID : 0;
+}
@@ -0,0 +1,393 @@
+/**
+ *  \file parsing_nmea.c
+ *  \brief Streaming parser of the NMEA sentences of the GPS
+ *
+ *  The parser is fed one character at a time as they arrive from the serial
+ *  port, nothing is buffered or copied. The numbers are accumulated in fixed
+ *  point while the characters of their field arrive, and the fields are
+ *  applied to the fix when the next comma arrives. A sentence is reported only
+ *  when its checksum matches, a corrupted sentence is dropped without touching
+ *  the fix of the caller.
+ *
+ *  The coordinates are converted from DDDMM.mmmmm to 1e-7 degrees with
+ *  integers only: the minutes in 1e-5 times 10^7 / (60 * 10^5) is times 5/3.
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+#include <string.h>
+#include "watchdog.h"
+#include "profiler.h"
+#include "nmea.h"
+
+#define NMEA_BENCH_ROUNDS   50
+#define GGA_EAST_WEST_FIELD 5 /* Last field of the position, counting the address */
+#define RMC_EAST_WEST_FIELD 6
+
+enum parser_state {
+    WAIT_START,
+    IN_FIELDS,
+    IN_CHECKSUM,
+};
+
+/*
+ * Start of a sentence, everything received before is discarded.
+ */
+static void start_sentence(struct nmea_parser *parser)
+{
+    parser->state = IN_FIELDS;
+    parser->checksum = 0;
+    parser->received_checksum = 0;
+    parser->checksum_digits = 0;
+    parser->field = 0;
+    parser->sentence = NMEA_NONE;
+    memset(&parser->number, 0, sizeof(parser->number));
+    memset(&parser->fix, 0, sizeof(parser->fix));
+    parser->fix.hdop = UINT16_MAX; /* Until the field arrives */
+}
+
+/*
+ * Add a character to the number of the current field.
+ */
+static void add_to_number(struct nmea_number *n, char c)
+{
+    if (n->length == 0) {
+        n->first = c;
+    }
+    if (n->length < UINT8_MAX) {
+        n->length++;
+    }
+    if (c == '.') {
+        n->in_fraction = 1;
+    } else if (c >= '0' && c <= '9') {
+        if (!n->in_fraction) {
+            n->integer = n->integer * 10 + (c - '0');
+        } else if (n->fraction_digits < NMEA_FRACTION_DIGITS) {
+            n->fraction = n->fraction * 10 + (c - '0');
+            n->fraction_digits++;
+        }
+    }
+}
+
+/*
+ * Decimals of a number in 10^-NMEA_FRACTION_DIGITS.
+ */
+static uint32_t fraction_of(const struct nmea_number *n)
+{
+    uint32_t fraction = n->fraction;
+
+    for (int i = n->fraction_digits; i < NMEA_FRACTION_DIGITS; i++) {
+        fraction *= 10;
+    }
+    return fraction;
+}
+
+/*
+ * DDDMM.mmmmm to 1e-7 degrees.
+ */
+static int32_t to_degrees_e7(const struct nmea_number *n)
+{
+    uint32_t degrees = n->integer / 100;
+    uint32_t minutes_e5 = (n->integer % 100) * 100000 + fraction_of(n);
+
+    return (int32_t)(degrees * 10000000 + (minutes_e5 * 5 + 1) / 3);
+}
+
+/*
+ * Sentence type from the address, the talker is not checked.
+ */
+static enum nmea_sentence sentence_of(const struct nmea_parser *parser)
+{
+    if (parser->number.length != NMEA_ADDRESS_SIZE) {
+        return NMEA_OTHER;
+    }
+    if (!memcmp(parser->address + 2, "GGA", 3)) {
+        return NMEA_GGA;
+    }
+    if (!memcmp(parser->address + 2, "RMC", 3)) {
+        return NMEA_RMC;
+    }
+    return NMEA_OTHER;
+}
+
+/*
+ * Latitude or longitude field, an empty one means there is no position.
+ */
+static void position_field(struct nmea_fix *fix, const struct nmea_number *n, int32_t *coordinate)
+{
+    if (n->length == 0) {
+        fix->has_position = 0;
+        return;
+    }
+    *coordinate = to_degrees_e7(n);
+}
+
+/*
+ * Apply the field just finished to the fix being received.
+ * GGA: time, latitude, N/S, longitude, E/W, quality, satellites, HDOP, ...
+ * RMC: time, status, latitude, N/S, longitude, E/W, ...
+ */
+static void end_field(struct nmea_parser *parser)
+{
+    const struct nmea_number *n = &parser->number;
+    struct nmea_fix *fix = &parser->fix;
+    int field = parser->field;
+
+    if (field == 0) {
+        parser->sentence = sentence_of(parser);
+        fix->has_position = 1;
+    } else if (field == 1 && parser->sentence != NMEA_OTHER) {
+        fix->utc_time = n->integer;
+    } else if (parser->sentence == NMEA_RMC) {
+        field--; /* The status moves the position one field */
+        if (field == 1) {
+            fix->valid = n->first == 'A';
+        }
+    }
+    if (parser->sentence == NMEA_GGA || parser->sentence == NMEA_RMC) {
+        switch (field) {
+        case 2:
+            position_field(fix, n, &fix->latitude);
+            break;
+        case 3:
+            if (n->length == 0) {
+                fix->has_position = 0;
+            } else if (n->first == 'S') {
+                fix->latitude = -fix->latitude;
+            }
+            break;
+        case 4:
+            position_field(fix, n, &fix->longitude);
+            break;
+        case 5:
+            if (n->length == 0) {
+                fix->has_position = 0;
+            } else if (n->first == 'W') {
+                fix->longitude = -fix->longitude;
+            }
+            break;
+        }
+    }
+    if (parser->sentence == NMEA_GGA) {
+        switch (field) {
+        case 6:
+            fix->quality = n->integer;
+            break;
+        case 7:
+            fix->satellites = n->integer;
+            break;
+        case 8:
+            fix->hdop = n->length > 0 ? n->integer * 100 + fraction_of(n) / 1000 : UINT16_MAX;
+            break;
+        }
+    }
+    parser->field++;
+    memset(&parser->number, 0, sizeof(parser->number));
+}
+
+/*
+ * Give the fields of the sentence to the caller, only the ones of its type.
+ * A sentence cut before the end of the position has no position.
+ */
+static void commit_fix(const struct nmea_parser *parser, struct nmea_fix *fix)
+{
+    const struct nmea_fix *f = &parser->fix;
+    int east_west = parser->sentence == NMEA_RMC ? RMC_EAST_WEST_FIELD : GGA_EAST_WEST_FIELD;
+
+    if (parser->sentence != NMEA_GGA && parser->sentence != NMEA_RMC) {
+        return;
+    }
+    fix->utc_time = f->utc_time;
+    fix->has_position = f->has_position && parser->field > east_west;
+    fix->latitude = f->latitude;
+    fix->longitude = f->longitude;
+    if (parser->sentence == NMEA_GGA) {
+        fix->quality = f->quality;
+        fix->satellites = f->satellites;
+        fix->hdop = f->hdop;
+    } else {
+        fix->valid = f->valid;
+    }
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+/**
+ * Initialize a parser.
+ */
+void nmea_parser_init(struct nmea_parser *parser)
+{
+    memset(parser, 0, sizeof(*parser));
+    parser->state = WAIT_START;
+}
+
+/**
+ * Feed a character received from the GPS.
+ * @param parser The parser of the port
+ * @param c The character
+ * @param fix Updated with the fields of the sentence when it completes
+ * @return The sentence completed with a valid checksum, NMEA_NONE otherwise
+ */
+enum nmea_sentence nmea_parser_feed(struct nmea_parser *parser, char c, struct nmea_fix *fix)
+{
+    int digit;
+
+    if (c == '$') {
+        start_sentence(parser);
+        return NMEA_NONE;
+    }
+    switch (parser->state) {
+    case IN_FIELDS:
+        if (c == '*') {
+            end_field(parser);
+            parser->state = IN_CHECKSUM;
+        } else if (c == '\r' || c == '\n') {
+            parser->state = WAIT_START; /* The GPS always sends the checksum */
+        } else {
+            parser->checksum ^= c;
+            if (c == ',') {
+                end_field(parser);
+            } else {
+                if (parser->field == 0 && parser->number.length < NMEA_ADDRESS_SIZE) {
+                    parser->address[parser->number.length] = c;
+                }
+                add_to_number(&parser->number, c);
+            }
+        }
+        break;
+    case IN_CHECKSUM:
+        digit = hex_value(c);
+        if (digit < 0) {
+            parser->state = WAIT_START;
+            break;
+        }
+        parser->received_checksum = (parser->received_checksum << 4) | digit;
+        if (++parser->checksum_digits < 2) {
+            break;
+        }
+        parser->state = WAIT_START;
+        if (parser->received_checksum != parser->checksum) {
+            parser->n_checksum_errors++;
+            break;
+        }
+        parser->n_sentences++;
+        commit_fix(parser, fix);
+        return parser->sentence;
+    default:
+        break;
+    }
+    return NMEA_NONE;
+}
+
+/*
+ * Sentences of the self test, with the results expected
+ */
+struct nmea_test {
+    const char *text;
+    enum nmea_sentence sentence;
+    int32_t latitude;
+    int32_t longitude;
+    uint16_t hdop;
+    uint8_t valid;
+    uint8_t has_position;
+};
+
+static const struct nmea_test corpus[] = {
+    {"$GNGGA,123519.000,4807.0380,N,01131.0000,E,1,08,0.94,545.4,M,46.9,M,,*73\r\n",
+     NMEA_GGA, 481173000, 115166667, 94, 0, 1},
+    {"$GNRMC,123519.000,A,4807.0380,N,01131.0000,E,0.02,31.66,230394,,,A*40\r\n",
+     NMEA_RMC, 481173000, 115166667, 0, 1, 1},
+    {"$GPRMC,081836.000,A,3751.6500,S,14507.3600,W,0.00,0.00,130998,,,A*6E\r\n",
+     NMEA_RMC, -378608333, -1451226667, 0, 1, 1},
+    {"$GNGGA,101010.000,4130.12345,S,07258.54321,W,2,11,1.25,10.0,M,20.0,M,,*44\r\n",
+     NMEA_GGA, -415020575, -729757202, 125, 0, 1},
+    {"$GNRMC,000012.800,V,,,,,0.00,0.00,060180,,,N*57\r\n", NMEA_RMC, 0, 0, 0, 0, 0},
+    {"$GNGGA,000012.800,,,,,0,00,,,M,,M,,*6D\r\n", NMEA_GGA, 0, 0, UINT16_MAX, 0, 0},
+    {"$PMTK001,161,3*36\r\n", NMEA_OTHER, 0, 0, 0, 0, 0},
+    /* A digit changed, the checksum does not match */
+    {"$GNRMC,123519.000,A,4807.0380,N,01131.0000,E,0.02,31.66,230394,,,A*41\r\n", NMEA_NONE, 0, 0, 0, 0, 0},
+    {"$GNRMC,123519.000,A,4807.0380,N,01132.0000,E,0.02,31.66,230394,,,A*40\r\n", NMEA_NONE, 0, 0, 0, 0, 0},
+    /* Cut by the start of the next sentence */
+    {"$GNRMC,123519.000,A,4807.03$PMTK001,161,3*36\r\n", NMEA_OTHER, 0, 0, 0, 0, 0},
+    {"$GNGGA,123519.000,4807.0380,N\r\n", NMEA_NONE, 0, 0, 0, 0, 0},
+    /* Short sentences with a valid checksum, the missing fields are not used */
+    {"$GNRMC,123519.000,A,4807.0380,N,01131.0000*57\r\n", NMEA_RMC, 0, 0, 0, 1, 0},
+    {"$GNGGA,123519.000,4807.0380,N,01131.0000,E,1,08*77\r\n", NMEA_GGA, 481173000, 115166667, UINT16_MAX, 0, 1},
+};
+
+/*
+ * Check the result of a sentence of the corpus.
+ */
+static int test_ok(const struct nmea_test *t, enum nmea_sentence sentence, const struct nmea_fix *fix)
+{
+    if (sentence != t->sentence) {
+        return 0;
+    }
+    if (sentence == NMEA_GGA) {
+        return fix->hdop == t->hdop && fix->has_position == t->has_position &&
+               (!fix->has_position || (fix->latitude == t->latitude && fix->longitude == t->longitude));
+    }
+    if (sentence == NMEA_RMC) {
+        return fix->valid == t->valid && fix->has_position == t->has_position &&
+               (!fix->has_position || (fix->latitude == t->latitude && fix->longitude == t->longitude));
+    }
+    return 1;
+}
+
+/**
+ * Parse the test corpus, check the results and time the parser.
+ * @return 0 if all the sentences gave the expected results, -1 otherwise
+ */
+int nmea_parser_check(struct nmea_check *check)
+{
+    struct nmea_parser parser;
+    struct nmea_fix fix;
+    struct profile_mark mark;
+    uint32_t n_bytes = 0;
+    uint32_t elapsed_us;
+
+    nmea_parser_init(&parser);
+    check->n_failures = 0;
+    for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++) {
+        enum nmea_sentence sentence = NMEA_NONE;
+
+        memset(&fix, 0, sizeof(fix));
+        for (const char *p = corpus[i].text; *p != '\0'; p++) {
+            enum nmea_sentence s = nmea_parser_feed(&parser, *p, &fix);
+
+            if (s != NMEA_NONE) {
+                sentence = s;
+            }
+        }
+        if (!test_ok(&corpus[i], sentence, &fix)) {
+            check->n_failures++;
+        }
+    }
+    check->n_sentences = parser.n_sentences;
+    check->n_checksum_errors = parser.n_checksum_errors;
+    /* The same corpus, timed */
+    mark = profiler_start();
+    for (int round = 0; round < NMEA_BENCH_ROUNDS; round++) {
+        for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++) {
+            for (const char *p = corpus[i].text; *p != '\0'; p++) {
+                nmea_parser_feed(&parser, *p, &fix);
+                n_bytes++;
+            }
+        }
+        watchdog_reset();
+    }
+    elapsed_us = profiler_elapsed_us(mark);
+    check->ns_per_byte = (uint64_t)elapsed_us * 1000 / n_bytes;
+    return check->n_failures == 0 ? 0 : -1;
+}
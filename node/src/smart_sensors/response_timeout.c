@@ -0,0 +1,74 @@
+/**
+ *  \file response_timeout.c
+ *  \brief Response timeout learned from the latency of a sensor
+ *
+ *  The timeout is the smoothed latency plus RESPONSE_TIMEOUT_K times its
+ *  smoothed deviation, clamped between RESPONSE_TIMEOUT_MIN_MS and the maximum
+ *  given by the caller (the worst case of the datasheet). Until there are
+ *  RESPONSE_TIMEOUT_MIN_SAMPLES responses the maximum is used. Every expired
+ *  wait doubles the deviation, so a sensor that became slower gets back to the
+ *  maximum in a few tries.
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+#include <string.h>
+#include "defaults.h"
+#include "response_timeout.h"
+
+void response_timeout_init(struct response_timeout *rt)
+{
+    memset(rt, 0, sizeof(*rt));
+}
+
+/**
+ * Add the latency of a response, ms.
+ */
+void response_timeout_update(struct response_timeout *rt, uint32_t latency_ms)
+{
+    int32_t error;
+
+    if (rt->samples == 0) {
+        rt->srtt_x8 = latency_ms << 3;
+        rt->rttvar_x4 = latency_ms << 1; /* Half the latency */
+    } else {
+        error = (int32_t)latency_ms - (int32_t)(rt->srtt_x8 >> 3);
+        rt->srtt_x8 += error; /* srtt += error / 8 */
+        if (error < 0) {
+            error = -error;
+        }
+        rt->rttvar_x4 += error - (int32_t)(rt->rttvar_x4 >> 2); /* rttvar += (|error| - rttvar) / 4 */
+    }
+    if (rt->samples < UINT16_MAX) {
+        rt->samples++;
+    }
+}
+
+/**
+ * The sensor did not answer before the timeout.
+ */
+void response_timeout_expired(struct response_timeout *rt)
+{
+    if (rt->rttvar_x4 < (UINT32_MAX >> 1)) {
+        rt->rttvar_x4 = rt->rttvar_x4 ? rt->rttvar_x4 << 1 : 4;
+    }
+}
+
+/**
+ * Time to wait for the next response, ms.
+ */
+uint32_t response_timeout_get(const struct response_timeout *rt, uint32_t max_ms)
+{
+    uint32_t timeout;
+
+    if (rt->samples < RESPONSE_TIMEOUT_MIN_SAMPLES) {
+        return max_ms;
+    }
+    timeout = (rt->srtt_x8 >> 3) + RESPONSE_TIMEOUT_K * (rt->rttvar_x4 >> 2);
+    if (timeout < RESPONSE_TIMEOUT_MIN_MS) {
+        timeout = RESPONSE_TIMEOUT_MIN_MS;
+    }
+    if (timeout > max_ms) {
+        timeout = max_ms;
+    }
+    return timeout;
+}
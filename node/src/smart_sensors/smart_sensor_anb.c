@@ -38,14 +38,12 @@ enum anb_sensor_type {
 /*
  *Driver function prototypes
  */
-static int max_sensors(void);                                      /*Maximum number of sensors for this driver*/
 static const char *name(void);                                     /*Name of the driver*/
 static int init_driver(void);                                      /*Initialize the driver*/
 static int finish_driver(void);                                    /*Finish the operations with the driver*/
 static int detect(int sensor_number, struct smart_sensor *sensor); /*Detect a sensor*/
 static int prepare(struct smart_sensor *sensor);                   /*Prepare the sensor*/
 static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m); /*Acquire measurement register*/
-static int needs_external_voltage(void);
 
 /*
  *Local prototypes
@@ -62,23 +60,14 @@ static void turn_off_sensor(struct smart_sensor *sensor);
  *This structure keeps a list of all the functions a smart sensor can have.
  */
 const struct smart_sensor_driver smart_sensor_driver_anb = {
-    .max_sensors = max_sensors,
     .init_driver = init_driver,
     .finish_driver = finish_driver,
     .detect = detect,
     .prepare = prepare,
     .acquire = acquire,
     .name = name,
-    .needs_external_voltage = needs_external_voltage,
 };
-
-/*
- *Get the maximum number of sensors of this type this driver can handle.
- */
-static int max_sensors(void)
-{
-    return MAX_SENSORS;
-}
+SMART_SENSOR_DRIVER_REGISTER(smart_sensor_driver_anb, ANBSENSORS, MAX_SENSORS, 1, 0);
 
 /*
  *get the name of the driver.
@@ -108,9 +97,9 @@ static void turn_off_sensor(struct smart_sensor *sensor)
 {
     struct modbus_frame f;
 
-    watchdog_disable();
+    watchdog_expect(1000);
     sleep_microseconds(1000000);
-    watchdog_init();
+    watchdog_reset();
 
     prepare_modbus_frame(&f, sensor, MODBUS_WRITE_SINGLE_COIL, 0x00, 0x00);
     modbus_query(UART_SMART_SENSOR, &f);
@@ -122,9 +111,9 @@ static int prepare(struct smart_sensor *sensor)
     struct modbus_frame f;
     int response_status;
 
-    watchdog_disable();
+    watchdog_expect(1000);
     sleep_microseconds(1000000);
-    watchdog_init();
+    watchdog_reset();
 
     prepare_modbus_frame(&f, sensor, MODBUS_WRITE_SINGLE_COIL, 0x00, 0x04);
     modbus_query(UART_SMART_SENSOR, &f);
@@ -283,9 +272,9 @@ static int get_parameter(float *param, struct smart_sensor *sensor, struct measu
     int rc;
     struct modbus_frame f;
 
-    watchdog_disable();
+    watchdog_expect(1000);
     sleep_microseconds(1000000);
-    watchdog_init();
+    watchdog_reset();
 
     prepare_modbus_frame(&f, sensor, MODBUS_READ_HOLDING_REGISTERS, reg, 2);
     modbus_query(UART_SMART_SENSOR, &f);
@@ -318,9 +307,9 @@ static int get_parameter_status(int *param, struct smart_sensor *sensor, struct
      *
      */
 
-    watchdog_disable();
+    watchdog_expect(1000);
     sleep_microseconds(1000000);
-    watchdog_init();
+    watchdog_reset();
 
     prepare_modbus_frame(&f, sensor, MODBUS_READ_HOLDING_REGISTERS, reg, 1);
     modbus_query(UART_SMART_SENSOR, &f);
@@ -334,8 +323,3 @@ static int get_parameter_status(int *param, struct smart_sensor *sensor, struct
     }
     return 1;
 }
-
-static int needs_external_voltage(void)
-{
-    return 1;
-}
@@ -45,21 +45,18 @@ static const struct device *uart_dev = DEVICE_DT_GET(UART_DEVICE_NODE);
 /**
  * Driver function prototypes
  */
-static int max_sensors(void);                                      /* Maximum number of sensors for this driver */
 static const char *name(void);                                     /* Name of the driver */
 static int init_driver(void);                                      /* Initialize the driver */
 static int finish_driver(void);                                    /* Finish the operations with the driver */
 static int detect(int sensor_number, struct smart_sensor *sensor); /* Detect a sensor */
 static int prepare(struct smart_sensor *sensor);                   /* Prepare the sensor */
 static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m);
-static int needs_external_voltage(void);
 
 /**
  * Smart sensor driver structure for the Maxbotix range sensors
  * This structure keeps a list of all the functions a smart sensor can have.
  */
 const struct smart_sensor_driver smart_sensor_driver_aquadopp_nortek = {
-    .max_sensors = max_sensors,
     .init_driver = init_driver,
     .finish_driver = finish_driver,
     .detect = detect,
@@ -70,8 +67,8 @@ const struct smart_sensor_driver smart_sensor_driver_aquadopp_nortek = {
     .acquire = acquire,
     .pass_command = NULL,
     .name = name,
-    .needs_external_voltage = needs_external_voltage,
 };
+SMART_SENSOR_DRIVER_REGISTER(smart_sensor_driver_aquadopp_nortek, AQUADOPP, MAX_SENSORS, 0, 0);
 
 /*
  * Local prototypes
@@ -79,14 +76,6 @@ const struct smart_sensor_driver smart_sensor_driver_aquadopp_nortek = {
 int aquadopp_sensor_gets_with_timeout(char *response, int size, uint32_t timeout);
 /* static int adcp_sensor_gets(char *response, int size); */
 
-/*
- * Get the maximum number of sensors of this type this driver can handle
- */
-static int max_sensors(void)
-{
-    return MAX_SENSORS;
-}
-
 /**
  * Get the name of the driver.
  */
@@ -202,7 +191,7 @@ static int8_t request_current_profiler(struct measurement *measurement, int sens
     rs485_transmit(UART_SMART_SENSOR);
     smart_sensor_send_command("AD\r", 3);
     sleep_microseconds(150000); /* delay 150ms */
-    watchdog_reset();
+    watchdog_expect(100000);
     serial_flush(UART_SMART_SENSOR);
     sleep_microseconds(100000000);
     count_receive = aquadopp_sensor_gets_with_timeout(response, BUFFER_RECEP_ADCP, 40000);
@@ -309,8 +298,3 @@ int acquire(int tries, struct smart_sensor *sensor, struct measurement *measurem
     }
     return 0;
 }
-
-static int needs_external_voltage(void)
-{
-    return 0;
-}
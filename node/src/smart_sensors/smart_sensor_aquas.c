@@ -25,7 +25,6 @@
 /**
  * Driver function prototypes
  */
-static int max_sensors(void);                                      /* Maximum number of sensors for this driver */
 static int init_driver(void);                                      /* Initialize the driver */
 static int finish_driver(void);                                    /* Finish the operations with the driver */
 static int detect(int sensor_number, struct smart_sensor *sensor); /* Detect a sensor */
@@ -41,7 +40,6 @@ static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m
  * This structure keeps a list of all the functions a smart sensor can have.
  */
 const struct smart_sensor_driver smart_sensor_driver_aquas = {
-    .max_sensors = max_sensors,
     .init_driver = init_driver,
     .finish_driver = finish_driver,
     .detect = detect,
@@ -52,6 +50,7 @@ const struct smart_sensor_driver smart_sensor_driver_aquas = {
     .acquire = acquire,
     .pass_command = NULL,
 };
+SMART_SENSOR_DRIVER_REGISTER(smart_sensor_driver_aquas, AQUAS, MAX_N_SENSORS, 0, 0);
 
 /*
  * Local prototypes
@@ -66,14 +65,6 @@ static int aquas_sensor_clean(int slave);
 struct modbus modbus_response, modbus_request;
 uint16_t modbus_data_buffer[MAX_RESPONSE_SIZE];
 
-/*
- * Get the maximum number of sensors of this type this driver can handle
- */
-static int max_sensors(void)
-{
-    return MAX_N_SENSORS;
-}
-
 /*
  * Prepare the smart-sensors to start a measurement, this means turning them on and
  * enabling the serial port to communicate with them
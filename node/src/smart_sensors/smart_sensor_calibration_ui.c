@@ -35,20 +35,20 @@ int calibrate_sensor(int sensor_nr);
 void display_no_sensors_to_calibrate(void)
 {
     display_printf("No hay sensores que puedan calibrarse\n");
-    display_flush();
+    display_flush_changed();
 }
 
 void display_do_you_want_to_calibrate_sensor(int sensor)
 {
     display_printf("Sensor %i\npuede calibrarse\n", sensor);
     display_printf("Quiere calibrarlo\n");
-    display_flush();
+    display_flush_changed();
 }
 
 void display_sensor_not_calibrated(void)
 {
     display_printf("No calibrado\n");
-    display_flush();
+    display_flush_changed();
 }
 
 void display_calibration_message(void)
@@ -68,14 +68,14 @@ void display_waiting_measurement(struct measurement *measurement, int count)
     display_calibration_message();
     display_all_measurements(1, measurement, 1);
     display_printf("\nTiempo restante: %i\n", count);
-    display_flush();
+    display_flush_changed();
 }
 
 void display_calibration_running(void)
 {
     display_calibration_message();
     display_printf("Calibrando...\n");
-    display_flush();
+    display_flush_changed();
 }
 
 void display_calibration_status(int status)
@@ -85,7 +85,7 @@ void display_calibration_status(int status)
     } else {
         display_printf("Calibracion OK\n");
     }
-    display_flush();
+    display_flush_changed();
 }
 
 void normal_delay(void)
@@ -145,7 +145,7 @@ int calibrate_sensor(int sensor_nr)
     int must_calibrate = 0;
 
     display_calibrating_sensor_nr(sensor_nr);
-    display_flush();
+    display_flush_changed();
     turn_on_smart_sensor(0);
     smart_sensor_init_serial_port();
     const struct smart_sensor_driver *driver = driver_for_sensor(sensor_nr);
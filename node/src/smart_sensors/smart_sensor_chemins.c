@@ -27,14 +27,12 @@
 /**
  * Driver function prototypes
  */
-static int max_sensors(void);                                      /* Maximum number of sensors for this driver */
 static const char *name(void);                                     /* Name of the driver */
 static int init_driver(void);                                      /* Initialize the driver */
 static int finish_driver(void);                                    /* Finish the operations with the driver */
 static int detect(int sensor_number, struct smart_sensor *sensor); /* Detect a sensor */
 static int prepare(struct smart_sensor *sensor);                   /* Prepare the sensor */
 static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m); /* Acquire data of the sensor */
-static int needs_external_voltage(void);
 
 /*
  * Local prototypes
@@ -48,7 +46,6 @@ static int modbus_request_measurement(struct smart_sensor *sensor, struct measur
  * This structure keeps a list of all the functions a smart sensor can have.
  */
 const struct smart_sensor_driver smart_sensor_driver_chemins = {
-    .max_sensors = max_sensors,
     .init_driver = init_driver,
     .finish_driver = finish_driver,
     .detect = detect,
@@ -59,16 +56,8 @@ const struct smart_sensor_driver smart_sensor_driver_chemins = {
     .finish = NULL,
     .calibrate_zero = NULL,
     .calibrate_full = NULL,
-    .needs_external_voltage = needs_external_voltage,
 };
-
-/*
- * Get the maximum number of sensors of this type this driver can handle
- */
-static int max_sensors(void)
-{
-    return MAX_SENSORS;
-}
+SMART_SENSOR_DRIVER_REGISTER(smart_sensor_driver_chemins, CHEMINS, MAX_SENSORS, 1, 0);
 
 /**
  * Get the name of the driver.
@@ -247,8 +236,3 @@ static int modbus_request_measurement(struct smart_sensor *sensor, struct measur
     }
     return 1;
 }
-
-static int needs_external_voltage(void)
-{
-    return 1;
-}
@@ -24,6 +24,9 @@
 static uint8_t rx_buffer[SERIAL_BUFFER_SIZE];
 static uint8_t tx_buffer[SERIAL_BUFFER_SIZE];
 
+/* Response timeout of the sensor and command being sent, NULL if none */
+static struct response_timeout *active_timeout;
+
 /**
  * Initialize the serial port used to communicate with the smart sensor
  */
@@ -34,6 +37,7 @@ void smart_sensor_init_serial_port(void)
 
 /* TODO Use the same timeout mechanism as smart_sensor_receive_data */
 #define RESPONSE_TIMEOUT 500000 /* To try to get an answer from the sensor */
+#define RECEIVE_TIMEOUT_MS 1000  /* Worst case response time for smart_sensor_receive_data */
 
 /**
  * Get a string from the sensors UART. Return immediately after receiving a
@@ -48,8 +52,8 @@ int smart_sensor_get_response(char *response, uint8_t size)
     int n = 0;
     int c;
 
+    watchdog_reset();
     while (1) {
-        watchdog_disable();
         c = serial_getchar(UART_SMART_SENSOR);
         if (c < 0) {
             if (++t > RESPONSE_TIMEOUT) {
@@ -67,10 +71,42 @@ int smart_sensor_get_response(char *response, uint8_t size)
         }
     }
     *response = '\0';
-    watchdog_init();
+    watchdog_reset();
     return n;
 }
 
+void smart_sensor_set_active(struct smart_sensor *sensor, enum sensor_command command)
+{
+    if (sensor == NULL) {
+        active_timeout = NULL;
+    } else {
+        active_timeout = &(sensor->response_timeouts[command]);
+    }
+}
+
+uint32_t smart_sensor_response_timeout(uint32_t max_ms)
+{
+    if (active_timeout == NULL) {
+        return max_ms;
+    }
+    return response_timeout_get(active_timeout, max_ms);
+}
+
+void smart_sensor_response_received(uint32_t latency_ms)
+{
+    if (active_timeout != NULL) {
+        response_timeout_update(active_timeout, latency_ms);
+    }
+}
+
+void smart_sensor_response_timedout(uint32_t timeout_ms, uint32_t max_ms)
+{
+    /* After waiting the worst case the sensor is not answering at all */
+    if (active_timeout != NULL && timeout_ms < max_ms) {
+        response_timeout_expired(active_timeout);
+    }
+}
+
 /**
  * Get as much as possible data from a sensor until the amount specified
  * is full or the sensor stopped sending data.
@@ -82,6 +118,7 @@ int smart_sensor_receive_data(char *response, uint8_t size)
 {
     int n = 0;
     int c;
+    uint32_t first_byte_timeout = smart_sensor_response_timeout(RECEIVE_TIMEOUT_MS);
 
     int64_t ms_start = get_uptime_ms();
 
@@ -89,11 +126,14 @@ int smart_sensor_receive_data(char *response, uint8_t size)
     while (1) {
         c = serial_getchar(UART_SMART_SENSOR);
         if (c < 0) {
-            if (ms_elapsed(&ms_start) > 1000) {
+            if (ms_elapsed(&ms_start) > (n == 0 ? first_byte_timeout : RECEIVE_TIMEOUT_MS)) {
                 DEBUG("--Sensor timeout\n");
                 break;
             }
         } else {
+            if (n == 0) {
+                smart_sensor_response_received(ms_elapsed(&ms_start));
+            }
             *response++ = c;
             ms_start = get_uptime_ms();
             n++;
@@ -102,6 +142,9 @@ int smart_sensor_receive_data(char *response, uint8_t size)
             }
         }
     }
+    if (n == 0) {
+        smart_sensor_response_timedout(first_byte_timeout, RECEIVE_TIMEOUT_MS);
+    }
     DEBUG("Received: %i\n", n);
     *response = '\0';
     return n;
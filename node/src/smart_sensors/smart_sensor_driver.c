@@ -14,30 +14,15 @@
 #include "configuration.h"
 #include "shell_commands.h"
 
-const struct smart_sensor_driver *sensor_driver[] = {
-    [NORTEK] = NULL,
-    [LUFFT] = NULL,
-    [VAISALA] = NULL,
-    [INNOVEX] = &smart_sensor_driver_innovex,
-    [MAXBOTIX] = NULL,
-    [PONSEL] = NULL,
-    [TEXAS_INSTRUMENTS] = NULL,
-    [YOSEMITECH] = NULL,
-    [AQUAS] = NULL,
-    [YSI] = NULL,
-    [HUIZHONG] = NULL,
-    [TELEDYNE_ISCO] = NULL,
-    [ANBSENSORS] = NULL,
-    [TDS100] = NULL,
-    [GPS] = NULL,
-    [CHEMINS] = NULL,
-    [SEABIRD] = NULL,
-    [JIANGSU] = NULL,
-    [ACCONEER] = NULL,
-    [AQUADOPP] = NULL,
-    [FLOWQUEST] = NULL,
-    [WITMOTION] = NULL,
-};
+/*
+ * Entries of the enabled drivers, indexed by manufacturer
+ */
+static const struct smart_sensor_driver_entry *enabled_driver[SENSOR_MANUFACTURER_END];
+
+/*
+ * Derived from the enabled drivers, updated only when they change
+ */
+static uint8_t external_voltage_needed;
 
 /**
  * Get the driver for the specified manufacturer
@@ -45,56 +30,88 @@ const struct smart_sensor_driver *sensor_driver[] = {
  * @return The driver for the sensor or NULL if there is no driver
  */
 const struct smart_sensor_driver *driver_for_manufacturer(enum sensor_manufacturer manufacturer)
+{
+    const struct smart_sensor_driver_entry *entry = driver_entry_for_manufacturer(manufacturer);
+
+    return entry != NULL ? entry->driver : NULL;
+}
+
+const struct smart_sensor_driver_entry *driver_entry_for_manufacturer(enum sensor_manufacturer manufacturer)
 {
     if (manufacturer > MANUFACTURER_NONE && manufacturer < SENSOR_MANUFACTURER_END) {
-        return sensor_driver[manufacturer];
+        return enabled_driver[manufacturer];
     }
     return NULL;
 }
 
-void sensor_switch(enum sensor_manufacturer manufacturer, int state)
+/*
+ * Find the registered driver of a manufacturer, enabled or not.
+ */
+static const struct smart_sensor_driver_entry *registered_driver(enum sensor_manufacturer manufacturer)
+{
+    STRUCT_SECTION_FOREACH(smart_sensor_driver_entry, entry)
+    {
+        if (entry->manufacturer == manufacturer) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void update_driver_flags(void)
 {
-    static const struct smart_sensor_driver *const sensor_driver_directions[] = {
-        [INNOVEX] = &smart_sensor_driver_innovex,
-        [NORTEK] = &smart_sensor_driver_signature_nortek,
-        [FLOWQUEST] = &smart_sensor_driver_flowquest,
-        [PONSEL] = &smart_sensor_driver_ponsel,
-        [YOSEMITECH] = &smart_sensor_driver_yosemitech,
-        [YSI] = &smart_sensor_driver_ysi,
-        [VAISALA] = &smart_sensor_driver_vaisala,
-        [TDS100] = &smart_sensor_driver_tds100,
-        [HUIZHONG] = &smart_sensor_driver_huizhong,
-        [TELEDYNE_ISCO] = &smart_sensor_driver_signature_flow,
-        [ANBSENSORS] = &smart_sensor_driver_anb,
-        [SEABIRD] = &smart_sensor_driver_seabird,
-        [CHEMINS] = &smart_sensor_driver_chemins,
-        [JIANGSU] = &smart_sensor_driver_jiangsu_flow,
-        [ACCONEER] = &smart_sensor_driver_xm126,
-        [AQUADOPP] = &smart_sensor_driver_aquadopp_nortek,
-        [WITMOTION] = &smart_sensor_driver_wtvb01};
+    external_voltage_needed = 0;
+    for (int i = MANUFACTURER_NONE + 1; i < SENSOR_MANUFACTURER_END; i++) {
+        if (enabled_driver[i] != NULL && enabled_driver[i]->needs_external_voltage) {
+            external_voltage_needed = 1;
+        }
+    }
+}
+
+static void enable_driver(enum sensor_manufacturer manufacturer, int enable)
+{
+    const struct smart_sensor_driver_entry *entry = enable ? registered_driver(manufacturer) : NULL;
 
+    enabled_driver[manufacturer] = entry;
+    if (entry != NULL) {
+        sen_drv.enabled_manufacturers |= (1UL << manufacturer);
+    } else {
+        sen_drv.enabled_manufacturers &= ~(1UL << manufacturer);
+    }
+}
+
+void sensor_switch(enum sensor_manufacturer manufacturer, int state)
+{
+    if (manufacturer <= MANUFACTURER_NONE || manufacturer >= SENSOR_MANUFACTURER_END) {
+        return;
+    }
     if (state == ACTIVATE) {
-        sensor_driver[manufacturer] = sensor_driver_directions[manufacturer];
-        if (manufacturer == INNOVEX && sensor_driver[NORTEK] != NULL) {
-            sensor_driver[NORTEK] = NULL;
-            sen_drv.sensor_driver[NORTEK] = sensor_driver[NORTEK];
+        enable_driver(manufacturer, 1);
+        if (manufacturer == INNOVEX && enabled_driver[NORTEK] != NULL) {
+            enable_driver(NORTEK, 0);
             printk("nortek deactivated.\n");
         } else if (manufacturer == NORTEK) {
-            if (sensor_driver[INNOVEX] != NULL) {
-                sensor_driver[INNOVEX] = NULL;
-                sen_drv.sensor_driver[INNOVEX] = sensor_driver[INNOVEX];
+            if (enabled_driver[INNOVEX] != NULL) {
+                enable_driver(INNOVEX, 0);
                 printk("innovex deactivated.\n");
             }
         }
     } else {
-        sensor_driver[manufacturer] = NULL;
+        enable_driver(manufacturer, 0);
     }
-    sen_drv.sensor_driver[manufacturer] = sensor_driver[manufacturer];
+    update_driver_flags();
 }
 
 void configure_sensor_drivers(void)
 {
-    for (int i = 0; i < SENSOR_MANUFACTURER_END; i++) {
-        sensor_driver[i] = sen_drv.sensor_driver[i];
+    for (int i = MANUFACTURER_NONE + 1; i < SENSOR_MANUFACTURER_END; i++) {
+        /* IDs without a driver in this firmware are dropped */
+        enable_driver(i, (sen_drv.enabled_manufacturers & (1UL << i)) != 0);
     }
+    update_driver_flags();
+}
+
+int smart_sensors_detect_voltage(void)
+{
+    return external_voltage_needed;
 }
@@ -42,14 +42,12 @@
 /**
  * Driver function prototypes
  */
-static int max_sensors(void);                                      /* Maximum number of sensors for this driver */
 static const char *name(void);                                     /* Name of the driver */
 static int init_driver(void);                                      /* Initialize the driver */
 static int finish_driver(void);                                    /* Finish the operations with the driver */
 static int detect(int sensor_number, struct smart_sensor *sensor); /* Detect a sensor */
 static int prepare(struct smart_sensor *sensor);                   /* Prepare the sensor */
 static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m);
-static int needs_external_voltage(void);
 static int filter_invalid_chars; /*Global variable to enable or disable filtering*/
 
 /**
@@ -57,7 +55,6 @@ static int filter_invalid_chars; /*Global variable to enable or disable filterin
  * This structure keeps a list of all the functions a smart sensor can have.
  */
 const struct smart_sensor_driver smart_sensor_driver_flowquest = {
-    .max_sensors = max_sensors,
     .init_driver = init_driver,
     .finish_driver = finish_driver,
     .detect = detect,
@@ -68,8 +65,8 @@ const struct smart_sensor_driver smart_sensor_driver_flowquest = {
     .acquire = acquire,
     .pass_command = NULL,
     .name = name,
-    .needs_external_voltage = needs_external_voltage,
 };
+SMART_SENSOR_DRIVER_REGISTER(smart_sensor_driver_flowquest, FLOWQUEST, MAX_N_SENSORS, 1, 0);
 
 /* Local prototypes */
 static int send_command(const char *command, uint8_t *response, size_t size, uint32_t timeout);
@@ -99,14 +96,6 @@ const uint8_t *find_pattern(const uint8_t *haystack, size_t haystack_len, const
     return NULL;
 }
 
-/*
- * Get the maximum number of sensors of this type this driver can handle
- */
-static int max_sensors(void)
-{
-    return MAX_N_SENSORS;
-}
-
 /**
  * Get the name of the driver.
  */
@@ -495,7 +484,3 @@ static int gets_with_timeout(uint8_t *response, int size, uint32_t timeout)
     response[n] = '\0';
     return n;
 }
-static int needs_external_voltage(void)
-{
-    return 1;
-}
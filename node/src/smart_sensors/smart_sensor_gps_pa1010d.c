@@ -15,6 +15,8 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <math.h>
+#include <zephyr/sys/util.h>
 #include "bsp-config.h"
 #include "measurement.h"
 #include "smart_sensor.h"
@@ -29,6 +31,8 @@
 #include "configuration.h"
 #include "watchdog.h"
 #include "zephyr/sys_clock.h"
+#include "gps_pa1010d.h"
+#include "nmea.h"
 /* #include "nortek_signature.h" */
 /* #include "adcp_compression.h" */
 
@@ -105,15 +109,12 @@
 #define PGCMD_NOANTENNA "$PGCMD,33,0*6D\r\n" /*/< don't show antenna status messages */
 
 /* How many times we try to detect a sensor */
-#define DETECTION_TRIES   6
-#define MAX_SENSORS       1
-#define MAX_RESPONSE_SIZE 100 /* Maximum size for a response from the sensors */
-#define BUFFER_RECEP_ADCP 100
+#define DETECTION_TRIES 6
+#define MAX_SENSORS     1
 
 /**
  * Driver function prototypes
  */
-static int max_sensors(void);                                      /* Maximum number of sensors for this driver */
 static const char *name(void);                                     /* Name of the driver */
 static int init_driver(void);                                      /* Initialize the driver */
 static int finish_driver(void);                                    /* Finish the operations with the driver */
@@ -121,13 +122,11 @@ static int detect(int sensor_number, struct smart_sensor *sensor); /* Detect a s
 static int prepare(struct smart_sensor *sensor);                   /* Prepare the sensor */
 static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m);
 
-char response_adcp[100];
 /**
  * Smart sensor driver structure for the Maxbotix range sensors
  * This structure keeps a list of all the functions a smart sensor can have.
  */
 const struct smart_sensor_driver smart_sensor_driver_gps_pa1010d = {
-    .max_sensors = max_sensors,
     .init_driver = init_driver,
     .finish_driver = finish_driver,
     .detect = detect,
@@ -139,26 +138,21 @@ const struct smart_sensor_driver smart_sensor_driver_gps_pa1010d = {
     .pass_command = NULL,
     .name = name,
 };
+SMART_SENSOR_DRIVER_REGISTER(smart_sensor_driver_gps_pa1010d, GPS, MAX_SENSORS, 0, 0);
 /*Function to find minimum of x and y*/
 
 struct gps {
     float latitude;
     float longitude;
+    float hdop;
+    uint8_t valid; /* The last RMC sentence had a valid position */
 };
 
-/*
- * Local prototypes
- */
-int read_gps_output(char *response, int size, uint32_t timeout);
-/* static int adcp_sensor_gets(char *response, int size); */
-
-/*
- * Get the maximum number of sensors of this type this driver can handle
- */
-static int max_sensors(void)
-{
-    return MAX_SENSORS;
-}
+static struct gps_fix_stats fix_stats = {
+    .budget_ms = GPS_MAX_FIX_BUDGET_MS,
+    .last_hdop = NAN,
+};
+static uint8_t in_standby; /* A module answered and was put in standby, and has not lost the power since */
 
 /**
  * Get the name of the driver.
@@ -169,74 +163,32 @@ static const char *name(void)
 }
 
 /*
- * Get a string from the sensors UART. Return immediately after receiving a
- * newline or after a timeout. The newline is not included in the buffer.
- * @param response A pointer to a buffer to store the received data
- * @param size Size of the receive buffer
- * @param timeout After this time, signal timeout (microseconds)
- * @return The number of bytes stored in the buffer
+ * Feed the characters of the sensors UART to the parser until a sentence with
+ * a valid checksum completes.
+ * @param parser The parser of the port
+ * @param fix Updated with the fields of the sentence
+ * @param end After this time, signal timeout
+ * @return The sentence completed, NMEA_NONE on timeout
  */
-int read_gps_output(char *response, int size, uint32_t timeout)
+static enum nmea_sentence read_gps_sentence(struct nmea_parser *parser, struct nmea_fix *fix, k_timepoint_t end)
 {
-    int n = 0;
+    enum nmea_sentence sentence;
     int c;
-    /* char *p; */
-    /* p = response; */
-    rs485_receive(UART_SMART_SENSOR);
-    k_timepoint_t end = sys_timepoint_calc(K_MSEC(timeout));
 
-    while (1) {
+    while (!sys_timepoint_expired(end)) {
         c = serial_getchar(UART_SMART_SENSOR);
+        watchdog_reset();
         if (c <= 0) {
-            /* getuptime(&now); */
-            /* if(ms_elapsed(&start) > timeout) break; */
-            if (sys_timepoint_expired(end)) {
-                break;
-            }
-        } else {
-            if (n >= size) {
-                break;
-            }
-
-            /* start = get_uptime_ms(); */
-            if (c != 0x0A && c != 0x0D) {
-
-                response_adcp[n] = c;
-                /* p++; */
-                n++;
-                DEBUG("%c", c);
-            }
-
-            /* DEBUG("%c ", c); */
+            continue;
         }
-        watchdog_reset();
-    }
-    /* *p = '\0'; */
-    /* DEBUG("\n"); */
-    return n;
-}
-
-/***
- *
- *
- * Delete character from buffer
- */
-
-void delete_string(char *src, char *dest)
-{
-
-    char *p;
-
-    p = src;
-    while (*p != '\0') {
-        if (*p != 0x0A && *p != 0x0D) {
-            *dest = *p;
-            ++dest;
+        sentence = nmea_parser_feed(parser, c, fix);
+        if (sentence != NMEA_NONE) {
+            return sentence;
         }
-        ++p;
     }
-    *dest = '\0';
+    return NMEA_NONE;
 }
+
 /**
  * to Write command to gps
  */
@@ -253,252 +205,186 @@ int send_command_gps(char *str_command)
 }
 
 /*
- * Prepare the driver
+ * Wake up the module and enable the sentences needed for a fix.
  */
-static int prepare(struct smart_sensor *sensor)
+static void gps_start_output(void)
 {
-
-    return 0;
+    rs485_transmit(UART_SMART_SENSOR);
+    if (cfg.gps_mode == GPS_MODE_STANDBY) {
+        send_command_gps(PMTK_AWAKE); /* Any byte wakes it up from standby */
+    }
+    in_standby = 0;
+    send_command_gps(PMTK_SET_NMEA_OUTPUT_RMCGGA);
+    send_command_gps(PMTK_SET_NMEA_UPDATE_1HZ);
+    rs485_receive(UART_SMART_SENSOR);
+    serial_flush(UART_SMART_SENSOR);
 }
 
-int8_t request_gps_output(struct gps *pa1010d, int sensor_number)
+/*
+ * Stop the output, and in standby mode put the module in standby. The
+ * ephemeris is kept for a hot start only if the module keeps its power: the
+ * sensor power is cut after every sample, so the standby mode needs V_BACKUP
+ * or a GPS supply apart from the sensors.
+ */
+static void gps_stop_output(void)
 {
-    int count_receive;
-
-    char *p_response;
-    /* char *p_response2; */
-
     rs485_transmit(UART_SMART_SENSOR);
-    send_command_gps(PMTK_SET_NMEA_OUTPUT_RMCONLY);
-    send_command_gps(PMTK_SET_NMEA_UPDATE_1HZ);
-    watchdog_disable();
-    sleep_microseconds(1000000); /* delay 1 seg */
-    watchdog_init();
-
-    DEBUG("\nPrepare. Send Comand GPS");
-    DEBUG("\nEsperando Respuesta GPS");
-    count_receive = read_gps_output(response_adcp, 90, 1000);
-    /* sleep_microseconds(1000000);  // delay 10 seg */
+    DEBUG("Apaga Salida GPS\n");
+    send_command_gps(PMTK_SET_NMEA_OUTPUT_OFF);
+    if (cfg.gps_mode == GPS_MODE_STANDBY) {
+        send_command_gps(PMTK_STANDBY);
+        in_standby = 1;
+    }
     serial_flush(UART_SMART_SENSOR);
+}
 
-    watchdog_reset();
-    p_response = strchr(response_adcp, '$');
-    /* p_response2  = strchr(p_response +1 , '$'); */
-    /* if (*p_response2 != '\0') */
-    /* { */
-    /*    p_response = p_response2; */
-    /* } */
-
-    DEBUG("\nDATA RECEIVED: %i", count_receive);
-
-    if (count_receive > 0) {
-        DEBUG("\nDATA_STREAM: ");
-        /* char *p = response_adcp; */
-        DEBUG("\n Response GPS: %s", response_adcp);
-        DEBUG("\n Response GPS Buffer filtrado: %s", p_response);
-
-        /* strlcpy(buffer,response_adcp,6); */
-
-        DEBUG("\nData Valida: %c", p_response[18]);
-
-        if (!strncmp("$GNRMC", p_response, 6)) {
-            DEBUG("\nEncontrada Trama RMC");
-            if (p_response[18] == 'A') {
-                DEBUG("\n \r ++++++++++++ Data Valida +++++++++++++  \r\n");
-
-                char *p = p_response;
-                char latitude_indicator;
-                char longitud_indicator;
-                long dddmm;
-                long ddmm;
-                float degrees;
-                float minutes;
-                float decminutes;
-                long fixed;
-                float deg;
-                float ang;
-
-                p = strchr(p, ',') + 1;
-                p = strchr(p, ',') + 1;
-                p = strchr(p, ',') + 1;
-
-                char buff[10] = {0}; /* Ensure string is terminated after strncpy */
-                char *e = strchr(p, '.');
-
-                strncpy(buff, p, e - p); /* get DDDMM */
-                /* DEBUG("Degreebuff Latitude String: %s",buff); */
-
-                ddmm = atol(buff);
-                degrees = (float)(ddmm / 100);  /* truncate the minutes */
-                minutes = ddmm - degrees * 100; /* remove the degrees */
-
-                p = e + 1;
-                e = strchr(p, ',');
-                strncpy(buff, p, e - p); /* get Deciminutes */
-
-                /* DEBUG("\n \r Latitude Decminutes String: %s",buff); */
-                decminutes = atof(buff) / 10000;
-                /* DEBUG("\n \r Latitude Decminutes float: %f",decminutes); */
-
-                DEBUG("Latitude degress: %f, minutes:%f, decmines: %f",
-                      (double)degrees,
-                      (double)minutes,
-                      (double)decminutes);
-                deg = degrees + (minutes / 60) + (decminutes / 60);
-                /* deg = fixed / (float)10000000.; */
-                ang = degrees + minutes + decminutes;
-
-                latitude_indicator = e[1];
-                DEBUG("\n \r Latitude Indicator: %c", latitude_indicator);
-
-                if (latitude_indicator == 'S' ||
-                    latitude_indicator == 'W') { /* fixed and deg are signed, but DDDMM.mmmm is not */
-                    fixed = -fixed;
-                    deg = -deg;
-                }
-
-                DEBUG("\n\rDegrees Latitude: %f", (double)deg);
-                DEBUG("\n\rAngle Latitude: %f", (double)ang);
-                pa1010d->latitude = deg;
-                p = strchr(p, ',') + 1;
-                p = strchr(p, ',') + 1;
-
-                e = strchr(p, '.');
-
-                strncpy(buff, p, e - p); /* get Deggrees longitud */
-                /* DEBUG("\n\r Degreebuff Longitud: %s",buff); */
-                dddmm = atol(buff);
-                degrees = (float)(dddmm / 100);  /* truncate the minutes */
-                minutes = dddmm - degrees * 100; /* remove the degrees */
-
-                p = e;
-                e = strchr(p, ',');
-                strncpy(buff, p, e - p); /* get Deciminutes */
-
-                /* DEBUG("\n \r Longitud Decminutes: %s",buff); */
-                decminutes = atof(buff);
-                /* fixed = degrees * 10000000 + (minutes * 10000000) / 60 + (decminutes * 10000000) / 60; */
-                DEBUG("Longitud degress: %f, minutes:%f, decmines: %f",
-                      (double)degrees,
-                      (double)minutes,
-                      (double)decminutes);
-                deg = degrees + (minutes / 60) + (decminutes / 60);
-                ang = degrees + minutes + decminutes;
-
-                longitud_indicator = e[1];
-                DEBUG("\n \r Longitud Indicator: %c", longitud_indicator);
-
-                if (longitud_indicator == 'S' ||
-                    longitud_indicator == 'W') { /* fixed and deg are signed, but DDDMM.mmmm is not */
-                    fixed = -fixed;
-                    deg = -deg;
-                }
-
-                DEBUG("\n\rDegrees Longitud: %f", (double)deg);
-                DEBUG("\n\rAngle Longitud: %f", (double)ang);
-                pa1010d->longitude = deg;
-
-            } else {
-                DEBUG("\n\r+++++++Data No Valida.GPS .No encuentra Satelite +++++++++++");
-
-                return 0;
-            }
-
-        } else {
-
-            serial_flush(UART_SMART_SENSOR);
-            return 0;
+/*
+ * Wait for a valid position with an acceptable HDOP, return as soon as it arrives.
+ * @return 1 if there is a fix, 0 on timeout
+ */
+static int wait_for_fix(struct gps *gps, uint32_t budget_ms)
+{
+    struct nmea_parser parser;
+    struct nmea_fix fix = {0};
+    k_timepoint_t end = sys_timepoint_calc(K_MSEC(budget_ms));
+    enum nmea_sentence sentence;
+
+    gps->valid = 0;
+    gps->hdop = NAN;
+    nmea_parser_init(&parser);
+    while ((sentence = read_gps_sentence(&parser, &fix, end)) != NMEA_NONE) {
+        if (sentence == NMEA_RMC) {
+            gps->valid = fix.valid && fix.has_position;
+            gps->latitude = fix.latitude / 1e7f;
+            gps->longitude = fix.longitude / 1e7f;
+            DEBUG("Latitude %f, longitude %f\n", (double)gps->latitude, (double)gps->longitude);
+        } else if (sentence == NMEA_GGA) {
+            gps->hdop = fix.quality > 0 && fix.hdop != UINT16_MAX ? fix.hdop / 100.0f : NAN;
+        }
+        if (gps->valid && gps->hdop <= GPS_MAX_HDOP) {
+            return 1;
         }
+    }
+    DEBUG("%u sentences, %u checksum errors\n", parser.n_sentences, parser.n_checksum_errors);
+    return 0;
+}
 
-    } else {
+/*
+ * Keep the time to fix and adapt the budget of the next acquisition to it. A
+ * timeout gives the next one the time of a cold start.
+ */
+static void update_fix_stats(int fixed, uint32_t time_to_fix_ms, float hdop)
+{
+    uint32_t budget;
 
-        serial_flush(UART_SMART_SENSOR);
-        return 0;
+    if (!fixed) {
+        fix_stats.n_timeouts++;
+        fix_stats.budget_ms = GPS_MAX_FIX_BUDGET_MS;
+        return;
+    }
+    fix_stats.last_time_to_fix_ms = time_to_fix_ms;
+    fix_stats.last_hdop = hdop;
+    if (fix_stats.n_fixes == 0) {
+        fix_stats.average_time_to_fix_ms = time_to_fix_ms;
+    } else {
+        fix_stats.average_time_to_fix_ms = (fix_stats.average_time_to_fix_ms * 3 + time_to_fix_ms) / 4;
     }
+    fix_stats.n_fixes++;
+    budget = fix_stats.average_time_to_fix_ms * GPS_FIX_BUDGET_FACTOR;
+    fix_stats.budget_ms = CLAMP(budget, GPS_MIN_FIX_BUDGET_MS, GPS_MAX_FIX_BUDGET_MS);
+}
 
-    serial_flush(UART_SMART_SENSOR);
+/**
+ * Check if the module was put in standby and the sensor power was not cut since.
+ * @return 1 if the module is in standby
+ */
+int gps_pa1010d_in_standby(void)
+{
+    return in_standby;
+}
 
-    return 1;
+/**
+ * The sensor power was cut, the module is not in standby anymore.
+ */
+void gps_pa1010d_power_cut(void)
+{
+    in_standby = 0;
 }
 
 /**
- * Check if there is a Maxbotix range sensor connected
+ * Time to fix and quality of the last fixes.
+ */
+void gps_pa1010d_get_stats(struct gps_fix_stats *stats)
+{
+    *stats = fix_stats;
+}
+
+/*
+ * Prepare the driver
+ */
+static int prepare(struct smart_sensor *sensor)
+{
+
+    return 0;
+}
+
+/**
+ * Check if there is a GPS connected. Any RMC sentence is enough, a fix is not
+ * needed to detect the module.
  * @param sensor_number The number of the sensor to check for (Unused here)
- * @param measurement A pointer to return a measurement from the sensor
  * @param sensor A pointer to store the sensor information
  * @return True if a sensor was detected
  */
 int detect(int sensor_number, struct smart_sensor *sensor)
 {
-    int count_receive;
-    /* uint8_t response[MAX_RESPONSE_SIZE]; */
-    /* unsigned char *p = response; */
-    struct gps pa1010d;
-    /* int i; */
-    /* int j; */
-    /* int indice_vel; */
-    /* int indice_anl; */
-    /* int ubc; */
-
+    struct nmea_parser parser;
+    struct nmea_fix fix = {0};
+    enum nmea_sentence sentence;
     int tries;
-    int count_sensor;
 
     for (tries = 0; tries < DETECTION_TRIES; tries++) {
-        count_receive = 0;
+        k_timepoint_t end;
+
         sensor->number = sensor_number;
-        count_sensor = sensor_number;
-        /* if (go_command_mode(7000)==1) */
-        /* { */
-
-        if (request_gps_output(&pa1010d, sensor->number) == 1) {
-            sensor->type = GPS_SENSOR; /* RANGE_SENSOR; */
-            sensor->manufacturer = GPS;
-            sensor->power_up_time = 4000; /* TODO Check from datasheet */
-            sensor->channel = 0;          /* We can only have one sensor of this type */
-            strcpy(sensor->name, "GPS");
-            DEBUG("OK\n");
-            DEBUG("Apaga Salida GPS\n");
-            send_command_gps(PMTK_SET_NMEA_OUTPUT_OFF);
-            watchdog_disable();
-            sleep_microseconds(1000000); /* delay 2 seg */
-            send_command_gps(PMTK_SET_NMEA_OUTPUT_OFF);
-            sleep_microseconds(1000000); /* delay 2 seg */
-            watchdog_init();
-            return 1;
-        } else {
-            if (tries == 5) {
-                DEBUG("NO\n");
-                rs485_transmit(UART_SMART_SENSOR);
-                send_command_gps(PMTK_SET_NMEA_OUTPUT_OFF);
-                send_command_gps(PMTK_SET_NMEA_OUTPUT_OFF);
-                return 0;
+        gps_start_output();
+        nmea_parser_init(&parser);
+        end = sys_timepoint_calc(K_MSEC(GPS_DETECTION_WAIT_MS));
+        while ((sentence = read_gps_sentence(&parser, &fix, end)) != NMEA_NONE) {
+            if (sentence == NMEA_RMC) {
+                sensor->type = GPS_SENSOR; /* RANGE_SENSOR; */
+                sensor->manufacturer = GPS;
+                sensor->power_up_time = 1000; /* The fix is awaited in acquire() */
+                sensor->channel = 0;          /* We can only have one sensor of this type */
+                strcpy(sensor->name, "GPS");
+                DEBUG("OK\n");
+                gps_stop_output();
+                return 1;
             }
         }
-        /* } */
     }
-    return 0; /* should never reach here happy compiler */
+    DEBUG("NO\n");
+    gps_stop_output();
+    in_standby = 0; /* Nothing to keep powered */
+    return 0;
 }
 
 /*
  * Prepare the smart-sensors to start a measurement, this means turning them on and
- * enabling the serial port to communicate with them
+ * enabling the serial port to communicate with them. The module is ready as soon
+ * as it sends its first sentence.
  */
 static int init_driver(void)
 {
-    /*	turn_on_smart_sensor(0);   TODO Move to main */
-    /* serial_set_baudrate(UART_SMART_SENSOR, B9600); */
-    rs485_transmit(UART_SMART_SENSOR);
+    struct nmea_parser parser;
+    struct nmea_fix fix = {0};
+
     DEBUG("\nInit. Send Comand GPS");
-    watchdog_disable();
-    sleep_microseconds(20000000); /* delay 10 seg */
-    watchdog_init();
-    send_command_gps(PMTK_SET_NMEA_OUTPUT_RMCONLY);
-    send_command_gps(PMTK_SET_NMEA_UPDATE_1HZ);
-    /* send_command_gps(PMTK_SET_NMEA_UPDATE_200_MILLIHERTZ); */
-    /* send_command_gps(PMTK_SET_NMEA_OUTPUT_OFF); */
+    gps_start_output();
+    nmea_parser_init(&parser);
+    if (read_gps_sentence(&parser, &fix, sys_timepoint_calc(K_MSEC(GPS_BOOT_TIMEOUT_MS))) == NMEA_NONE) {
+        DEBUG("GPS not answering\n");
+    }
     serial_flush(UART_SMART_SENSOR);
-    /* serial_flush(UART_SMART_SENSOR); */
-
     return 0;
 }
 
@@ -512,10 +398,9 @@ static int finish_driver(void)
 }
 
 /**
- * Acquire one smart sensor attached to this device.
- * We read many times into an array, then we sort the array and take the value in the
- * middle, this way we hope to remove extreme values.
- * @param tries The number of retries if there are problems with the sensor
+ * Acquire the position. Returns as soon as there is a fix with an acceptable
+ * HDOP, waiting at most the budget adapted to the last times to fix.
+ * @param tries The number of retries if there are problems with the sensor (Unused here)
  * @param sensor The sensor to read
  * @param measurements A Pointer to store the result measurement
  * @return 1 if OK, 0 on error // TODO Better return the error code
@@ -523,65 +408,23 @@ static int finish_driver(void)
 int acquire(int tries, struct smart_sensor *sensor, struct measurement *measurement)
 {
     struct gps pa1010d;
-
-    /* sleep_microseconds(10000000);  // delay 10 seg */
-    /* sleep_microseconds(10000000);  // delay 10 seg */
-    /* sleep_microseconds(10000000);  // delay 10 seg */
-    tries = 6;
-    while (tries > 0) {
-        /* if (go_command_mode(7000) == 1) { */
-        if (request_gps_output(&pa1010d, sensor->number)) {
-            /* aquadop.cells = 120; //we do not need to 129 */
-            /* process_adcp_raw_data(&aquadop, &adcp_processed_data); */
-            /* TODO we dont need all below, but acquire needs a *measurement */
-            /*      find a way todo do this in a better way */
-            measurement->type = GPS_SENSOR;
-            measurement->gps.Latitude = pa1010d.latitude;
-            measurement->gps.Longitude = pa1010d.longitude;
-
-            /* DEBUG("Measurement Heading: */
-            /* %.1f\n",measurement->current_profiler_signature.Heading); */
-            /* measurement->current_profiler_signature.Pitch = (float)aquadop.pitch * 0.01; */
-            /* DEBUG("Measurement Pitch: %.1f\n",measurement->current_profiler_signature.Pitch); */
-            /* measurement->current_profiler_signature.Roll = (float)aquadop.roll * 0.01; */
-            /* DEBUG("Measurement Roll: %.1f , */
-            /* %i\n",measurement->current_profiler_signature.Roll,aquadop.hRoll); */
-            /* measurement->current_profiler_signature.Temperature = */
-            /*   (float)aquadop.temperature * 0.01; */
-            /* DEBUG("Measurement Temperature: */
-            /* %.1f\n",measurement->current_profiler_signature.Temperature); */
-            /* measurement->current_profiler_signature.current_profiler_signature_status = */
-            /*     MEASUREMENT_OK; */
-            measurement->sensor_status = SENSOR_OK;
-            measurement->type = GPS_SENSOR;
-
-            /* measurement->current_profiler_signature.speed = adcp_processed_data.vel[5]; */
-            /* measurement->current_profiler_signature.direction = adcp_processed_data.dir[5]; */
-            watchdog_reset();
-            rs485_transmit(UART_SMART_SENSOR);
-            DEBUG("Apaga Salida GPS\n");
-            send_command_gps(PMTK_SET_NMEA_OUTPUT_OFF);
-            watchdog_disable();
-            sleep_microseconds(2000000); /* delay 2 seg */
-            send_command_gps(PMTK_SET_NMEA_OUTPUT_OFF);
-            sleep_microseconds(1000000); /* delay 2 seg */
-            watchdog_init();
-            return 1;
-        } else {
-            DEBUG("Error reading GPS sensor\n");
-
-            tries--;
-        }
-        /* } */
+    int64_t start = get_uptime_ms();
+    int fixed;
+
+    gps_start_output();
+    fixed = wait_for_fix(&pa1010d, fix_stats.budget_ms);
+    /* The module was powered up sensor->power_up_time before */
+    update_fix_stats(fixed, ms_elapsed(&start) + sensor->power_up_time, pa1010d.hdop);
+    gps_stop_output();
+    measurement->type = GPS_SENSOR;
+    if (fixed) {
+        DEBUG("GPS fix in %u ms, HDOP %.1f\n", fix_stats.last_time_to_fix_ms, (double)pa1010d.hdop);
+        measurement->gps.Latitude = pa1010d.latitude;
+        measurement->gps.Longitude = pa1010d.longitude;
+        measurement->sensor_status = SENSOR_OK;
+        return 1;
     }
-    rs485_transmit(UART_SMART_SENSOR);
-    DEBUG("Apaga Salida GPS\n");
-    send_command_gps(PMTK_SET_NMEA_OUTPUT_OFF);
-    watchdog_disable();
-    sleep_microseconds(2000000); /* delay 2 seg */
-    send_command_gps(PMTK_SET_NMEA_OUTPUT_OFF);
-    sleep_microseconds(1000000); /* delay 2 seg */
-    watchdog_init();
+    DEBUG("Error reading GPS sensor\n");
     measurement->sensor_status = SENSOR_COMMUNICATION_ERROR;
     measurement->current_profiler_signature.current_profiler_signature_status = MEASUREMENT_ACQUISITION_FAILURE;
     return 0;
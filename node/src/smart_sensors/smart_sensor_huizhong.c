@@ -45,21 +45,18 @@
 /**
  * Driver function prototypes
  */
-static int max_sensors(void);                                      /* Maximum number of sensors for this driver */
 static const char *name(void);                                     /* Name of the driver */
 static int init_driver(void);                                      /* Initialize the driver */
 static int finish_driver(void);                                    /* Finish the operations with the driver */
 static int detect(int sensor_number, struct smart_sensor *sensor); /* Detect a sensor */
 static int prepare(struct smart_sensor *sensor);                   /* Prepare the sensor */
 static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m);
-static int needs_external_voltage(void);
 
 /**
  * Smart sensor driver structure
  * This structure keeps a list of all the functions a smart sensor can have.
  */
 const struct smart_sensor_driver smart_sensor_driver_huizhong = {
-    .max_sensors = max_sensors,
     .init_driver = init_driver,
     .finish_driver = finish_driver,
     .detect = detect,
@@ -70,8 +67,8 @@ const struct smart_sensor_driver smart_sensor_driver_huizhong = {
     .acquire = acquire,
     .pass_command = NULL,
     .name = name,
-    .needs_external_voltage = needs_external_voltage,
 };
+SMART_SENSOR_DRIVER_REGISTER(smart_sensor_driver_huizhong, HUIZHONG, MAX_SENSORS, 1, 0);
 
 /*
  * Local prototypes
@@ -81,14 +78,6 @@ static void prepare_modbus_frame(struct modbus_frame *f, struct smart_sensor *se
 static int modbus_request_measurement(struct smart_sensor *sensor, struct measurement *measurement);
 static int get_parameter(float *param, struct smart_sensor *sensor, struct measurement *m, uint16_t reg);
 
-/*
- * Get the maximum number of sensors of this type this driver can handle
- */
-static int max_sensors(void)
-{
-    return MAX_SENSORS;
-}
-
 /**
  * Get the name of the driver.
  */
@@ -282,8 +271,3 @@ static int get_parameter(float *param, struct smart_sensor *sensor, struct measu
 
     return 1;
 }
-
-static int needs_external_voltage(void)
-{
-    return 1;
-}
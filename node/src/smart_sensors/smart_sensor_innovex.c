@@ -31,7 +31,6 @@
 /**
  * Driver function prototypes
  */
-static int max_sensors(void);                                      /* Maximum number of sensors for this driver */
 static const char *name(void);                                     /* Name of the driver */
 static int init_driver(void);                                      /* Initialize the driver */
 static int finish_driver(void);                                    /* Finish the operations with the driver */
@@ -43,14 +42,12 @@ static int calibrate_full(struct smart_sensor *sensor); /* Calibrate the full sc
 static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m);
 static int pass_command(struct smart_sensor *sensor, char *command);
 static int smart_sensor_request_name(char *name);
-static int needs_external_voltage(void);
 
 /**
  * Smart sensor driver structure for the Innovex sensors
  * This structure keeps a list of all the functions a smart sensor can have.
  */
 const struct smart_sensor_driver smart_sensor_driver_innovex = {
-    .max_sensors = max_sensors,
     .init_driver = init_driver,
     .finish_driver = finish_driver,
     .detect = detect,
@@ -61,8 +58,8 @@ const struct smart_sensor_driver smart_sensor_driver_innovex = {
     .acquire = acquire,
     .pass_command = pass_command,
     .name = name,
-    .needs_external_voltage = needs_external_voltage,
 };
+SMART_SENSOR_DRIVER_REGISTER(smart_sensor_driver_innovex, INNOVEX, MAX_SENSORS, 0, 0);
 
 /*
  * Local prototypes
@@ -78,14 +75,6 @@ static uint8_t pressure_unit;
 static uint8_t unit_obtained;
 static uint8_t phreatic_unit;
 
-/**
- * Get the maximum number of sensors of this type this driver can handle
- */
-static int max_sensors(void)
-{
-    return MAX_SENSORS;
-}
-
 /**
  * Get the name of the driver.
  */
@@ -184,16 +173,23 @@ static int smart_sensor_gets_with_timeout(char *response, int size, uint32_t tim
     int n = 0;
     int c;
     int64_t start;
+    uint32_t first_byte_timeout = smart_sensor_response_timeout(timeout);
 
     start = get_uptime_ms();
     while (1) {
         watchdog_reset();
         c = serial_getchar(UART_SMART_SENSOR);
         if (c < 0) {
-            if (ms_elapsed(&start) > timeout) {
+            if (ms_elapsed(&start) > (n == 0 ? first_byte_timeout : timeout)) {
+                if (n == 0) {
+                    smart_sensor_response_timedout(first_byte_timeout, timeout);
+                }
                 break;
             }
         } else {
+            if (n == 0) {
+                smart_sensor_response_received(ms_elapsed(&start));
+            }
             if (c == '\n' || n >= (size - 2)) {
                 break;
             }
@@ -537,11 +533,6 @@ static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m
     }
 }
 
-static int needs_external_voltage(void)
-{
-    return 0;
-}
-
 /*
  * @brief: get measurements units to show in the display
  */
@@ -37,7 +37,6 @@
 /**
  * Driver function prototypes
  */
-static int max_sensors(void);                                      /* Maximum number of sensors for this driver */
 static const char *name(void);                                     /* Name of the driver */
 static int init_driver(void);                                      /* Initialize the driver */
 static int finish_driver(void);                                    /* Finish the operations with the driver */
@@ -45,14 +44,12 @@ static int detect(int sensor_number, struct smart_sensor *sensor); /* Detect a s
 static int prepare(struct smart_sensor *sensor);                   /* Prepare the sensor */
 static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m);
 static int pass_command(struct smart_sensor *sensor, char *command);
-static int needs_external_voltage(void);
 
 /**
  * Smart sensor driver structure
  * This structure keeps a list of all the functions a smart sensor can have.
  */
 const struct smart_sensor_driver smart_sensor_driver_jiangsu_flow = {
-    .max_sensors = max_sensors,
     .init_driver = init_driver,
     .finish_driver = finish_driver,
     .detect = detect,
@@ -63,8 +60,8 @@ const struct smart_sensor_driver smart_sensor_driver_jiangsu_flow = {
     .acquire = acquire,
     .pass_command = pass_command,
     .name = name,
-    .needs_external_voltage = needs_external_voltage,
 };
+SMART_SENSOR_DRIVER_REGISTER(smart_sensor_driver_jiangsu_flow, JIANGSU, MAX_SENSORS, 1, 0);
 
 /*
  * Local prototypes
@@ -87,14 +84,6 @@ static int set_angle(struct smart_sensor *sensor, float angle);
 static int get_totalizer(struct smart_sensor *sensor);
 static int set_totalizer(struct smart_sensor *sensor, double totalizer_value);
 
-/*
- * Get the maximum number of sensors of this type this driver can handle
- */
-static int max_sensors(void)
-{
-    return MAX_SENSORS;
-}
-
 /**
  * Get the name of the driver.
  */
@@ -787,8 +776,3 @@ static int set_totalizer(struct smart_sensor *sensor, double totalizer_value)
 
     return 0;
 }
-
-static int needs_external_voltage(void)
-{
-    return 1;
-}
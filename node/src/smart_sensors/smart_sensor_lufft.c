@@ -65,7 +65,6 @@ struct weather_sensor_lufft {
 /**
  * Driver function prototypes
  */
-static int max_sensors(void);                                      /* Maximum number of sensors for this driver */
 static const char *name(void);                                     /* Name of the driver */
 static int init_driver(void);                                      /* Initialize the driver */
 static int finish_driver(void);                                    /* Finish the operations with the driver */
@@ -82,7 +81,6 @@ static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m
  * This structure keeps a list of all the functions a smart sensor can have.
  */
 const struct smart_sensor_driver smart_sensor_driver_lufft = {
-    .max_sensors = max_sensors,
     .init_driver = init_driver,
     .finish_driver = finish_driver,
     .detect = detect,
@@ -94,6 +92,7 @@ const struct smart_sensor_driver smart_sensor_driver_lufft = {
     .pass_command = NULL,
     .name = name,
 };
+SMART_SENSOR_DRIVER_REGISTER(smart_sensor_driver_lufft, LUFFT, MAX_SENSORS, 0, 1);
 
 /*
  * Local prototypes
@@ -110,14 +109,6 @@ struct modbus modbus_response, modbus_request;
 uint16_t modbus_data_buffer[MAX_RESPONSE_SIZE];
 #endif
 
-/*
- * Get the maximum number of sensors of this type this driver can handle
- */
-static int max_sensors(void)
-{
-    return MAX_SENSORS;
-}
-
 /**
  * Get the name of the driver.
  */
@@ -27,7 +27,6 @@
 /**
  * Driver function prototypes
  */
-static int max_sensors(void);                                      /* Maximum number of sensors for this driver */
 static const char *name(void);                                     /* Name of the driver */
 static int init_driver(void);                                      /* Initialize the driver */
 static int finish_driver(void);                                    /* Finish the operations with the driver */
@@ -40,7 +39,6 @@ static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m
  * This structure keeps a list of all the functions a smart sensor can have.
  */
 const struct smart_sensor_driver smart_sensor_driver_maxbotix = {
-    .max_sensors = max_sensors,
     .init_driver = init_driver,
     .finish_driver = finish_driver,
     .detect = detect,
@@ -52,6 +50,7 @@ const struct smart_sensor_driver smart_sensor_driver_maxbotix = {
     .pass_command = NULL,
     .name = name,
 };
+SMART_SENSOR_DRIVER_REGISTER(smart_sensor_driver_maxbotix, MAXBOTIX, MAX_N_SENSORS, 0, 0);
 
 /*
  * Local prototypes
@@ -59,14 +58,6 @@ const struct smart_sensor_driver smart_sensor_driver_maxbotix = {
 static int maxbotix_sensor_gets_with_timeout(char *response, int size, uint32_t timeout);
 static int maxbotix_sensor_gets(char *response, int size);
 
-/*
- * Get the maximum number of sensors of this type this driver can handle
- */
-static int max_sensors(void)
-{
-    return MAX_N_SENSORS;
-}
-
 /**
  * Get the name of the driver.
  */
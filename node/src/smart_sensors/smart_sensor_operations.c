@@ -15,16 +15,23 @@
 #include "serial.h"
 #include "microio.h"
 #include "display_fb.h"
+#include "userinterface.h"
 #include "hardware.h"
 #include "adc.h"
 #include "debug.h"
 /* #include "temperature.h" */
 #include "smart_sensor.h"
 #include "measurement.h"
+#include "measurement_operations.h"
 #include "errorcodes.h"
 #include "watchdog.h"
+#include "profiler.h"
+#include "defaults.h"
+#include "configuration.h"
+#include "timeutils.h"
 /* #include "modbus.h" */
 #include "sensor_power_hw.h"
+#include "gps_pa1010d.h"
 #define HZ 100
 
 /**
@@ -34,21 +41,70 @@ static struct smart_sensor sensor[MAX_EXTERNAL_SENSORS];
 static uint8_t sensors_detected;
 static int preheat_time;
 
-int smart_sensors_detect_voltage(void)
+/*
+ * Order to probe the drivers: first the manufacturers detected the last time,
+ * then the rest of the configured drivers.
+ * @return The number of manufacturers in order
+ */
+static int detection_order(enum sensor_manufacturer *order)
 {
-    enum sensor_manufacturer manufacturer;
+    int n = 0;
 
-    for (manufacturer = MANUFACTURER_NONE; manufacturer < SENSOR_MANUFACTURER_END; manufacturer++) {
-        watchdog_reset();
-        const struct smart_sensor_driver *driver = driver_for_manufacturer(manufacturer);
+    for (int pass = 0; pass < 2; pass++) {
+        for (int m = MANUFACTURER_NONE + 1; m < SENSOR_MANUFACTURER_END; m++) {
+            int detected_before = (cfg.detected_manufacturers & (1UL << m)) != 0;
 
-        if (driver != NULL) {
-            if (driver->needs_external_voltage()) {
-                return 1;
+            if (driver_for_manufacturer(m) != NULL && detected_before == (pass == 0)) {
+                order[n++] = m;
             }
         }
     }
-    return 0;
+    return n;
+}
+
+/*
+ * Detect the sensors of a driver, until max_sensors or the time budget.
+ * @return The number of sensors detected
+ */
+static int detect_driver(enum sensor_manufacturer manufacturer, struct smart_sensor *first, int free_slots)
+{
+    const struct smart_sensor_driver_entry *entry = driver_entry_for_manufacturer(manufacturer);
+    const struct smart_sensor_driver *driver = entry->driver;
+    int max_sensors = entry->max_sensors;
+    int n = 0;
+    int64_t start = get_uptime_ms();
+
+    display_clear();
+    display_printf("Detecting sensors\n%s\n", driver->name());
+    display_flush_changed();
+    driver->init_driver();
+    for (int i = 0; i < max_sensors && n < free_slots; i++) {
+        struct smart_sensor *s = first + n;
+
+        watchdog_reset();
+        if (ms_elapsed(&start) > DETECTION_DRIVER_BUDGET_MS) {
+            DEBUG("%s: detection budget exhausted at sensor %i\n", driver->name(), i);
+            break;
+        }
+        if (driver->detect(i, s)) {
+            /* A sensor has been detected */
+            s->manufacturer = manufacturer;
+            memset(&s->stats, 0, sizeof(s->stats));
+            for (int command = 0; command < SENSOR_COMMAND_END; command++) {
+                response_timeout_init(&(s->response_timeouts[command]));
+            }
+            /* Find the biggest power up time */
+            if (preheat_time < s->power_up_time) {
+                preheat_time = s->power_up_time;
+            }
+            display_printf("Sensor %i: OK\n", i);
+            n++;
+        }
+    }
+    driver->finish_driver();
+    display_flush_changed();
+    watchdog_reset();
+    return n;
 }
 
 /**
@@ -58,72 +114,42 @@ int smart_sensors_detect_voltage(void)
 int smart_sensors_detect_all(void)
 {
     int n_of_sensors_detected = 0;
-    int line = 0;
-    /*    turn_on_smart_sensor(0); */
-    /* adc_init(); */
-    enum sensor_manufacturer manufacturer;
-
-    for (manufacturer = MANUFACTURER_NONE; manufacturer < SENSOR_MANUFACTURER_END; manufacturer++) {
-        watchdog_reset();
-        const struct smart_sensor_driver *driver = driver_for_manufacturer(manufacturer);
-
-        if (driver != NULL) {
-            /* There is a driver for this sensor */
-            watchdog_reset();
-            display_clear();
-            display_printf("Detecting sensors\n%s\n", driver->name());
-            int max_sensors = driver->max_sensors();
-
-            driver->init_driver();
-            for (int i = 0; i < max_sensors; i++) {
-                /*                display_move(0, line*8); */
-                display_printf("Sensor %i: ", i);
-                watchdog_reset();
-                int sensor_supply_mv = adc_read_sensor_supply();
+    enum sensor_manufacturer order[SENSOR_MANUFACTURER_END];
+    int n_of_drivers = detection_order(order);
+    uint32_t detected_manufacturers = 0;
+    int64_t start = get_uptime_ms();
+    int sensor_supply_mv = adc_read_sensor_supply();
 
-                display_printf("%.1fV ", ((double)sensor_supply_mv) / 1000.0);
-                if (sensor_supply_mv < 4000) {
-                    display_printf("bajo "); /* Voltage too low */
-                }
-                struct smart_sensor *s = &(sensor[n_of_sensors_detected]);
+    DEBUG("Sensor supply %i mV\n", sensor_supply_mv);
+    if (sensor_supply_mv < 4000) {
+        display_printf("Sensor supply %.1fV bajo\n", ((double)sensor_supply_mv) / 1000.0); /* Voltage too low */
+    }
+    for (int d = 0; d < n_of_drivers && n_of_sensors_detected < MAX_EXTERNAL_SENSORS; d++) {
+        int n;
 
-                if (driver->detect(i, s)) {
-                    /* A sensor has been detected */
-                    s->manufacturer = manufacturer;
-                    /* Find the biggest power up time */
-                    if (preheat_time < s->power_up_time) {
-                        preheat_time = s->power_up_time;
-                    }
-                    display_printf("OK", i);
-                    n_of_sensors_detected++;
-                } else {
-                    display_printf("no");
-                }
-                display_printf("\n");
-                display_flush();
-                line++;
-            }
-            driver->finish_driver();
-            watchdog_reset();
-            sleep_microseconds(500000);
-        }
-        if (n_of_sensors_detected > 0 && manufacturer == LUFFT) {
-            break;
-        } else if (n_of_sensors_detected > 0 && manufacturer == VAISALA) {
-            break;
-        } else if (n_of_sensors_detected > 0 && manufacturer == NORTEK) {
+        if (ms_elapsed(&start) > DETECTION_TOTAL_BUDGET_MS) {
+            DEBUG("Detection budget exhausted\n");
             break;
-        } else if (n_of_sensors_detected > 0 && manufacturer == ACCONEER) {
-            break;
-        } else if (n_of_sensors_detected > 0 && manufacturer == WITMOTION) {
+        }
+        n = detect_driver(
+            order[d], &(sensor[n_of_sensors_detected]), MAX_EXTERNAL_SENSORS - n_of_sensors_detected);
+        if (n > 0) {
+            n_of_sensors_detected += n;
+            detected_manufacturers |= (1UL << order[d]);
+        }
+        /* After a family that owns the bus, stop if anything was found, by it or before it */
+        if (n_of_sensors_detected > 0 && driver_entry_for_manufacturer(order[d])->exclusive) {
             break;
         }
-
-        /* comment this line, so we can read sensors from more than 1 manufacturer */
-        /* if(n_of_sensors_detected > 0) break;  // Once a manufacturer was detected, continue */
+        sleep_microseconds(500000);
     }
-    /*    turn_off_smart_sensor(0); */
     sensors_detected = n_of_sensors_detected;
+    join_plan_invalidate();
+    /* Remember what was found to probe it first the next time */
+    if (detected_manufacturers != 0 && detected_manufacturers != cfg.detected_manufacturers) {
+        cfg.detected_manufacturers = detected_manufacturers;
+        write_configuration_field(&cfg.detected_manufacturers);
+    }
     return n_of_sensors_detected;
 }
 
@@ -151,20 +177,29 @@ struct smart_sensor *smart_sensor_get(uint8_t sensor_number)
     }
 }
 
+/**
+ * Prepare one smart sensor
+ */
+void smart_sensor_prepare(int sensor_number)
+{
+    const struct smart_sensor_driver *driver = driver_for_sensor(sensor_number);
+
+    watchdog_reset();
+    if (driver != NULL) {
+        driver->init_driver();
+        smart_sensor_set_active(&(sensor[sensor_number]), SENSOR_COMMAND_CONTROL);
+        driver->prepare(&(sensor[sensor_number]));
+        smart_sensor_set_active(NULL, SENSOR_COMMAND_CONTROL);
+    }
+}
+
 /**
  * Prepare all the smart sensor
  */
 void smart_sensor_prepare_all(int n_of_sensors)
 {
-    const struct smart_sensor_driver *driver;
-
     for (int i = 0; i < n_of_sensors; i++) {
-        watchdog_reset();
-        driver = driver_for_sensor(i);
-        if (driver != NULL) {
-            driver->init_driver();
-            driver->prepare(&(sensor[i]));
-        }
+        smart_sensor_prepare(i);
     }
 }
 
@@ -223,37 +258,138 @@ int smart_sensor_calibrate(int sensor_number, float cal_value)
     }
     serial_tx_disable(UART_SMART_SENSOR);
     /* turn_off_smart_sensor(0); */
-    sensor_power_off(smart_sensors_detect_voltage());
+    smart_sensors_power_off();
     return calibrated;
 }
 
+/**
+ * Cut the power of the smart sensors. All the power offs go through here, so
+ * the GPS knows that it lost its standby.
+ */
+void smart_sensors_power_off(void)
+{
+    sensor_power_off(smart_sensors_detect_voltage());
+    gps_pa1010d_power_cut();
+}
+
+/*
+ * Tries for the next acquisition of a sensor: only one if it answered the last
+ * SENSOR_RELIABLE_STREAK times, all the budget otherwise.
+ */
+static int tries_for_sensor(const struct smart_sensor *s, int max_tries)
+{
+    if (s->stats.consecutive_successes >= SENSOR_RELIABLE_STREAK) {
+        return 1;
+    }
+    return max_tries;
+}
+
+/*
+ * Update the statistics of a sensor after an acquisition. A sensor that fails
+ * SENSOR_DEAD_FAILURES times in a row is skipped for 1, 2, 4... cycles, up to
+ * SENSOR_MAX_BACKOFF_CYCLES, until it answers again.
+ */
+static void update_sensor_stats(struct smart_sensor *s, int acquired, const struct measurement *m, uint32_t latency_ms)
+{
+    struct smart_sensor_stats *stats = &(s->stats);
+
+    stats->last_latency_ms = latency_ms;
+    if (latency_ms > stats->max_latency_ms) {
+        stats->max_latency_ms = latency_ms;
+    }
+    if (acquired) {
+        if (stats->successes == 0) {
+            stats->avg_latency_ms = latency_ms;
+        } else {
+            stats->avg_latency_ms += ((int32_t)latency_ms - (int32_t)stats->avg_latency_ms) >> SENSOR_LATENCY_EWMA_SHIFT;
+        }
+        stats->successes++;
+        if (stats->consecutive_successes < UINT16_MAX) {
+            stats->consecutive_successes++;
+        }
+        stats->consecutive_failures = 0;
+        stats->backoff_cycles = 0;
+        return;
+    }
+    if (m->sensor_status == SENSOR_NOT_DETECTED) {
+        stats->timeouts++;
+    } else {
+        stats->failures++;
+    }
+    stats->consecutive_successes = 0;
+    if (stats->consecutive_failures < UINT16_MAX) {
+        stats->consecutive_failures++;
+    }
+    if (stats->consecutive_failures >= SENSOR_DEAD_FAILURES) {
+        if (stats->backoff_cycles == 0) {
+            stats->backoff_cycles = 1;
+        } else if (stats->backoff_cycles < SENSOR_MAX_BACKOFF_CYCLES) {
+            stats->backoff_cycles *= 2;
+        }
+        stats->skip_remaining = stats->backoff_cycles;
+        DEBUG("Sensor %s not answering, skipping %i cycles\n", s->name, stats->backoff_cycles);
+    }
+}
+
 /**
  * Acquire all the smart sensors and store the measuruemnts in the specified array.
  * @param n_of_sensor The number of sensors to read
+ * @param communication_tries The maximum number of tries for every sensor
  * @param measurement a pointer to store all the measurements
  * @return the number of measurements acquired
  */
 int smart_sensors_aquire_all(int n_of_sensors, int communication_tries, struct measurement *measurement)
 {
     int n_of_sensors_acquired = 0;
-    const struct smart_sensor_driver *driver;
 
     for (int i = 0; i < n_of_sensors; ++i) {
-        watchdog_reset();
-        driver = driver_for_sensor(i);
-
-        if (driver != NULL) {
-            driver->init_driver();
-            if (driver->acquire(communication_tries, &(sensor[i]), &(measurement[i]))) {
-                n_of_sensors_acquired++;
-            }
-            driver->finish_driver();
+        if (smart_sensor_acquire(i, communication_tries, &(measurement[i])) > 0) {
+            n_of_sensors_acquired++;
         }
-        watchdog_reset();
     }
     return n_of_sensors_acquired;
 }
 
+/**
+ * Acquire one smart sensor.
+ * @param sensor_number The number of the sensor to read
+ * @param communication_tries The maximum number of tries
+ * @param measurement a pointer to store the measurement
+ * @return 1 if acquired, 0 otherwise
+ */
+int smart_sensor_acquire(int sensor_number, int communication_tries, struct measurement *measurement)
+{
+    struct smart_sensor *s = &(sensor[sensor_number]);
+    struct smart_sensor_stats *stats = &(s->stats);
+    const struct smart_sensor_driver *driver = driver_for_sensor(sensor_number);
+    int acquired = 0;
+
+    watchdog_expect(WATCHDOG_SENSOR_ACQUIRE_TIME);
+    if (driver != NULL && stats->skip_remaining > 0) {
+        stats->skip_remaining--;
+        stats->skipped++;
+        measurement->sensor_status = SENSOR_NOT_DETECTED;
+    } else if (driver != NULL) {
+        struct profile_mark mark = profiler_start();
+
+        stats->tries = tries_for_sensor(s, communication_tries);
+        driver->init_driver();
+        smart_sensor_set_active(s, SENSOR_COMMAND_MEASUREMENT);
+        acquired = driver->acquire(stats->tries, s, measurement);
+        if (!acquired && stats->tries < communication_tries) {
+            /* A reliable sensor failed, use the rest of the budget */
+            acquired = driver->acquire(communication_tries - stats->tries, s, measurement);
+            stats->tries = communication_tries;
+        }
+        smart_sensor_set_active(NULL, SENSOR_COMMAND_MEASUREMENT);
+        driver->finish_driver();
+        update_sensor_stats(s, acquired, measurement, profiler_elapsed_us(mark) / 1000);
+        profiler_stop_driver(s->manufacturer, mark);
+    }
+    watchdog_reset();
+    return acquired ? 1 : 0;
+}
+
 /**
  * Check if the configuration of the sensor has changed.
  * It is only important to have the same sequence of sensor types.
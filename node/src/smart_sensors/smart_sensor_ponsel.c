@@ -29,7 +29,6 @@
 /**
  * Driver function prototypes
  */
-static int max_sensors(void);                                      /* Maximum number of sensors for this driver */
 static const char *name(void);                                     /* Name of the driver */
 static int init_driver(void);                                      /* Initialize the driver */
 static int finish_driver(void);                                    /* Finish the operations with the driver */
@@ -40,14 +39,12 @@ static int prepare(struct smart_sensor *sensor);                   /* Prepare th
 /* static int calibrate_full(struct smart_sensor *sensor); // Calibrate the full scale of the sensor */
 static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m);
 /* static int pass_command(struct smart_sensor *sensor, char *command); */
-static int needs_external_voltage(void);
 
 /**
  * Smart sensor driver structure for the Yosemitech sensors
  * This structure keeps a list of all the functions a smart sensor can have.
  */
 const struct smart_sensor_driver smart_sensor_driver_ponsel = {
-    .max_sensors = max_sensors,
     .init_driver = init_driver,
     .finish_driver = finish_driver,
     .detect = detect,
@@ -58,8 +55,8 @@ const struct smart_sensor_driver smart_sensor_driver_ponsel = {
     .acquire = acquire,
     .pass_command = NULL,
     .name = name,
-    .needs_external_voltage = needs_external_voltage,
 };
+SMART_SENSOR_DRIVER_REGISTER(smart_sensor_driver_ponsel, PONSEL, MAX_SENSORS, 1, 0);
 
 /*
  * Local prototypes
@@ -68,14 +65,6 @@ static void prepare_modbus_frame(struct modbus_frame *f, struct smart_sensor *se
                                  uint16_t coils);
 static int modbus_request_measurement(struct smart_sensor *sensor, struct measurement *measurement);
 
-/*
- * Get the maximum number of sensors of this type this driver can handle
- */
-static int max_sensors(void)
-{
-    return MAX_SENSORS;
-}
-
 /**
  * Get the name of the driver.
  */
@@ -219,9 +208,9 @@ static int modbus_request_measurement(struct smart_sensor *sensor, struct measur
 
     /*READ THE 6 REGISTERS FOR TEMP, PH AND REDOX*/
     prepare(sensor);
-    watchdog_disable();
+    watchdog_expect(1000);
     sleep_microseconds(1000000);
-    watchdog_init();
+    watchdog_reset();
     /* READ TEMP */
     if (sensor->number == 3) {
         prepare_modbus_frame(&f, sensor, MODBUS_READ_HOLDING_REGISTERS, 0x0053, 8);
@@ -296,8 +285,3 @@ static int modbus_request_measurement(struct smart_sensor *sensor, struct measur
     }
     return 1;
 }
-
-static int needs_external_voltage(void)
-{
-    return 1;
-}
@@ -33,21 +33,18 @@ static const struct device *uart_dev = DEVICE_DT_GET(UART_DEVICE_NODE);
 /**
  * Driver function prototypes
  */
-static int max_sensors(void);                                      /* Maximum number of sensors for this driver */
 static const char *name(void);                                     /* Name of the driver */
 static int init_driver(void);                                      /* Initialize the driver */
 static int finish_driver(void);                                    /* Finish the operations with the driver */
 static int detect(int sensor_number, struct smart_sensor *sensor); /* Detect a sensor */
 static int prepare(struct smart_sensor *sensor);                   /* Prepare the sensor */
 static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m);
-static int needs_external_voltage(void);
 
 /**
  * Smart sensor driver structure for the Seabird range sensors
  * This structure keeps a list of all the functions a smart sensor can have.
  */
 const struct smart_sensor_driver smart_sensor_driver_seabird = {
-    .max_sensors = max_sensors,
     .init_driver = init_driver,
     .finish_driver = finish_driver,
     .detect = detect,
@@ -58,8 +55,8 @@ const struct smart_sensor_driver smart_sensor_driver_seabird = {
     .acquire = acquire,
     .pass_command = NULL,
     .name = name,
-    .needs_external_voltage = needs_external_voltage,
 };
+SMART_SENSOR_DRIVER_REGISTER(smart_sensor_driver_seabird, SEABIRD, MAX_N_SENSORS, 1, 0);
 
 struct seabird_sensors {
     float temperature;
@@ -92,14 +89,6 @@ static int seabird_sensor_gets(char *response, int size);
 static int request_measurement(struct smart_sensor *sensor, struct measurement *measurement);
 static void smart_sensor_send_command(unsigned char *data, size_t size);
 static int process_data(char *response, struct measurement *measurement);
-/*
- * Get the maximum number of sensors of this type this driver can handle
- */
-static int max_sensors(void)
-{
-    return MAX_N_SENSORS;
-}
-
 /**
  * Get the name of the driver.
  */
@@ -285,7 +274,7 @@ static int request_measurement(struct smart_sensor *sensor, struct measurement *
     uint8_t ret = 0;
 
     if (sensor->number == 0) {
-        watchdog_disable();
+        watchdog_expect(42000);
         smart_sensor_send_command("\r", 1);
         sleep_microseconds(1000000);
         smart_sensor_send_command("\r", 1);
@@ -295,6 +284,7 @@ static int request_measurement(struct smart_sensor *sensor, struct measurement *
         sleep_microseconds(40000000);
         init_driver();
         while (try > 0) {
+            watchdog_reset();
             try--;
             printk("Try\n");
             ret = seabird_sensor_gets(response, sizeof(response));
@@ -305,7 +295,7 @@ static int request_measurement(struct smart_sensor *sensor, struct measurement *
             }
         }
         printk("Request data: %s\n", response);
-        watchdog_init();
+        watchdog_reset();
         process_data(response, measurement);
         struct ctdo_raw_measurement *m = &(measurement->ctdo);
 
@@ -475,8 +465,3 @@ static int process_data(char *response, struct measurement *measurement)
 
     return 0;
 }
-
-static int needs_external_voltage(void)
-{
-    return 1;
-}
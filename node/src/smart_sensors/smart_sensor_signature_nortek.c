@@ -63,21 +63,18 @@ struct adcp_data adcp_processed_data;
 /**
  * Driver function prototypes
  */
-static int max_sensors(void);                                      /* Maximum number of sensors for this driver */
 static const char *name(void);                                     /* Name of the driver */
 static int init_driver(void);                                      /* Initialize the driver */
 static int finish_driver(void);                                    /* Finish the operations with the driver */
 static int detect(int sensor_number, struct smart_sensor *sensor); /* Detect a sensor */
 static int prepare(struct smart_sensor *sensor);                   /* Prepare the sensor */
 static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m);
-static int needs_external_voltage(void);
 
 /**
  * Smart sensor driver structure for the Maxbotix range sensors
  * This structure keeps a list of all the functions a smart sensor can have.
  */
 const struct smart_sensor_driver smart_sensor_driver_signature_nortek = {
-    .max_sensors = max_sensors,
     .init_driver = init_driver,
     .finish_driver = finish_driver,
     .detect = detect,
@@ -88,8 +85,8 @@ const struct smart_sensor_driver smart_sensor_driver_signature_nortek = {
     .acquire = acquire,
     .pass_command = NULL,
     .name = name,
-    .needs_external_voltage = needs_external_voltage,
 };
+SMART_SENSOR_DRIVER_REGISTER(smart_sensor_driver_signature_nortek, NORTEK, MAX_SENSORS, 0, 1);
 
 /*
  * Local prototypes
@@ -97,14 +94,6 @@ const struct smart_sensor_driver smart_sensor_driver_signature_nortek = {
 int adcp_sensor_gets_with_timeout(char *response, int size, uint32_t timeout);
 /* static int adcp_sensor_gets(char *response, int size); */
 
-/*
- * Get the maximum number of sensors of this type this driver can handle
- */
-static int max_sensors(void)
-{
-    return MAX_SENSORS;
-}
-
 /**
  * Get the name of the driver.
  */
@@ -537,9 +526,9 @@ int8_t request_current_profiler(struct adcp_raw_data *adcp, int sensor_number)
     /* status = adcp_sensor_gets_with_timeout(response_adcp,4000,5000); */
     /* DEBUG("\nDatos descartados despues start: %i", status); */
     serial_flush(UART_SMART_SENSOR);
-    watchdog_disable();
+    watchdog_expect(2000);
     sleep_microseconds(2000000); /* delay 2 seg */
-    watchdog_init();
+    watchdog_reset();
     serial_flush(UART_SMART_SENSOR);
     go_command_mode(10000);
     go_powerdown(10000);
@@ -678,8 +667,3 @@ int acquire(int tries, struct smart_sensor *sensor, struct measurement *measurem
     measurement->current_profiler_signature.current_profiler_signature_status = MEASUREMENT_ACQUISITION_FAILURE;
     return 0;
 }
-
-static int needs_external_voltage(void)
-{
-    return 0;
-}
@@ -58,7 +58,6 @@ struct weather_sensor_vaisala {
 /**
  * Driver function prototypes
  */
-static int max_sensors(void);                                      /* Maximum number of sensors for this driver */
 static const char *name(void);                                     /* Name of the driver */
 static int init_driver(void);                                      /* Initialize the driver */
 static int finish_driver(void);                                    /* Finish the operations with the driver */
@@ -69,14 +68,12 @@ static int prepare(struct smart_sensor *sensor);                   /* Prepare th
 /* static int calibrate_full(struct smart_sensor *sensor); // Calibrate the full scale of the sensor */
 static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m);
 /* static int pass_command(struct smart_sensor *sensor, char *command); */
-static int needs_external_voltage(void);
 
 /**
  * Smart sensor driver structure for the Yosemitech sensors
  * This structure keeps a list of all the functions a smart sensor can have.
  */
 const struct smart_sensor_driver smart_sensor_driver_vaisala = {
-    .max_sensors = max_sensors,
     .init_driver = init_driver,
     .finish_driver = finish_driver,
     .detect = detect,
@@ -87,8 +84,8 @@ const struct smart_sensor_driver smart_sensor_driver_vaisala = {
     .acquire = acquire,
     .pass_command = NULL,
     .name = name,
-    .needs_external_voltage = needs_external_voltage,
 };
+SMART_SENSOR_DRIVER_REGISTER(smart_sensor_driver_vaisala, VAISALA, MAX_SENSORS, 1, 1);
 
 /*
  * Local prototypes
@@ -105,14 +102,6 @@ struct modbus modbus_response, modbus_request;
 uint16_t modbus_data_buffer[MAX_RESPONSE_SIZE];
 #endif
 
-/*
- * Get the maximum number of sensors of this type this driver can handle
- */
-static int max_sensors(void)
-{
-    return MAX_SENSORS;
-}
-
 /**
  * Get the name of the driver.
  */
@@ -402,8 +391,3 @@ static int modbus_request_measurement(struct smart_sensor *sensor, struct measur
     m->precipitation_status = MEASUREMENT_OK;
     return 1;
 }
-
-static int needs_external_voltage(void)
-{
-    return 1;
-}
@@ -40,18 +40,15 @@
 #define WTVB01_PREPARE_RETRIES      5
 
 /* Driver function prototypes */
-static int max_sensors(void);
 static const char *name(void);
 static int init_driver(void);
 static int finish_driver(void);
 static int detect(int sensor_number, struct smart_sensor *sensor);
 static int prepare(struct smart_sensor *sensor);
 static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m);
-static int needs_external_voltage(void);
 
 /* Smart sensor driver structure */
 const struct smart_sensor_driver smart_sensor_driver_wtvb01 = {
-    .max_sensors = max_sensors,
     .init_driver = init_driver,
     .finish_driver = finish_driver,
     .detect = detect,
@@ -62,19 +59,14 @@ const struct smart_sensor_driver smart_sensor_driver_wtvb01 = {
     .acquire = acquire,
     .pass_command = NULL,
     .name = name,
-    .needs_external_voltage = needs_external_voltage,
 };
+SMART_SENSOR_DRIVER_REGISTER(smart_sensor_driver_wtvb01, WITMOTION, MAX_SENSORS, 1, 1);
 
 /* Local prototypes */
 static void prepare_modbus_frame(struct modbus_frame *f, struct smart_sensor *sensor, uint8_t function, uint16_t reg, uint16_t count);
 static int modbus_request_measurement(struct smart_sensor *sensor, struct measurement *measurement);
 static int get_parameter_u16(uint16_t *regs, int n_regs, struct smart_sensor *sensor, struct measurement *m, uint16_t reg);
 
-static int max_sensors(void)
-{
-    return MAX_SENSORS;
-}
-
 static const char *name(void)
 {
     return "WTVB01";
@@ -430,9 +422,3 @@ static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m
     measurement->sensor_number = sensor->number;
     return 0;
 }
-
-
-static int needs_external_voltage(void)
-{
-    return 1;
-}
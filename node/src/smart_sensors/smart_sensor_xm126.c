@@ -44,7 +44,6 @@ typedef enum {
 /**
  * Driver function prototypes
  */
-static int max_sensors(void);
 static const char *name(void);
 static int init_driver(void);
 static int finish_driver(void);
@@ -66,13 +65,11 @@ static int request_distance_measurement(struct smart_sensor *sensor, struct meas
 static int request_velocity_distance_measurement(struct smart_sensor *sensor, struct measurement *measurement);
 static void xm126_send_command(int sensor_number, uint8_t cmd);
 static int request_measurement_by_type(struct smart_sensor *sensor, struct measurement *measurement);
-static int needs_external_voltage(void);
 
 /*
  * Smart sensor driver structure for the Acconeer XM126 radar
  */
 const struct smart_sensor_driver smart_sensor_driver_xm126 = {
-    .max_sensors = max_sensors,
     .init_driver = init_driver,
     .finish_driver = finish_driver,
     .detect = detect,
@@ -83,8 +80,8 @@ const struct smart_sensor_driver smart_sensor_driver_xm126 = {
     .finish = NULL,
     .calibrate_zero = NULL,
     .calibrate_full = NULL,
-    .needs_external_voltage = needs_external_voltage,
 };
+SMART_SENSOR_DRIVER_REGISTER(smart_sensor_driver_xm126, ACCONEER, MAX_SENSORS, 0, 1);
 
 static int request_measurement_by_type(struct smart_sensor *sensor, struct measurement *measurement)
 {
@@ -159,14 +156,6 @@ static void xm126_send_command(int sensor_number, uint8_t cmd)
     }
 }
 
-/**
- * Get the maximum number of sensors this driver can handle
- */
-static int max_sensors(void)
-{
-    return MAX_SENSORS;
-}
-
 /**
  * Get the name of the driver
  */
@@ -573,8 +562,3 @@ static int acquire(int tries, struct smart_sensor *sensor, struct measurement *m
     }
     return 0;
 }
-
-static int needs_external_voltage(void)
-{
-    return 0;
-}
@@ -32,8 +32,38 @@ static const struct adc_dt_spec adc_channels[] = {
 #define ADC_NUM_CHANNELS ARRAY_SIZE(adc_channels)
 #define ADC_NODE         DT_PHANDLE(DT_PATH(zephyr_user), io_channels)
 
+/* Index of the channels in the io-channels of the devicetree */
+#define CHANNEL_SOLENOID 0
+#define CHANNEL_BATTERY  1
+#define CHANNEL_SENSOR   2
+
+/* Divider in front of every channel */
+static const int channel_divider[] = {
+    [CHANNEL_SOLENOID] = 11,
+    [CHANNEL_BATTERY] = 2,
+    [CHANNEL_SENSOR] = 2,
+};
+
+static const char *const channel_name[] = {
+    [CHANNEL_SOLENOID] = "Solenoid",
+    [CHANNEL_BATTERY] = "Battery",
+    [CHANNEL_SENSOR] = "Sensor Supply",
+};
+
+/*
+ * The SAM0 ADC has a single input multiplexer and the channel setup writes it
+ * directly, so only one channel is configured at a time. The last one is
+ * remembered and the setup is repeated only when the channel changes.
+ */
+static int configured_channel = -1;
+static uint8_t calibrate = 1; /* Calibrate with the first conversion */
+
+/* The valve pulses read the solenoid supply from the valves work queue */
+static K_MUTEX_DEFINE(adc_lock);
+
 /**
  * Configures and reads a specific channel from the ADC, storing the result in a buffer.
+ * Every sample is the average of 1 << ADC_OVERSAMPLING conversions.
  * @param adc_channel ADC channel specification.
  * @param sample_buffer Buffer to store the value read.
  * @param resolution ADC resolution.
@@ -43,12 +73,69 @@ int read_adc_channel(const struct adc_dt_spec *adc_channel, int32_t *sample_buff
 {
     struct adc_sequence sequence = {
         .resolution = resolution,
+        .oversampling = ADC_OVERSAMPLING,
+        .calibrate = calibrate,
         .buffer = sample_buffer,
         .buffer_size = sizeof(*sample_buffer),
         .channels = BIT(adc_channel->channel_id),
     };
+    int err = adc_read(adc_channel->dev, &sequence);
+
+    if (err == 0) {
+        calibrate = 0;
+    }
+    return err;
+}
+
+/*
+ * Route a channel to the ADC, if it is not already. Call with the lock taken.
+ */
+static int select_channel(int channel)
+{
+    int err;
+
+    if (channel == configured_channel) {
+        return 0;
+    }
+    err = adc_channel_setup_dt(&adc_channels[channel]);
+    configured_channel = err < 0 ? -1 : channel;
+    return err;
+}
+
+/*
+ * Raw value of a channel to mV at the input of its divider.
+ */
+static int to_mv(int channel, int32_t sample)
+{
+    int mv_value = (sample * 1650 * 2) / (1 << adc_channels[channel].resolution);
+
+    LOG_DBG("ADC ch %s raw: %d = %dmV x %d = %dmV",
+            channel_name[channel],
+            sample,
+            mv_value,
+            channel_divider[channel],
+            mv_value * channel_divider[channel]);
+    return mv_value * channel_divider[channel];
+}
+
+/*
+ * Read a channel in mV. Call with the lock taken.
+ */
+static int read_mv(int channel)
+{
+    int32_t sample_buffer = 0;
+    int err = select_channel(channel);
 
-    return adc_read(adc_channel->dev, &sequence);
+    if (err < 0) {
+        printk("Error configuring the %s channel: %d\n", channel_name[channel], err);
+        return -1;
+    }
+    err = read_adc_channel(&adc_channels[channel], &sample_buffer, adc_channels[channel].resolution);
+    if (err < 0) {
+        printk("Error reading the %s channel: %d\n", channel_name[channel], err);
+        return -1;
+    }
+    return to_mv(channel, sample_buffer);
 }
 
 static const struct device *dev_adc;
@@ -67,6 +154,17 @@ void adc_init(void)
         LOG_ERR("ADC device not ready\n");
         return;
     }
+    BUILD_ASSERT(ADC_NUM_CHANNELS >= ARRAY_SIZE(channel_divider), "Missing ADC channels in the devicetree");
+    /* Check the configuration of every channel once, the solenoid is left selected */
+    k_mutex_lock(&adc_lock, K_FOREVER);
+    for (int i = ARRAY_SIZE(channel_divider) - 1; i >= 0; i--) {
+        configured_channel = -1;
+        if (select_channel(i) < 0) {
+            LOG_ERR("ADC %s channel setup failed", channel_name[i]);
+        }
+    }
+    calibrate = 1;
+    k_mutex_unlock(&adc_lock);
 }
 
 /**
@@ -77,25 +175,57 @@ void adc_init(void)
  */
 int adc_read_solenoid_supply(void)
 {
-    int32_t sample_buffer = 0;
-    /* Solenoid channel configuration */
-    int err = adc_channel_setup_dt(&adc_channels[0]);
+    int mv;
 
-    if (err < 0) {
-        printk("Error configuring the Solenoid channel: %d\n", err);
+    k_mutex_lock(&adc_lock, K_FOREVER);
+    mv = read_mv(CHANNEL_SOLENOID);
+    k_mutex_unlock(&adc_lock);
+    return mv;
+}
+
+/**
+ * Capture the supply voltage of the solenoid in mV, several samples at a fixed
+ * interval in one ADC sequence. Every sample is averaged in hardware.
+ * @param mv Buffer for the samples
+ * @param n_samples Size of the buffer, up to SOLENOID_CAPTURE_MAX_SAMPLES
+ * @param interval_us Time between the start of the samples
+ * @return The number of samples captured, -1 on error
+ */
+int adc_capture_solenoid_supply(int16_t *mv, int n_samples, uint32_t interval_us)
+{
+    uint16_t samples[SOLENOID_CAPTURE_MAX_SAMPLES];
+    struct adc_sequence_options options = {
+        .interval_us = interval_us,
+        .extra_samplings = n_samples - 1,
+    };
+    struct adc_sequence sequence = {
+        .options = &options,
+        .channels = BIT(adc_channels[CHANNEL_SOLENOID].channel_id),
+        .buffer = samples,
+        .buffer_size = sizeof(samples),
+        .resolution = adc_channels[CHANNEL_SOLENOID].resolution,
+        .oversampling = SOLENOID_CAPTURE_OVERSAMPLING,
+    };
+    int err;
+
+    if (n_samples < 1 || n_samples > SOLENOID_CAPTURE_MAX_SAMPLES) {
         return -1;
     }
-    /* Read from the Solenoid channel */
-    err = read_adc_channel(&adc_channels[0], &sample_buffer, adc_channels[0].resolution);
+    k_mutex_lock(&adc_lock, K_FOREVER);
+    err = select_channel(CHANNEL_SOLENOID);
+    if (err == 0) {
+        err = adc_read(adc_channels[CHANNEL_SOLENOID].dev, &sequence);
+    }
+    k_mutex_unlock(&adc_lock);
     if (err < 0) {
-        printk("Error reading Solenoid channel: %d\n", err);
+        printk("Error capturing the Solenoid channel: %d\n", err);
         return -1;
     }
-    /* Calculate the voltage value */
-    int mv_value = (sample_buffer * 1650 * 2) / (1 << adc_channels[0].resolution);
-
-    LOG_DBG("ADC ch Solenoid raw: %d = %dmV x 11 = %dmV", sample_buffer, mv_value, mv_value * 11);
-    return mv_value * 11;
+    for (int i = 0; i < n_samples; i++) {
+        mv[i] = (int16_t)((samples[i] * 1650 * 2) / (1 << adc_channels[CHANNEL_SOLENOID].resolution) *
+                          channel_divider[CHANNEL_SOLENOID]);
+    }
+    return n_samples;
 }
 
 /**
@@ -103,25 +233,12 @@ int adc_read_solenoid_supply(void)
  */
 int adc_read_battery(void)
 {
-    int32_t sample_buffer = 0;
-    /* Battery Channel configuration  */
-    int err = adc_channel_setup_dt(&adc_channels[1]);
-
-    if (err < 0) {
-        printk("Error configuring the Battery channel: %d\n", err);
-        return -1;
-    }
-    /* Read from the Battery Channel */
-    err = read_adc_channel(&adc_channels[1], &sample_buffer, adc_channels[1].resolution);
-    if (err < 0) {
-        printk("Error reading the Battery channel: %d\n", err);
-        return -1;
-    }
-    /* Calculate the voltage value in mV */
-    int mv_value = (sample_buffer * 1650 * 2) / (1 << adc_channels[1].resolution);
+    int mv;
 
-    LOG_DBG("ADC ch Battery raw: %d = %dmV x 2 = %dmV", sample_buffer, mv_value, mv_value * 2);
-    return mv_value * 2;
+    k_mutex_lock(&adc_lock, K_FOREVER);
+    mv = read_mv(CHANNEL_BATTERY);
+    k_mutex_unlock(&adc_lock);
+    return mv;
 }
 
 /**
@@ -131,23 +248,28 @@ int adc_read_battery(void)
  */
 int adc_read_sensor_supply(void)
 {
-    int32_t sample_buffer = 0;
-    /* Sensor Supply Channel configuration */
-    int err = adc_channel_setup_dt(&adc_channels[2]);
+    int mv;
 
-    if (err < 0) {
-        printk("Error configuring the Sensor channel: %d\n", err);
-        return -1;
-    }
-    /* Read from the Sensor Supply Channel */
-    err = read_adc_channel(&adc_channels[2], &sample_buffer, adc_channels[2].resolution);
-    if (err < 0) {
-        printk("Error reading the Sensor channel: %d\n", err);
+    k_mutex_lock(&adc_lock, K_FOREVER);
+    mv = read_mv(CHANNEL_SENSOR);
+    k_mutex_unlock(&adc_lock);
+    return mv;
+}
+
+/**
+ * Read the supplies of the node in one burst, without letting other
+ * conversions in between. The solenoid supply is read by the valves, it is
+ * not part of the burst.
+ * @return 0 if all were read, -1 if some failed (that one is -1)
+ */
+int adc_read_all(struct adc_readings *readings)
+{
+    k_mutex_lock(&adc_lock, K_FOREVER);
+    readings->battery_mv = read_mv(CHANNEL_BATTERY);
+    readings->sensor_supply_mv = read_mv(CHANNEL_SENSOR);
+    k_mutex_unlock(&adc_lock);
+    if (readings->battery_mv < 0 || readings->sensor_supply_mv < 0) {
         return -1;
     }
-    /* Calculate the voltage value in mV */
-    int mv_value = (sample_buffer * 1650 * 2) / (1 << adc_channels[2].resolution);
-
-    LOG_DBG("ADC ch Sensor Supply raw: %d = %dmV x 2 = %dmV", sample_buffer, mv_value, mv_value * 2);
-    return mv_value * 2;
+    return 0;
 }
@@ -0,0 +1,169 @@
+/**
+ *  \file uplink_filter.c
+ *  \brief Report by exception, send only the measurements that changed
+ *
+ *  Every variable has a deadband given by its class (oxygen, temperature,
+ *  state of the valves...). A measurement is sent when one of its variables
+ *  moves its deadband or more from the last value the coordinator acknowledged,
+ *  or when the status of the sensor or of a variable changes. A deadband of
+ *  zero sends every sample. After cfg.heartbeat_interval without a complete
+ *  report everything is sent, so the coordinator knows the node is alive.
+ *
+ *  The values sent in a cycle are kept as pending and become the reported ones
+ *  with uplink_filter_commit(), once the frame of the node is acknowledged.
+ *  The other frames go through the measurement storage, which keeps them
+ *  until they are delivered. If the node frame is lost, the next cycle
+ *  compares against the older values and sends the change again.
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <zephyr/sys/util.h>
+#include "timeutils.h"
+#include "configuration.h"
+#include "measurement_aggregation.h"
+#include "uplink_filter.h"
+
+static struct reported_measurement reported[UPLINK_FILTER_SLOTS];
+static struct reported_measurement pending[UPLINK_FILTER_SLOTS];
+static uint32_t pending_slots;   /* Bit per slot with a pending report */
+static uint8_t heartbeat;        /* Everything is sent in this cycle */
+static int64_t last_full_report; /* Uptime of the last acknowledged complete report */
+static uint8_t full_report_done;
+
+BUILD_ASSERT(UPLINK_FILTER_SLOTS <= 32);
+
+/*
+ * Value of a variable in steps of its deadband.
+ */
+static int32_t to_steps(float value, float deadband)
+{
+    float steps = value * UPLINK_DEADBAND_STEPS / deadband;
+
+    /* Beyond this the float has no resolution for a step anyway */
+    if (steps >= (float)INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (steps <= (float)INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)lroundf(steps);
+}
+
+/*
+ * Build the compact copy of a measurement.
+ */
+static void reduce(const struct measurement *m, struct reported_measurement *r)
+{
+    float value[AGGREGATION_MAX_FIELDS];
+    enum measurement_status status[AGGREGATION_MAX_FIELDS];
+    uint8_t deadband_class[AGGREGATION_MAX_FIELDS];
+    int n = measurement_get_fields(m, value, status, deadband_class);
+
+    memset(r, 0, sizeof(*r));
+    r->n_fields = n;
+    r->sensor_status = m->sensor_status;
+    for (int i = 0; i < n; i++) {
+        float deadband = cfg.deadband[deadband_class[i]];
+
+        if (status[i] != MEASUREMENT_OK || isnan(value[i])) {
+            r->fields_invalid |= BIT(i);
+        } else if (deadband <= 0.0f) {
+            r->fields_always |= BIT(i);
+        } else {
+            r->steps[i] = to_steps(value[i], deadband);
+        }
+    }
+    r->valid = 1;
+}
+
+/*
+ * Check if the deadband of any variable is exceeded.
+ */
+static int exceeds_deadband(const struct reported_measurement *now, const struct reported_measurement *last)
+{
+    if (!last->valid || now->n_fields == 0 || now->n_fields != last->n_fields) {
+        return 1;
+    }
+    /* A variable that stays invalid is not sent again, only its change */
+    if (now->sensor_status != last->sensor_status || now->fields_invalid != last->fields_invalid) {
+        return 1;
+    }
+    if (now->fields_always) {
+        return 1;
+    }
+    for (int i = 0; i < now->n_fields; i++) {
+        if (now->fields_invalid & BIT(i)) {
+            continue;
+        }
+        if (llabs((int64_t)now->steps[i] - last->steps[i]) >= UPLINK_DEADBAND_STEPS) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Forget the reported values, the next cycle sends everything.
+ */
+void uplink_filter_reset(void)
+{
+    memset(reported, 0, sizeof(reported));
+    pending_slots = 0;
+    full_report_done = 0;
+}
+
+/**
+ * Check if a complete report is needed.
+ */
+int uplink_filter_heartbeat_due(void)
+{
+    return !full_report_done || ms_elapsed(&last_full_report) >= (int64_t)cfg.heartbeat_interval * 1000;
+}
+
+/**
+ * Start the reports of a new cycle.
+ */
+void uplink_filter_begin(void)
+{
+    pending_slots = 0;
+    heartbeat = uplink_filter_heartbeat_due();
+}
+
+/**
+ * Decide if the measurement of a slot should be sent in this cycle.
+ * @return 1 if it should be sent
+ */
+int uplink_filter_report(int slot, const struct measurement *m)
+{
+    if (slot < 0 || slot >= UPLINK_FILTER_SLOTS) {
+        return 1;
+    }
+    reduce(m, &pending[slot]);
+    if (!heartbeat && !exceeds_deadband(&pending[slot], &reported[slot])) {
+        return 0;
+    }
+    pending_slots |= BIT(slot);
+    return 1;
+}
+
+/**
+ * All the frames of the cycle were acknowledged, the values sent become the
+ * reference for the deadbands.
+ */
+void uplink_filter_commit(void)
+{
+    for (int i = 0; i < UPLINK_FILTER_SLOTS; i++) {
+        if (pending_slots & BIT(i)) {
+            reported[i] = pending[i];
+        }
+    }
+    pending_slots = 0;
+    if (heartbeat) {
+        last_full_report = get_uptime_ms();
+        full_report_done = 1;
+        heartbeat = 0;
+    }
+}
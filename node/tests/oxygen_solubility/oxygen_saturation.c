@@ -0,0 +1,41 @@
+/**
+ *  \file oxygen_saturation.c
+ *  \brief Host reference of the microlib oxygen equations
+ *
+ *  Garcia and Gordon (1992) with the Benson and Krause fit, the equations of
+ *  the microlib and of scripts/solubility_table.py.
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+#include <math.h>
+#include "oxygen_saturation.h"
+#include "temperature.h"
+
+#define ML_TO_MG 1.42905
+
+float kelvin(float celsius)
+{
+    return celsius + 273.15f;
+}
+
+/*
+ * Oxygen concentration, mg/l.
+ * @param temperature Kelvin
+ */
+float oxygen_concentration(float saturation, float salinity, float temperature)
+{
+    static const double a[] = {2.00907, 3.22014, 4.0501, 4.94457, -0.256847, 3.88767};
+    static const double b[] = {-6.24523e-3, -7.37614e-3, -1.0341e-2, -8.17083e-3};
+    double ts = log((298.15 - (temperature - 273.15)) / temperature);
+    double ln = 0.0;
+    double ln_salinity = 0.0;
+
+    for (int i = 5; i >= 0; i--) {
+        ln = ln * ts + a[i];
+    }
+    for (int i = 3; i >= 0; i--) {
+        ln_salinity = ln_salinity * ts + b[i];
+    }
+    ln += salinity * ln_salinity - 4.88682e-7 * salinity * salinity;
+    return (float)(saturation / 100.0 * exp(ln) * ML_TO_MG);
+}
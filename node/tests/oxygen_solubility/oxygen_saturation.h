@@ -0,0 +1,13 @@
+/**
+ *  \file oxygen_saturation.h
+ *  \brief Host stub of the microlib, the reference is in the test
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+
+#ifndef OXYGEN_SATURATION_H
+#define OXYGEN_SATURATION_H
+
+float oxygen_concentration(float saturation, float salinity, float temperature);
+
+#endif /* OXYGEN_SATURATION_H */
@@ -0,0 +1,13 @@
+/**
+ *  \file temperature.h
+ *  \brief Host stub of the microlib
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+
+#ifndef TEMPERATURE_H
+#define TEMPERATURE_H
+
+float kelvin(float celsius);
+
+#endif /* TEMPERATURE_H */
@@ -0,0 +1,68 @@
+/**
+ *  \file test_oxygen_solubility.c
+ *  \brief Host test of the oxygen solubility table against the float equations
+ *
+ *  The reference equations are in oxygen_saturation.c of this directory.
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+#include <math.h>
+#include <stdio.h>
+#include "oxygen_saturation.h"
+#include "temperature.h"
+#include "oxygen_solubility.h"
+
+static int n_failures;
+
+static void expect(int condition, const char *what)
+{
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        n_failures++;
+    }
+}
+
+/*
+ * The grid of the firmware self test, from 0 to SOLUBILITY_MAX_SATURATION.
+ */
+static void test_self_check(void)
+{
+    struct solubility_check check;
+
+    expect(oxygen_solubility_check(&check) == 0, "self test");
+    printf("%u points, max error %.4f mg/l at %.0f%% %.1f C %.0f PSU, table %u ns, float %u ns\n",
+           check.n_points,
+           (double)check.max_error,
+           (double)check.max_error_saturation,
+           (double)check.max_error_temperature,
+           (double)check.max_error_salinity,
+           check.table_ns,
+           check.float_ns);
+}
+
+/*
+ * The nodes of the table are exact to the ug/l, and outside the envelope the
+ * float equations are used.
+ */
+static void test_nodes_and_envelope(void)
+{
+    expect(fabsf(oxygen_concentration_fast(100.0f, 0.0f, 0.0f) - oxygen_concentration(100.0f, 0.0f, kelvin(0.0f))) <
+               0.0006f,
+           "first node");
+    expect(fabsf(oxygen_concentration_fast(100.0f, 40.0f, 35.0f) -
+                 oxygen_concentration(100.0f, 40.0f, kelvin(35.0f))) < 0.0006f,
+           "last node");
+    expect(oxygen_concentration_fast(100.0f, 10.0f, 40.0f) == oxygen_concentration(100.0f, 10.0f, kelvin(40.0f)),
+           "above the temperature envelope");
+    expect(oxygen_concentration_fast(100.0f, -1.0f, 10.0f) == oxygen_concentration(100.0f, -1.0f, kelvin(10.0f)),
+           "below the salinity envelope");
+    expect(oxygen_concentration_fast(0.0f, 20.0f, 12.3f) == 0.0f, "zero saturation");
+}
+
+int main(void)
+{
+    test_self_check();
+    test_nodes_and_envelope();
+    printf("%s\n", n_failures == 0 ? "OK" : "FAIL");
+    return n_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,21 @@
+/**
+ *  \file profiler.h
+ *  \brief Host stub of the profiler, without the smart sensor types
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+struct profile_mark {
+    uint32_t cycles;
+    uint32_t uptime_ms;
+};
+
+struct profile_mark profiler_start(void);
+uint32_t profiler_elapsed_us(struct profile_mark mark);
+
+#endif /* PROFILER_H */
@@ -0,0 +1,33 @@
+/**
+ *  \file stubs.c
+ *  \brief Host versions of the functions of the firmware used by the modules under test
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+#include <time.h>
+#include "profiler.h"
+#include "watchdog.h"
+
+static uint32_t now_us(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint32_t)(t.tv_sec * 1000000 + t.tv_nsec / 1000);
+}
+
+struct profile_mark profiler_start(void)
+{
+    struct profile_mark mark = {.cycles = now_us(), .uptime_ms = 0};
+
+    return mark;
+}
+
+uint32_t profiler_elapsed_us(struct profile_mark mark)
+{
+    return now_us() - mark.cycles;
+}
+
+void watchdog_reset(void)
+{
+}
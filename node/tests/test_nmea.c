@@ -0,0 +1,96 @@
+/**
+ *  \file test_nmea.c
+ *  \brief Host test of the streaming NMEA parser
+ *
+ *  Copyright 2026 Innovex Tecnologias Ltda. All rights reserved.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "nmea.h"
+
+static int n_failures;
+
+static void expect(int condition, const char *what)
+{
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        n_failures++;
+    }
+}
+
+/*
+ * Feed a text to the parser, return the last sentence completed.
+ */
+static enum nmea_sentence feed(struct nmea_parser *parser, const char *text, struct nmea_fix *fix)
+{
+    enum nmea_sentence sentence = NMEA_NONE;
+
+    for (const char *p = text; *p != '\0'; p++) {
+        enum nmea_sentence s = nmea_parser_feed(parser, *p, fix);
+
+        if (s != NMEA_NONE) {
+            sentence = s;
+        }
+    }
+    return sentence;
+}
+
+/*
+ * The corpus of the firmware self test.
+ */
+static void test_self_check(void)
+{
+    struct nmea_check check;
+
+    expect(nmea_parser_check(&check) == 0, "self test");
+    printf("%u sentences, %u checksum errors, %u failures, %u ns/byte\n",
+           check.n_sentences,
+           check.n_checksum_errors,
+           check.n_failures,
+           check.ns_per_byte);
+}
+
+/*
+ * A fix is kept when the next sentence is corrupted, and updated by the next good one.
+ */
+static void test_corrupted_keeps_fix(void)
+{
+    struct nmea_parser parser;
+    struct nmea_fix fix = {0};
+
+    nmea_parser_init(&parser);
+    expect(feed(&parser, "$GNRMC,123519.000,A,4807.0380,N,01131.0000,E,0.02,31.66,230394,,,A*40\r\n", &fix) ==
+               NMEA_RMC,
+           "good RMC");
+    expect(fix.valid && fix.has_position && fix.latitude == 481173000, "RMC position");
+    expect(feed(&parser, "$GNRMC,123519.000,A,5807.0380,N,01131.0000,E,0.02,31.66,230394,,,A*40\r\n", &fix) ==
+               NMEA_NONE,
+           "corrupted RMC");
+    expect(fix.latitude == 481173000, "fix kept after a corrupted sentence");
+    expect(parser.n_checksum_errors == 1, "checksum error counted");
+}
+
+/*
+ * Sentences that arrive split in several reads, with noise before them.
+ */
+static void test_split_sentence(void)
+{
+    struct nmea_parser parser;
+    struct nmea_fix fix = {0};
+
+    nmea_parser_init(&parser);
+    expect(feed(&parser, "\xff\r\ngarbage,*12", &fix) == NMEA_NONE, "noise");
+    expect(feed(&parser, "$GNGGA,101010.000,4130.12345,S,072", &fix) == NMEA_NONE, "first half");
+    expect(feed(&parser, "58.54321,W,2,11,1.25,10.0,M,20.0,M,,*44\r\n", &fix) == NMEA_GGA, "second half");
+    expect(fix.latitude == -415020575 && fix.longitude == -729757202, "GGA position");
+    expect(fix.hdop == 125 && fix.quality == 2 && fix.satellites == 11, "GGA quality");
+}
+
+int main(void)
+{
+    test_self_check();
+    test_corrupted_keeps_fix();
+    test_split_sentence();
+    printf("%s\n", n_failures == 0 ? "OK" : "FAIL");
+    return n_failures == 0 ? 0 : 1;
+}